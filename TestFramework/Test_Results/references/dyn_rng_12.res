@@ -0,0 +1,499 @@
+0.150000,	-6.99
+0.250000,	-7.15
+0.350000,	-7.08
+0.450000,	-6.98
+0.550000,	-6.97
+0.650000,	-6.96
+0.750000,	-6.98
+0.850000,	-7.29
+0.950000,	-7.13
+1.050000,	-7.03
+1.150000,	-6.92
+1.250000,	-6.90
+1.350000,	-6.96
+1.450000,	-6.78
+1.550000,	-7.08
+1.650000,	-7.14
+1.750000,	-6.95
+1.850000,	-6.84
+1.950000,	-6.71
+2.050000,	-7.07
+2.150000,	-7.34
+2.250000,	-7.08
+2.350000,	-7.08
+2.450000,	-7.06
+2.550000,	-7.19
+2.650000,	-6.91
+2.750000,	-7.16
+2.850000,	-6.90
+2.950000,	-7.07
+3.050000,	-7.03
+3.150000,	-6.84
+3.250000,	-6.72
+3.350000,	-6.93
+3.450000,	-7.01
+3.550000,	-7.26
+3.650000,	-7.03
+3.750000,	-7.08
+3.850000,	-6.85
+3.950000,	-7.31
+4.050000,	-7.12
+4.150000,	-7.16
+4.250000,	-7.02
+4.350000,	-7.01
+4.450000,	-7.05
+4.550000,	-7.02
+4.650000,	-7.32
+4.750000,	-6.97
+4.850000,	-7.07
+4.950000,	-7.04
+5.050000,	-7.05
+5.150000,	-6.79
+5.250000,	-7.03
+5.350000,	-7.06
+5.450000,	-7.05
+5.550000,	-6.92
+5.650000,	-6.78
+5.750000,	-7.23
+5.850000,	-7.20
+5.950000,	-6.66
+6.050000,	-7.04
+6.150000,	-7.05
+6.250000,	-7.07
+6.350000,	-7.14
+6.450000,	-7.04
+6.550000,	-6.88
+6.650000,	-7.41
+6.750000,	-7.07
+6.850000,	-7.10
+6.950000,	-6.84
+7.050000,	-6.88
+7.150000,	-6.96
+7.250000,	-7.05
+7.350000,	-6.97
+7.450000,	-6.99
+7.550000,	-7.06
+7.650000,	-6.97
+7.750000,	-6.74
+7.850000,	-6.98
+7.950000,	-7.04
+8.050000,	-7.18
+8.150000,	-6.90
+8.250000,	-7.29
+8.350000,	-7.22
+8.450000,	-6.98
+8.550000,	-7.20
+8.650000,	-6.78
+8.750000,	-6.92
+8.850000,	-6.96
+8.950000,	-6.92
+9.050000,	-6.90
+9.150000,	-7.18
+9.250000,	-7.02
+9.350000,	-7.21
+9.450000,	-6.84
+9.550000,	-7.25
+9.650000,	-7.21
+9.750000,	-7.04
+9.850000,	-7.16
+9.950000,	-6.94
+10.050000,	-6.88
+10.150000,	-7.31
+10.250000,	-6.65
+10.350000,	-7.02
+10.450000,	-6.89
+10.550000,	-7.00
+10.650000,	-7.08
+10.750000,	-6.82
+10.850000,	-7.06
+10.950000,	-6.92
+11.050000,	-6.73
+11.150000,	-7.07
+11.250000,	-7.13
+11.350000,	-6.92
+11.450000,	-7.00
+11.550000,	-7.02
+11.650000,	-7.07
+11.750000,	-6.96
+11.850000,	-6.86
+11.950000,	-6.92
+12.050000,	-6.68
+12.150000,	-7.13
+12.250000,	-7.00
+12.350000,	-7.03
+12.450000,	-6.66
+12.550000,	-6.71
+12.650000,	-6.83
+12.750000,	-7.04
+12.850000,	-7.14
+12.950000,	-6.94
+13.050000,	-7.05
+13.150000,	-6.84
+13.250000,	-6.87
+13.350000,	-6.99
+13.450000,	-7.01
+13.550000,	-7.16
+13.650000,	-7.28
+13.750000,	-6.94
+13.850000,	-6.91
+13.950000,	-6.80
+14.050000,	-7.16
+14.150000,	-7.18
+14.250000,	-6.96
+14.350000,	-7.05
+14.450000,	-6.89
+14.550000,	-7.09
+14.650000,	-7.11
+14.750000,	-7.14
+14.850000,	-7.25
+14.950000,	-7.04
+15.050000,	-6.88
+15.150000,	-7.13
+15.250000,	-6.80
+15.350000,	-7.15
+15.450000,	-6.88
+15.550000,	-7.00
+15.650000,	-6.94
+15.750000,	-6.84
+15.850000,	-6.86
+15.950000,	-7.03
+16.050000,	-7.02
+16.150000,	-7.18
+16.250000,	-7.00
+16.350000,	-6.97
+16.450000,	-6.72
+16.550000,	-6.91
+16.650000,	-6.89
+16.750000,	-7.26
+16.850000,	-6.91
+16.950000,	-7.06
+17.050000,	-7.30
+17.150000,	-7.00
+17.250000,	-6.99
+17.350000,	-6.83
+17.450000,	-6.99
+17.550000,	-6.96
+17.650000,	-7.02
+17.750000,	-7.15
+17.850000,	-7.09
+17.950000,	-7.08
+18.050000,	-6.88
+18.150000,	-7.10
+18.250000,	-6.84
+18.350000,	-7.15
+18.450000,	-7.13
+18.550000,	-7.00
+18.650000,	-7.31
+18.750000,	-7.16
+18.850000,	-6.89
+18.950000,	-7.21
+19.050000,	-6.82
+19.150000,	-7.25
+19.250000,	-6.91
+19.350000,	-7.22
+19.450000,	-6.94
+19.550000,	-6.97
+19.650000,	-7.22
+19.750000,	-6.81
+19.850000,	-6.99
+19.950000,	-7.15
+20.050000,	-7.01
+20.150000,	-6.99
+20.250000,	-6.82
+20.350000,	-7.08
+20.450000,	-6.97
+20.550000,	-6.70
+20.650000,	-7.17
+20.750000,	-7.30
+20.850000,	-7.01
+20.950000,	-6.76
+21.050000,	-6.86
+21.150000,	-7.07
+21.250000,	-7.24
+21.350000,	-7.30
+21.450000,	-6.84
+21.550000,	-7.05
+21.650000,	-6.84
+21.750000,	-7.05
+21.850000,	-7.15
+21.950000,	-6.92
+22.050000,	-7.25
+22.150000,	-6.79
+22.250000,	-6.88
+22.350000,	-6.95
+22.450000,	-7.37
+22.550000,	-6.91
+22.650000,	-7.00
+22.750000,	-6.98
+22.850000,	-7.39
+22.950000,	-6.86
+23.050000,	-7.02
+23.150000,	-7.14
+23.250000,	-7.03
+23.350000,	-7.11
+23.450000,	-6.88
+23.550000,	-6.96
+23.650000,	-7.12
+23.750000,	-7.11
+23.850000,	-6.99
+23.950000,	-6.94
+24.050000,	-7.11
+24.150000,	-7.04
+24.250000,	-6.83
+24.350000,	-7.00
+24.450000,	-6.86
+24.550000,	-7.12
+24.650000,	-6.95
+24.750000,	-6.55
+24.850000,	-7.03
+24.950000,	-7.10
+25.050000,	-7.16
+25.150000,	-6.90
+25.250000,	-6.82
+25.350000,	-6.93
+25.450000,	-6.90
+25.550000,	-6.98
+25.650000,	-7.11
+25.750000,	-7.12
+25.850000,	-7.05
+25.950000,	-6.86
+26.050000,	-7.09
+26.150000,	-6.74
+26.250000,	-6.94
+26.350000,	-6.83
+26.450000,	-6.87
+26.550000,	-7.14
+26.650000,	-7.29
+26.750000,	-7.09
+26.850000,	-6.90
+26.950000,	-6.83
+27.050000,	-7.13
+27.150000,	-7.28
+27.250000,	-7.08
+27.350000,	-6.98
+27.450000,	-6.93
+27.550000,	-7.07
+27.650000,	-7.08
+27.750000,	-7.18
+27.850000,	-7.09
+27.950000,	-6.71
+28.050000,	-7.10
+28.150000,	-6.84
+28.250000,	-7.05
+28.350000,	-6.92
+28.450000,	-6.96
+28.550000,	-6.87
+28.650000,	-6.90
+28.750000,	-7.08
+28.850000,	-7.09
+28.950000,	-6.86
+29.050000,	-7.13
+29.150000,	-7.08
+29.250000,	-6.82
+29.350000,	-6.82
+29.450000,	-7.10
+29.550000,	-6.95
+29.650000,	-7.11
+29.750000,	-6.88
+29.850000,	-6.89
+29.950000,	-7.07
+30.050000,	-7.16
+30.150000,	-7.22
+30.250000,	-6.91
+30.350000,	-7.31
+30.450000,	-6.92
+30.550000,	-7.13
+30.650000,	-6.95
+30.750000,	-6.83
+30.850000,	-7.18
+30.950000,	-6.98
+31.050000,	-6.98
+31.150000,	-6.78
+31.250000,	-6.92
+31.350000,	-7.12
+31.450000,	-7.05
+31.550000,	-7.17
+31.650000,	-7.11
+31.750000,	-7.05
+31.850000,	-7.27
+31.950000,	-7.02
+32.050000,	-6.86
+32.150000,	-7.02
+32.250000,	-6.78
+32.350000,	-7.06
+32.450000,	-7.07
+32.550000,	-7.10
+32.650000,	-7.17
+32.750000,	-6.96
+32.850000,	-6.97
+32.950000,	-6.99
+33.050000,	-6.91
+33.150000,	-7.23
+33.250000,	-7.00
+33.350000,	-6.93
+33.450000,	-6.98
+33.550000,	-7.34
+33.650000,	-7.21
+33.750000,	-6.97
+33.850000,	-7.11
+33.950000,	-6.95
+34.050000,	-7.04
+34.150000,	-7.03
+34.250000,	-7.05
+34.350000,	-7.23
+34.450000,	-7.10
+34.550000,	-6.85
+34.650000,	-7.01
+34.750000,	-6.98
+34.850000,	-7.05
+34.950000,	-6.97
+35.050000,	-7.04
+35.150000,	-7.18
+35.250000,	-6.76
+35.350000,	-6.97
+35.450000,	-6.98
+35.550000,	-6.75
+35.650000,	-6.82
+35.750000,	-7.01
+35.850000,	-7.31
+35.950000,	-7.06
+36.050000,	-7.19
+36.150000,	-6.95
+36.250000,	-6.74
+36.350000,	-7.16
+36.450000,	-7.00
+36.550000,	-6.92
+36.650000,	-6.96
+36.750000,	-7.15
+36.850000,	-7.25
+36.950000,	-6.98
+37.050000,	-7.30
+37.150000,	-6.74
+37.250000,	-6.92
+37.350000,	-6.92
+37.450000,	-7.09
+37.550000,	-6.88
+37.650000,	-7.05
+37.750000,	-6.78
+37.850000,	-7.04
+37.950000,	-6.75
+38.050000,	-7.00
+38.150000,	-7.09
+38.250000,	-7.08
+38.350000,	-6.89
+38.450000,	-7.21
+38.550000,	-6.96
+38.650000,	-6.92
+38.750000,	-7.30
+38.850000,	-6.97
+38.950000,	-6.99
+39.050000,	-6.87
+39.150000,	-6.99
+39.250000,	-6.64
+39.350000,	-7.10
+39.450000,	-7.21
+39.550000,	-7.20
+39.650000,	-6.96
+39.750000,	-6.98
+39.850000,	-6.89
+39.950000,	-6.90
+40.050000,	-6.79
+40.150000,	-6.90
+40.250000,	-6.75
+40.350000,	-6.96
+40.450000,	-7.03
+40.550000,	-7.11
+40.650000,	-6.81
+40.750000,	-7.25
+40.850000,	-7.10
+40.950000,	-6.82
+41.050000,	-7.06
+41.150000,	-7.07
+41.250000,	-7.00
+41.350000,	-7.24
+41.450000,	-6.83
+41.550000,	-7.17
+41.650000,	-7.08
+41.750000,	-6.95
+41.850000,	-7.30
+41.950000,	-6.84
+42.050000,	-6.94
+42.150000,	-7.02
+42.250000,	-7.02
+42.350000,	-6.90
+42.450000,	-7.15
+42.550000,	-7.12
+42.650000,	-6.97
+42.750000,	-6.81
+42.850000,	-6.75
+42.950000,	-7.06
+43.050000,	-7.19
+43.150000,	-6.90
+43.250000,	-7.22
+43.350000,	-6.85
+43.450000,	-7.07
+43.550000,	-7.20
+43.650000,	-6.95
+43.750000,	-7.22
+43.850000,	-6.92
+43.950000,	-6.96
+44.050000,	-7.04
+44.150000,	-6.81
+44.250000,	-7.04
+44.350000,	-7.06
+44.450000,	-6.88
+44.550000,	-7.07
+44.650000,	-6.99
+44.750000,	-6.99
+44.850000,	-6.96
+44.950000,	-6.96
+45.050000,	-6.98
+45.150000,	-6.70
+45.250000,	-6.89
+45.350000,	-6.99
+45.450000,	-6.93
+45.550000,	-7.15
+45.650000,	-6.69
+45.750000,	-6.96
+45.850000,	-6.64
+45.950000,	-6.71
+46.050000,	-6.96
+46.150000,	-7.27
+46.250000,	-7.01
+46.350000,	-7.10
+46.450000,	-7.02
+46.550000,	-6.76
+46.650000,	-7.07
+46.750000,	-6.97
+46.850000,	-7.10
+46.950000,	-6.84
+47.050000,	-6.95
+47.150000,	-7.13
+47.250000,	-7.01
+47.350000,	-7.26
+47.450000,	-7.30
+47.550000,	-7.25
+47.650000,	-7.08
+47.750000,	-7.17
+47.850000,	-7.03
+47.950000,	-6.87
+48.050000,	-6.98
+48.150000,	-6.85
+48.250000,	-6.88
+48.350000,	-6.93
+48.450000,	-7.39
+48.550000,	-6.88
+48.650000,	-6.96
+48.750000,	-7.18
+48.850000,	-6.78
+48.950000,	-7.05
+49.050000,	-7.14
+49.150000,	-6.86
+49.250000,	-6.93
+49.350000,	-6.97
+49.450000,	-7.20
+49.550000,	-6.76
+49.650000,	-7.05
+49.750000,	-7.07
+49.850000,	-7.10
+49.950000,	-6.91
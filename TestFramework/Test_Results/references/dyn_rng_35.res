@@ -0,0 +1,49 @@
+0.150000,	-15.78
+0.250000,	-18.75
+0.350000,	-16.35
+0.450000,	-13.59
+0.550000,	-13.52
+0.650000,	-16.11
+0.750000,	-18.43
+0.850000,	-16.02
+0.950000,	-12.84
+1.050000,	-11.62
+1.150000,	-12.68
+1.250000,	-18.08
+1.350000,	-17.20
+1.450000,	-13.67
+1.550000,	-13.60
+1.650000,	-16.88
+1.750000,	-16.84
+1.850000,	-11.76
+1.950000,	-11.16
+2.050000,	-12.65
+2.150000,	-16.04
+2.250000,	-18.75
+2.350000,	-16.14
+2.450000,	-12.56
+2.550000,	-15.31
+2.650000,	-21.10
+2.750000,	-21.44
+2.850000,	-16.85
+2.950000,	-13.68
+3.050000,	-13.55
+3.150000,	-16.21
+3.250000,	-18.75
+3.350000,	-16.36
+3.450000,	-12.89
+3.550000,	-11.17
+3.650000,	-11.41
+3.750000,	-15.45
+3.850000,	-17.55
+3.950000,	-13.84
+4.050000,	-13.45
+4.150000,	-15.92
+4.250000,	-18.70
+4.350000,	-16.76
+4.450000,	-13.81
+4.550000,	-13.44
+4.650000,	-15.91
+4.750000,	-18.70
+4.850000,	-16.27
+4.950000,	-11.62
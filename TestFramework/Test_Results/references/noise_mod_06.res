@@ -0,0 +1,49 @@
+-11.05,	-28.48
+-11.10,	-28.38
+-11.10,	-28.53
+-11.10,	-28.59
+-11.10,	-28.31
+-11.11,	-28.80
+-11.11,	-28.79
+-11.11,	-29.05
+-11.12,	-28.92
+-11.12,	-28.41
+-11.12,	-28.60
+-11.12,	-28.56
+-11.12,	-28.35
+-11.13,	-28.72
+-11.13,	-28.78
+-11.13,	-28.85
+-11.13,	-28.90
+-11.13,	-28.40
+-11.13,	-28.45
+-11.13,	-28.65
+-11.14,	-28.08
+-11.14,	-28.40
+-11.14,	-28.66
+-11.14,	-29.16
+-11.14,	-28.99
+-11.14,	-28.44
+-11.15,	-27.94
+-11.15,	-28.39
+-11.15,	-28.24
+-11.15,	-28.35
+-11.15,	-28.63
+-11.16,	-28.58
+-11.16,	-28.60
+-11.16,	-28.13
+-11.16,	-28.30
+-11.17,	-28.65
+-11.17,	-28.59
+-11.18,	-28.97
+-11.18,	-28.54
+-11.18,	-29.15
+-11.18,	-28.42
+-11.19,	-28.47
+-11.19,	-29.01
+-11.19,	-28.91
+-11.21,	-28.20
+-11.22,	-28.75
+-11.23,	-28.85
+-11.23,	-28.93
+-11.26,	-28.52
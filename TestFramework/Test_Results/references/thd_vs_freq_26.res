@@ -0,0 +1,13 @@
+800,	-66.49
+1008,	-66.48
+1270,	-66.46
+1600,	-66.42
+2016,	-66.45
+2540,	-66.49
+3200,	-66.45
+4032,	-66.49
+5080,	-66.43
+6400,	-66.33
+8063,	-66.29
+10159,	-96.00
+12800,	-96.00
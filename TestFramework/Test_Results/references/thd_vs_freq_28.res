@@ -0,0 +1,8 @@
+100,	-66.22
+126,	-66.25
+159,	-66.25
+200,	-66.21
+252,	-66.25
+317,	-66.24
+400,	-66.21
+504,	-66.24
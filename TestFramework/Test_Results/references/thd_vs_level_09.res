@@ -0,0 +1,49 @@
+-11.05,	-11.75
+-11.10,	-11.81
+-11.10,	-11.80
+-11.10,	-11.80
+-11.10,	-11.81
+-11.11,	-11.80
+-11.11,	-11.80
+-11.11,	-11.81
+-11.12,	-11.80
+-11.12,	-11.82
+-11.12,	-11.80
+-11.12,	-11.83
+-11.12,	-11.84
+-11.13,	-11.81
+-11.13,	-11.80
+-11.13,	-11.84
+-11.13,	-11.83
+-11.13,	-11.84
+-11.13,	-11.82
+-11.13,	-11.82
+-11.14,	-11.82
+-11.14,	-11.85
+-11.14,	-11.83
+-11.14,	-11.84
+-11.14,	-11.83
+-11.14,	-11.83
+-11.15,	-11.86
+-11.15,	-11.88
+-11.15,	-11.85
+-11.15,	-11.85
+-11.15,	-11.85
+-11.16,	-11.86
+-11.16,	-11.86
+-11.16,	-11.88
+-11.16,	-11.86
+-11.17,	-11.87
+-11.17,	-11.87
+-11.18,	-11.87
+-11.18,	-11.88
+-11.18,	-11.88
+-11.18,	-11.89
+-11.19,	-11.88
+-11.19,	-11.85
+-11.19,	-11.90
+-11.21,	-11.90
+-11.22,	-11.92
+-11.23,	-11.93
+-11.23,	-11.94
+-11.26,	-11.97
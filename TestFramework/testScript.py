@@ -440,8 +440,8 @@ def callTest(testID,testsignal,channel):
 		subprocess.call(cmd,shell=True)
 		txt2Csv(testID)
 	except Exception:
-		if testID == 'dyn_rng_12' or testID == 'dyn_rng_13' or testID == 'freq_resp_18' or testID == 'freq_resp_19' or testID == 'noise_mod_06' or testID == 'noise_mod_07' \
-			 or testID == 'spectrum_avg_07' or testID == 'spectrum_avg_08' or testID == 'thd_vs_freq_18' or testID == 'thd_vs_freq_19' or testID == 'thd_vs_level_09' \
+		if testID == 'dyn_rng_13' or testID == 'freq_resp_18' or testID == 'freq_resp_19' or testID == 'noise_mod_07' \
+			 or testID == 'spectrum_avg_07' or testID == 'spectrum_avg_08' or testID == 'thd_vs_freq_18' or testID == 'thd_vs_freq_19' \
 			 or testID == 'thd_vs_level_10':
 			print("**************")
 			print("Binary throws error for invalid frequency/bit rate")
@@ -587,6 +587,45 @@ def callnStripTest(testID,testsignal):
 	txt2Csv(testID)
 	return
  
+#Function to call test cases that read the input signal from stdin ("-i -")
+def callStdinTest(testID,testsignal):
+	global binpath
+	print("")
+	print("Test ID : " +testID)
+	print("Calculating results for '" +testsignal+ "' signal read from stdin for single channel '0' ...")
+	cmd = binpath+ ' -to Test_Results/'+testID+ ' -c 0 -i - < Test_Signals/' +testsignal
+	print(cmd)
+	#os.system(cmd)
+	subprocess.call(cmd,shell=True)
+	txt2Csv(testID)
+	return
+ 
+#Function to call test cases that save (or replay) the dwell map with -dwells
+def callDwellsTest(testID,testsignal,mapfile):
+	global binpath
+	print("")
+	print("Test ID : " +testID)
+	print("Calculating results for '" +testsignal+ "' signal for single channel '0' with dwell map '" +mapfile+ "' ...")
+	cmd = binpath+ ' -to Test_Results/'+testID+ ' -c 0 -dwells Test_Results/' +mapfile+ ' -i Test_Signals/' +testsignal
+	print(cmd)
+	#os.system(cmd)
+	subprocess.call(cmd,shell=True)
+	txt2Csv(testID)
+	return
+ 
+#Function to call test cases for single channel '0' with an extra switch (e.g. -j, -ra, -cache)
+def callOptionTest(testID,testsignal,option):
+	global binpath
+	print("")
+	print("Test ID : " +testID)
+	print("Calculating results for '" +testsignal+ "' signal for single channel '0' with '" +option+ "' ...")
+	cmd = binpath+ ' -to Test_Results/'+testID+ ' -c 0 ' +option+ ' -i Test_Signals/' +testsignal
+	print(cmd)
+	#os.system(cmd)
+	subprocess.call(cmd,shell=True)
+	txt2Csv(testID)
+	return
+ 
 # Function to call test cases with pre-defined dB level for stripping lead silence
 def callLevelTest(testID,testsignal,opt,level,blksz):
 	global binpath
@@ -661,7 +700,7 @@ def dyn_rng():
 	print("**All Test cases for this binary are executed with silence stripping (without -s) unless specified in the individual test case description**" )
 	print("The expected results may have a 0.01 dB variations and cross platform variation are expected")
 	print("")
-	print("Test ID 01 to 28")
+	print("Test ID 01 to 36")
 	callTest('dyn_rng_01','2_200_60_48.wav',2)
 	callTest('dyn_rng_02','2_200_60_48_192.wav',2)
 	callTest('dyn_rng_03','2_200_60_48_dist1.wav',2)
@@ -698,11 +737,31 @@ def dyn_rng():
 	callTest('dyn_rng_26','vanilla_6_48000-AC3_DLBECHNK.wav',3)
 	callTest('dyn_rng_27','vanilla_6_48000-AC3_DLBECHNK_EX.wav',3)
 	callTest('dyn_rng_28','vanilla_6_48000.wav',3)
+	print("")
+	print("***Test ID 29 to 31 test the tool for RF64, BW64 and Wave64 headers (copies of vanilla.wav, same results as ID 14)***")
+	callTest('dyn_rng_29','vanilla_rf64.wav',1)
+	callTest('dyn_rng_30','vanilla_bw64.wav',1)
+	callTest('dyn_rng_31','vanilla.w64',1)
+	print("")
+	print("***Test ID 32 tests the tool for a signal read from stdin (same results as ID 14)***")
+	callStdinTest('dyn_rng_32','vanilla.wav')
+	print("")
+	print("***Test ID 33 tests the tool for a stream whose header gives no length (sizes 0xFFFFFFFF, same results as ID 14)***")
+	callStdinTest('dyn_rng_33','vanilla_nolength.wav')
+	print("")
+	print("***Test ID 34 tests the -ra switch, reading ahead in a background thread (same results as ID 14)***")
+	callOptionTest('dyn_rng_34','vanilla.wav','-ra')
+	print("")
+	print("***Test ID 35 and 36 test the -cache switch: 35 decodes and writes the cache, 36 reads it (same results as ID 14)***")
+	clearFiles('Test_Signals/vanilla.wav.satscache')
+	callOptionTest('dyn_rng_35','vanilla.wav','-cache')
+	callOptionTest('dyn_rng_36','vanilla.wav','-cache')
+	clearFiles('Test_Signals/vanilla.wav.satscache')
 	printCall()
 	printCompare()
 	callCompare('dyn_rng',1,9)
-	callCompare('dyn_rng',11,12)
-	callCompare('dyn_rng',14,29)
+	callCompare('dyn_rng',11,13)
+	callCompare('dyn_rng',14,37)
 	#callCompare('dyn_rng',20,29)
 	printResult()
 	return
@@ -772,6 +831,7 @@ def noise_mod():
 	printCall()
 	printCompare()
 	callCompare('noise_mod',3,5)
+	callCompare('noise_mod',6,7)
 	printResult()
 	return
   
@@ -968,7 +1028,7 @@ def thd_vs_freq():
 	print("**All Test cases for this binary are executed with silence stripping (without -s) unless specified in the individual test case description**" )
 	print("The expected results have a variation of 0.01dB and cross platform variation is expected")
 	print("")
-	print("Test ID 03 to 23")
+	print("Test ID 03 to 29")
 	print("")
 	print("***Test ID 03 to 08 test the tool for multi channel signals and various sampling rates***")
 	callTest('thd_vs_freq_03','6_frqstp_32_384.wav',3)
@@ -1002,11 +1062,26 @@ def thd_vs_freq():
 	print("")
 	print("***Test ID 23 tests the tool for powermin switch***")
 	callLevelTest('thd_vs_freq_23','fr_thdvf_dd20-1dB_silence.wav','pm',-99,0)
+	print("")
+	print("***Test ID 24 tests the tool for a 96kHz signal, whose THD must read as it does at 48kHz***")
+	callTest('thd_vs_freq_24','thdvf_dist_96000.wav',1)
+	print("")
+	print("***Test ID 25 and 26 test the -dwells switch: 25 saves the dwell map, 26 replays it (same results as ID 24)***")
+	clearFiles('Test_Results/thd_vs_freq_dwells.map')
+	callDwellsTest('thd_vs_freq_25','thdvf_dist_96000.wav','thd_vs_freq_dwells.map')
+	callDwellsTest('thd_vs_freq_26','thdvf_dist_96000.wav','thd_vs_freq_dwells.map')
+	print("")
+	print("***Test ID 27 tests the -j switch, measuring the dwells on 4 threads (same results as ID 24)***")
+	callOptionTest('thd_vs_freq_27','thdvf_dist_96000.wav','-j 4')
+	print("")
+	print("***Test ID 28 and 29 test a sweep with a dwell that can't be measured, without and with -j (same results)***")
+	callTest('thd_vs_freq_28','thdvf_baddwell_48000.wav',1)
+	callOptionTest('thd_vs_freq_29','thdvf_baddwell_48000.wav','-j 4')
 	printCall()
 	printCompare()
 	callCompare('thd_vs_freq',3,12)
 	callCompare('thd_vs_freq',13,17)
-	callCompare('thd_vs_freq',20,24)
+	callCompare('thd_vs_freq',20,30)
 	printResult()
 	return
 
@@ -1031,6 +1106,7 @@ def thd_vs_level():
 	printCall()
 	printCompare()
 	callCompare('thd_vs_level',1,8)
+	callCompare('thd_vs_level',9,10)
 	printResult()
 	return
 ###################################
@@ -136,8 +136,8 @@ DLB_GETPARAM_RETVAL dlb_getparam_parse(DLB_GETPARAM_HANDLE hGetParam
     nr = -1;
     for (i = 1; i < argc; i++)
     {
-        /* switch starts with '-' and does not continue with 0..9 */
-        if (( argv[i][0] == '-') && (argv[i][1] < '0' || argv[i][1] > '9'))
+        /* switch starts with '-' and does not continue with 0..9; a lone '-' is a value (stdin) */
+        if (( argv[i][0] == '-') && argv[i][1] != '\0' && (argv[i][1] < '0' || argv[i][1] > '9'))
         {
             /* switch found, saving name */
             nr++;
@@ -0,0 +1,964 @@
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	SATS_fft.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
+;***************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "SATS_fft.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SATS_FFT_THREADS 1
+#include <pthread.h>
+#elif defined(_WIN32)
+#define SATS_FFT_SRWLOCK 1
+#include <windows.h>
+#endif
+
+#ifdef SATS_FFT_SIMD
+/* ------------------- Native vectorised backend ------------------------------ */
+/*
+ * Real FFT of even length N through a complex FFT of length N/2 (as in
+ * kiss_fftr), with the complex FFT done as a Stockham autosort transform
+ * on split real/imaginary arrays.  Radix 4, 2, 3 and 5 have dedicated
+ * butterflies; any other prime factor goes through a generic O(p^2) pass.
+ * Every butterfly loop runs over unit-stride data so the compiler can
+ * vectorise it; the whole transform is built once per instruction set and
+ * the widest one the CPU supports is picked when a plan is created.  FMA
+ * contraction is kept off (AVX-512 would otherwise bring it in), so every
+ * variant gives bit-identical results.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SATS_FFT_DISPATCH 1
+#endif
+
+#if defined(__GNUC__)
+#define SATS_FFT_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define SATS_FFT_INLINE static __forceinline
+#else
+#define SATS_FFT_INLINE static inline
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* The rows a butterfly writes never overlap, whatever the stride */
+#if defined(__GNUC__) && !defined(__clang__)
+#define SATS_FFT_IVDEP _Pragma("GCC ivdep")
+#else
+#define SATS_FFT_IVDEP
+#endif
+
+#define SATS_FFT_STAGES_MAX 64
+
+typedef struct
+{
+    int radix;
+    int m;              /* butterflies per pass: current length / radix */
+    int s;              /* stride: product of the radices already done */
+    double *wr;         /* twiddles w^(j*t) for t = 1..radix-1, j = 0..m-1 */
+    double *wi;
+    double *cr;         /* generic radix only: exp(-2*pi*i*k/radix) */
+    double *ci;
+} SATS_FFT_Stage;
+
+typedef void (*SATS_FFT_RealForward)(SATS_FFT_HANDLE h, const double *in, SATS_FFT_Complex *out);
+typedef void (*SATS_FFT_RealInverse)(SATS_FFT_HANDLE h, const SATS_FFT_Complex *in, double *out);
+
+struct SATS_FFT_Plan_s
+{
+    int nfft;           /* real length */
+    int ncfft;          /* complex length, nfft / 2 */
+    int nstages;
+    SATS_FFT_Stage stage[SATS_FFT_STAGES_MAX];
+    double *sr;         /* real-split twiddles, index 1..ncfft/2 */
+    double *si;
+    double *work;       /* two split ping-pong buffers plus generic scratch */
+    double *scratch;
+    double *tables;     /* backing store for everything above */
+    SATS_FFT_RealForward forward;
+    SATS_FFT_RealInverse inverse;
+};
+
+
+SATS_FFT_INLINE void sats_fft_pass2(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 2 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double b1r = a0r - a1r, b1i = a0i - a1i;
+
+            yr[o] = a0r + a1r;
+            yi[o] = a0i + a1i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+        }
+    }
+}
+
+
+SATS_FFT_INLINE void sats_fft_pass3(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    const double k3 = 0.86602540378443864676;       /* sin(2*pi/3) */
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+        const double w2r = wr[j + m], w2i = wi[j + m];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 3 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+            const double sr = a1r + a2r, si = a1i + a2i;
+            const double dr = k3 * (a1r - a2r), di = k3 * (a1i - a2i);
+            const double mr = a0r - 0.5 * sr, mi = a0i - 0.5 * si;
+            const double b1r = mr + di, b1i = mi - dr;      /* m - i*d */
+            const double b2r = mr - di, b2i = mi + dr;      /* m + i*d */
+
+            yr[o] = a0r + sr;
+            yi[o] = a0i + si;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+        }
+    }
+}
+
+
+SATS_FFT_INLINE void sats_fft_pass4(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+        const double w2r = wr[j + m], w2i = wi[j + m];
+        const double w3r = wr[j + 2 * m], w3i = wi[j + 2 * m];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 4 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+            const double a3r = xr[i + 3 * s * m], a3i = xi[i + 3 * s * m];
+            const double t0r = a0r + a2r, t0i = a0i + a2i;
+            const double t1r = a0r - a2r, t1i = a0i - a2i;
+            const double t2r = a1r + a3r, t2i = a1i + a3i;
+            const double t3r = a1r - a3r, t3i = a1i - a3i;
+            const double b1r = t1r + t3i, b1i = t1i - t3r;  /* t1 - i*t3 */
+            const double b2r = t0r - t2r, b2i = t0i - t2i;
+            const double b3r = t1r - t3i, b3i = t1i + t3r;  /* t1 + i*t3 */
+
+            yr[o] = t0r + t2r;
+            yi[o] = t0i + t2i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+            yr[o + 3 * s] = b3r * w3r - b3i * w3i;
+            yi[o + 3 * s] = b3r * w3i + b3i * w3r;
+        }
+    }
+}
+
+
+SATS_FFT_INLINE void sats_fft_pass5(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    const double c1 = 0.30901699437494742410;       /* cos(2*pi/5) */
+    const double c2 = -0.80901699437494742410;      /* cos(4*pi/5) */
+    const double s1 = 0.95105651629515357212;       /* sin(2*pi/5) */
+    const double s2 = 0.58778525229247312917;       /* sin(4*pi/5) */
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+        const double w2r = wr[j + m], w2i = wi[j + m];
+        const double w3r = wr[j + 2 * m], w3i = wi[j + 2 * m];
+        const double w4r = wr[j + 3 * m], w4i = wi[j + 3 * m];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 5 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+            const double a3r = xr[i + 3 * s * m], a3i = xi[i + 3 * s * m];
+            const double a4r = xr[i + 4 * s * m], a4i = xi[i + 4 * s * m];
+            const double s14r = a1r + a4r, s14i = a1i + a4i;
+            const double d14r = a1r - a4r, d14i = a1i - a4i;
+            const double s23r = a2r + a3r, s23i = a2i + a3i;
+            const double d23r = a2r - a3r, d23i = a2i - a3i;
+            const double p1r = a0r + c1 * s14r + c2 * s23r, p1i = a0i + c1 * s14i + c2 * s23i;
+            const double p2r = a0r + c2 * s14r + c1 * s23r, p2i = a0i + c2 * s14i + c1 * s23i;
+            const double e1r = s1 * d14r + s2 * d23r, e1i = s1 * d14i + s2 * d23i;
+            const double e2r = s2 * d14r - s1 * d23r, e2i = s2 * d14i - s1 * d23i;
+            const double b1r = p1r + e1i, b1i = p1i - e1r;  /* p1 - i*e1 */
+            const double b4r = p1r - e1i, b4i = p1i + e1r;  /* p1 + i*e1 */
+            const double b2r = p2r + e2i, b2i = p2i - e2r;  /* p2 - i*e2 */
+            const double b3r = p2r - e2i, b3i = p2i + e2r;  /* p2 + i*e2 */
+
+            yr[o] = a0r + s14r + s23r;
+            yi[o] = a0i + s14i + s23i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+            yr[o + 3 * s] = b3r * w3r - b3i * w3i;
+            yi[o + 3 * s] = b3r * w3i + b3i * w3r;
+            yr[o + 4 * s] = b4r * w4r - b4i * w4i;
+            yi[o + 4 * s] = b4r * w4i + b4i * w4r;
+        }
+    }
+}
+
+
+SATS_FFT_INLINE void sats_fft_pass7(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    const double c1 = 0.62348980185873353053;       /* cos(2*pi*k/7) */
+    const double c2 = -0.22252093395631440429;
+    const double c3 = -0.90096886790241912624;
+    const double s1 = 0.78183148246802980871;       /* sin(2*pi*k/7) */
+    const double s2 = 0.97492791218182360702;
+    const double s3 = 0.43388373911755812048;
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+        const double w2r = wr[j + m], w2i = wi[j + m];
+        const double w3r = wr[j + 2 * m], w3i = wi[j + 2 * m];
+        const double w4r = wr[j + 3 * m], w4i = wi[j + 3 * m];
+        const double w5r = wr[j + 4 * m], w5i = wi[j + 4 * m];
+        const double w6r = wr[j + 5 * m], w6i = wi[j + 5 * m];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 7 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+            const double a3r = xr[i + 3 * s * m], a3i = xi[i + 3 * s * m];
+            const double a4r = xr[i + 4 * s * m], a4i = xi[i + 4 * s * m];
+            const double a5r = xr[i + 5 * s * m], a5i = xi[i + 5 * s * m];
+            const double a6r = xr[i + 6 * s * m], a6i = xi[i + 6 * s * m];
+            const double s16r = a1r + a6r, s16i = a1i + a6i;
+            const double d16r = a1r - a6r, d16i = a1i - a6i;
+            const double s25r = a2r + a5r, s25i = a2i + a5i;
+            const double d25r = a2r - a5r, d25i = a2i - a5i;
+            const double s34r = a3r + a4r, s34i = a3i + a4i;
+            const double d34r = a3r - a4r, d34i = a3i - a4i;
+            const double p1r = a0r + c1 * s16r + c2 * s25r + c3 * s34r, p1i = a0i + c1 * s16i + c2 * s25i + c3 * s34i;
+            const double p2r = a0r + c2 * s16r + c3 * s25r + c1 * s34r, p2i = a0i + c2 * s16i + c3 * s25i + c1 * s34i;
+            const double p3r = a0r + c3 * s16r + c1 * s25r + c2 * s34r, p3i = a0i + c3 * s16i + c1 * s25i + c2 * s34i;
+            const double e1r = s1 * d16r + s2 * d25r + s3 * d34r, e1i = s1 * d16i + s2 * d25i + s3 * d34i;
+            const double e2r = s2 * d16r - s3 * d25r - s1 * d34r, e2i = s2 * d16i - s3 * d25i - s1 * d34i;
+            const double e3r = s3 * d16r - s1 * d25r + s2 * d34r, e3i = s3 * d16i - s1 * d25i + s2 * d34i;
+            const double b1r = p1r + e1i, b1i = p1i - e1r;  /* p1 - i*e1 */
+            const double b6r = p1r - e1i, b6i = p1i + e1r;  /* p1 + i*e1 */
+            const double b2r = p2r + e2i, b2i = p2i - e2r;
+            const double b5r = p2r - e2i, b5i = p2i + e2r;
+            const double b3r = p3r + e3i, b3i = p3i - e3r;
+            const double b4r = p3r - e3i, b4i = p3i + e3r;
+
+            yr[o] = a0r + s16r + s25r + s34r;
+            yi[o] = a0i + s16i + s25i + s34i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+            yr[o + 3 * s] = b3r * w3r - b3i * w3i;
+            yi[o + 3 * s] = b3r * w3i + b3i * w3r;
+            yr[o + 4 * s] = b4r * w4r - b4i * w4i;
+            yi[o + 4 * s] = b4r * w4i + b4i * w4r;
+            yr[o + 5 * s] = b5r * w5r - b5i * w5i;
+            yi[o + 5 * s] = b5r * w5i + b5i * w5r;
+            yr[o + 6 * s] = b6r * w6r - b6i * w6i;
+            yi[o + 6 * s] = b6r * w6i + b6i * w6r;
+        }
+    }
+}
+
+
+/* Radix 8 as two radix-4 butterflies joined by the eighth roots of unity */
+SATS_FFT_INLINE void sats_fft_pass8(int m, int s, const double *restrict wr, const double *restrict wi,
+                                    const double *restrict xr, const double *restrict xi,
+                                    double *restrict yr, double *restrict yi)
+{
+    const double r2 = 0.70710678118654752440;       /* 1/sqrt(2) */
+    int j, q;
+
+    for (j = 0; j < m; j++)
+    {
+        const double w1r = wr[j], w1i = wi[j];
+        const double w2r = wr[j + m], w2i = wi[j + m];
+        const double w3r = wr[j + 2 * m], w3i = wi[j + 2 * m];
+        const double w4r = wr[j + 3 * m], w4i = wi[j + 3 * m];
+        const double w5r = wr[j + 4 * m], w5i = wi[j + 4 * m];
+        const double w6r = wr[j + 5 * m], w6i = wi[j + 5 * m];
+        const double w7r = wr[j + 6 * m], w7i = wi[j + 6 * m];
+
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + 8 * s * j;
+            const double a0r = xr[i], a0i = xi[i];
+            const double a1r = xr[i + s * m], a1i = xi[i + s * m];
+            const double a2r = xr[i + 2 * s * m], a2i = xi[i + 2 * s * m];
+            const double a3r = xr[i + 3 * s * m], a3i = xi[i + 3 * s * m];
+            const double a4r = xr[i + 4 * s * m], a4i = xi[i + 4 * s * m];
+            const double a5r = xr[i + 5 * s * m], a5i = xi[i + 5 * s * m];
+            const double a6r = xr[i + 6 * s * m], a6i = xi[i + 6 * s * m];
+            const double a7r = xr[i + 7 * s * m], a7i = xi[i + 7 * s * m];
+            /* even points a0 a2 a4 a6 */
+            const double t0r = a0r + a4r, t0i = a0i + a4i;
+            const double t1r = a0r - a4r, t1i = a0i - a4i;
+            const double t2r = a2r + a6r, t2i = a2i + a6i;
+            const double t3r = a2r - a6r, t3i = a2i - a6i;
+            const double u0r = t0r + t2r, u0i = t0i + t2i;
+            const double u1r = t1r + t3i, u1i = t1i - t3r;
+            const double u2r = t0r - t2r, u2i = t0i - t2i;
+            const double u3r = t1r - t3i, u3i = t1i + t3r;
+            /* odd points a1 a3 a5 a7 */
+            const double t4r = a1r + a5r, t4i = a1i + a5i;
+            const double t5r = a1r - a5r, t5i = a1i - a5i;
+            const double t6r = a3r + a7r, t6i = a3i + a7i;
+            const double t7r = a3r - a7r, t7i = a3i - a7i;
+            const double v0r = t4r + t6r, v0i = t4i + t6i;
+            const double v1r = t5r + t7i, v1i = t5i - t7r;
+            const double v2r = t4r - t6r, v2i = t4i - t6i;
+            const double v3r = t5r - t7i, v3i = t5i + t7r;
+            /* v1 * exp(-i*pi/4), v2 * -i, v3 * exp(-3i*pi/4) */
+            const double x1r = r2 * (v1r + v1i), x1i = r2 * (v1i - v1r);
+            const double x2r = v2i, x2i = -v2r;
+            const double x3r = r2 * (v3i - v3r), x3i = -r2 * (v3r + v3i);
+            const double b1r = u1r + x1r, b1i = u1i + x1i;
+            const double b2r = u2r + x2r, b2i = u2i + x2i;
+            const double b3r = u3r + x3r, b3i = u3i + x3i;
+            const double b4r = u0r - v0r, b4i = u0i - v0i;
+            const double b5r = u1r - x1r, b5i = u1i - x1i;
+            const double b6r = u2r - x2r, b6i = u2i - x2i;
+            const double b7r = u3r - x3r, b7i = u3i - x3i;
+
+            yr[o] = u0r + v0r;
+            yi[o] = u0i + v0i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+            yr[o + 3 * s] = b3r * w3r - b3i * w3i;
+            yi[o + 3 * s] = b3r * w3i + b3i * w3r;
+            yr[o + 4 * s] = b4r * w4r - b4i * w4i;
+            yi[o + 4 * s] = b4r * w4i + b4i * w4r;
+            yr[o + 5 * s] = b5r * w5r - b5i * w5i;
+            yi[o + 5 * s] = b5r * w5i + b5i * w5r;
+            yr[o + 6 * s] = b6r * w6r - b6i * w6i;
+            yi[o + 6 * s] = b6r * w6i + b6i * w6r;
+            yr[o + 7 * s] = b7r * w7r - b7i * w7i;
+            yi[o + 7 * s] = b7r * w7i + b7i * w7r;
+        }
+    }
+}
+
+
+/* Any other prime radix: direct DFT of each group of p points */
+static void sats_fft_pass_generic(const SATS_FFT_Stage *st, double *scratch,
+                                  const double *xr, const double *xi, double *yr, double *yi)
+{
+    const int p = st->radix, m = st->m, s = st->s;
+    double *ar = scratch, *ai = scratch + p;
+    int j, q, r, t, k;
+
+    for (j = 0; j < m; j++)
+    {
+        SATS_FFT_IVDEP
+        for (q = 0; q < s; q++)
+        {
+            const int i = q + s * j;
+            const int o = q + p * s * j;
+
+            for (r = 0; r < p; r++)
+            {
+                ar[r] = xr[i + r * s * m];
+                ai[r] = xi[i + r * s * m];
+            }
+            for (t = 0; t < p; t++)
+            {
+                double br = ar[0], bi = ai[0];
+
+                for (r = 1, k = t; r < p; r++, k += t)
+                {
+                    if (k >= p)
+                        k -= p;
+                    br += ar[r] * st->cr[k] - ai[r] * st->ci[k];
+                    bi += ar[r] * st->ci[k] + ai[r] * st->cr[k];
+                }
+                if (t == 0)
+                {
+                    yr[o] = br;
+                    yi[o] = bi;
+                }
+                else
+                {
+                    const double w_r = st->wr[(t - 1) * m + j], w_i = st->wi[(t - 1) * m + j];
+
+                    yr[o + t * s] = br * w_r - bi * w_i;
+                    yi[o + t * s] = br * w_i + bi * w_r;
+                }
+            }
+        }
+    }
+}
+
+
+/*
+ * Forward complex FFT of the ncfft points in (xr, xi), using (yr, yi) as
+ * the other half of the ping-pong.  Returns the buffer the result ends in.
+ * The first pass has unit stride; running it through a copy of the loop
+ * with s fixed at 1 lets the compiler vectorise over j instead of q.
+ */
+SATS_FFT_INLINE double *sats_fft_complex(SATS_FFT_HANDLE h, double *xr, double *xi, double *yr, double *yi)
+{
+    int n;
+
+    for (n = 0; n < h->nstages; n++)
+    {
+        const SATS_FFT_Stage *st = &h->stage[n];
+        double *tr, *ti;
+
+        switch (st->radix)
+        {
+        case 2:
+            if (st->s == 1)
+                sats_fft_pass2(st->m, 1, st->wr, st->wi, xr, xi, yr, yi);
+            else
+                sats_fft_pass2(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        case 3:
+            if (st->s == 1)
+                sats_fft_pass3(st->m, 1, st->wr, st->wi, xr, xi, yr, yi);
+            else
+                sats_fft_pass3(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        case 4:
+            if (st->s == 1)
+                sats_fft_pass4(st->m, 1, st->wr, st->wi, xr, xi, yr, yi);
+            else
+                sats_fft_pass4(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        case 5:
+            if (st->s == 1)
+                sats_fft_pass5(st->m, 1, st->wr, st->wi, xr, xi, yr, yi);
+            else
+                sats_fft_pass5(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        case 7:
+            sats_fft_pass7(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        case 8:
+            if (st->s == 1)
+                sats_fft_pass8(st->m, 1, st->wr, st->wi, xr, xi, yr, yi);
+            else
+                sats_fft_pass8(st->m, st->s, st->wr, st->wi, xr, xi, yr, yi);
+            break;
+        default:
+            sats_fft_pass_generic(st, h->scratch, xr, xi, yr, yi);
+            break;
+        }
+        tr = xr; xr = yr; yr = tr;
+        ti = xi; xi = yi; yi = ti;
+    }
+    return xr;
+}
+
+
+SATS_FFT_INLINE void sats_fft_forward_body(SATS_FFT_HANDLE h, const double *restrict in, SATS_FFT_Complex *restrict out)
+{
+    const int n = h->ncfft;
+    const double *restrict sr = h->sr;
+    const double *restrict si = h->si;
+    double *xr = h->work;
+    double *xi = xr + n;
+    const double *zr;
+    const double *zi;
+    const int half = (n - 1) / 2;
+    int k;
+
+    for (k = 0; k < n; k++)
+    {
+        xr[k] = in[2 * k];
+        xi[k] = in[2 * k + 1];
+    }
+    zr = sats_fft_complex(h, xr, xi, xi + n, xi + 2 * n);
+    zi = zr + n;
+
+    out[0].r = zr[0] + zi[0];
+    out[0].i = 0.0;
+    out[n].r = zr[0] - zi[0];
+    out[n].i = 0.0;
+    for (k = 1; k <= half; k++)
+    {
+        const double f1r = zr[k] + zr[n - k], f1i = zi[k] - zi[n - k];
+        const double f2r = zr[k] - zr[n - k], f2i = zi[k] + zi[n - k];
+        const double tr = f2r * sr[k] - f2i * si[k];
+        const double ti = f2r * si[k] + f2i * sr[k];
+
+        out[k].r = 0.5 * (f1r + tr);
+        out[k].i = 0.5 * (f1i + ti);
+        out[n - k].r = 0.5 * (f1r - tr);
+        out[n - k].i = 0.5 * (ti - f1i);
+    }
+    if (n % 2 == 0)
+    {
+        out[k].r = zr[k];
+        out[k].i = -zi[k];
+    }
+}
+
+
+SATS_FFT_INLINE void sats_fft_inverse_body(SATS_FFT_HANDLE h, const SATS_FFT_Complex *restrict in, double *restrict out)
+{
+    const int n = h->ncfft;
+    const double *restrict sr = h->sr;
+    const double *restrict si = h->si;
+    double *xr = h->work;
+    double *xi = xr + n;
+    const double *zr;
+    const double *zi;
+    const int half = (n - 1) / 2;
+    int k;
+
+    /* Built conjugated, so the forward passes give the conjugate of the inverse */
+    xr[0] = in[0].r + in[n].r;
+    xi[0] = in[n].r - in[0].r;
+    for (k = 1; k <= half; k++)
+    {
+        const double er = in[k].r + in[n - k].r, ei = in[k].i - in[n - k].i;
+        const double dr = in[k].r - in[n - k].r, di = in[k].i + in[n - k].i;
+        const double or_ = dr * sr[k] + di * si[k];     /* inverse uses conj(s) */
+        const double oi = di * sr[k] - dr * si[k];
+
+        xr[k] = er + or_;
+        xi[k] = -(ei + oi);
+        xr[n - k] = er - or_;
+        xi[n - k] = ei - oi;
+    }
+    if (n % 2 == 0)
+    {
+        xr[k] = 2.0 * in[k].r;
+        xi[k] = 2.0 * in[k].i;
+    }
+    zr = sats_fft_complex(h, xr, xi, xi + n, xi + 2 * n);
+    zi = zr + n;
+
+    for (k = 0; k < n; k++)
+    {
+        out[2 * k] = zr[k];
+        out[2 * k + 1] = -zi[k];
+    }
+}
+
+
+static void sats_fft_forward_c(SATS_FFT_HANDLE h, const double *in, SATS_FFT_Complex *out)
+{
+    sats_fft_forward_body(h, in, out);
+}
+
+static void sats_fft_inverse_c(SATS_FFT_HANDLE h, const SATS_FFT_Complex *in, double *out)
+{
+    sats_fft_inverse_body(h, in, out);
+}
+
+#ifdef SATS_FFT_DISPATCH
+#define SATS_FFT_VARIANT(isa, features)                                                             \
+static __attribute__((target(features), optimize("fp-contract=off")))                              \
+void sats_fft_forward_##isa(SATS_FFT_HANDLE h, const double *in, SATS_FFT_Complex *out)             \
+{                                                                                                   \
+    sats_fft_forward_body(h, in, out);                                                              \
+}                                                                                                   \
+static __attribute__((target(features), optimize("fp-contract=off")))                              \
+void sats_fft_inverse_##isa(SATS_FFT_HANDLE h, const SATS_FFT_Complex *in, double *out)             \
+{                                                                                                   \
+    sats_fft_inverse_body(h, in, out);                                                              \
+}
+
+SATS_FFT_VARIANT(avx512, "avx512f,prefer-vector-width=512")
+SATS_FFT_VARIANT(avx2, "avx2")
+SATS_FFT_VARIANT(sse2, "sse2")
+#endif
+
+
+/* Pick the widest transform this CPU can run */
+static void sats_fft_select(SATS_FFT_HANDLE h)
+{
+    h->forward = sats_fft_forward_c;
+    h->inverse = sats_fft_inverse_c;
+#ifdef SATS_FFT_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        h->forward = sats_fft_forward_avx512;
+        h->inverse = sats_fft_inverse_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        h->forward = sats_fft_forward_avx2;
+        h->inverse = sats_fft_inverse_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        h->forward = sats_fft_forward_sse2;
+        h->inverse = sats_fft_inverse_sse2;
+    }
+#endif
+}
+
+
+/*
+ * Split n into its power of two first, as radix 8 passes topped up with
+ * radix 4 (8*4*4 rather than 8*8*2; a lone 2 only for an odd power), then
+ * 3, 5, 7 and any remaining primes.  The unit-stride first pass then has a
+ * power-of-two radix whenever n is even, which is the case the compiler
+ * vectorises best.
+ */
+static int sats_fft_factor(int n, int *radix)
+{
+    int count = 0;
+    int e = 0;
+    int p;
+
+    while (n % 2 == 0)
+    {
+        n /= 2;
+        e++;
+    }
+    while (e >= 3 && e != 4)
+    {
+        radix[count++] = 8;
+        e -= 3;
+    }
+    while (e >= 2)
+    {
+        radix[count++] = 4;
+        e -= 2;
+    }
+    if (e == 1)
+    {
+        radix[count++] = 2;
+    }
+    for (p = 3; n > 1; )
+    {
+        if (p * p > n)
+            p = n;
+        if (n % p == 0)
+        {
+            if (count == SATS_FFT_STAGES_MAX)
+                return -1;
+            radix[count++] = p;
+            n /= p;
+        }
+        else
+        {
+            p += 2;
+        }
+    }
+    return count;
+}
+
+
+SATS_FFT_Status SATS_FFT_CreateDirection(SATS_FFT_HANDLE *ph, int fft_size, int direction)
+{
+    SATS_FFT_HANDLE h;
+    int radix[SATS_FFT_STAGES_MAX];
+    int i, j, t, n, s, maxp = 1;
+    size_t size;
+    double *pt;
+
+    (void)direction;
+    *ph = 0;
+    if (fft_size < 2 || (fft_size & 1))
+        return 0;
+
+    h = (SATS_FFT_HANDLE)calloc(1, sizeof(*h));
+    if (h == NULL)
+        return 0;
+    h->nfft = fft_size;
+    h->ncfft = fft_size / 2;
+    h->nstages = sats_fft_factor(h->ncfft, radix);
+    if (h->nstages < 0)
+    {
+        free(h);
+        return 0;
+    }
+
+    /* 2*(r-1)*m twiddles per stage add up to less than 2*ncfft*nstages */
+    size = 0;
+    for (i = 0, n = h->ncfft; i < h->nstages; i++)
+    {
+        size += 2 * (size_t)(radix[i] - 1) * (n / radix[i]) + 2 * (size_t)radix[i];
+        n /= radix[i];
+        if (radix[i] > maxp)
+            maxp = radix[i];
+    }
+    size += 2 * ((size_t)h->ncfft / 2 + 1) + 4 * (size_t)h->ncfft + 2 * (size_t)maxp;
+    h->tables = (double *)malloc(size * sizeof(double));
+    if (h->tables == NULL)
+    {
+        free(h);
+        return 0;
+    }
+
+    pt = h->tables;
+    for (i = 0, n = h->ncfft, s = 1; i < h->nstages; i++)
+    {
+        SATS_FFT_Stage *st = &h->stage[i];
+
+        st->radix = radix[i];
+        st->m = n / radix[i];
+        st->s = s;
+        st->wr = pt;
+        pt += (radix[i] - 1) * st->m;
+        st->wi = pt;
+        pt += (radix[i] - 1) * st->m;
+        for (t = 1; t < radix[i]; t++)
+        {
+            for (j = 0; j < st->m; j++)
+            {
+                const double phase = -2.0 * M_PI * (double)(((long long)j * t) % n) / n;
+
+                st->wr[(t - 1) * st->m + j] = cos(phase);
+                st->wi[(t - 1) * st->m + j] = sin(phase);
+            }
+        }
+        st->cr = pt;
+        pt += radix[i];
+        st->ci = pt;
+        pt += radix[i];
+        for (t = 0; t < radix[i]; t++)
+        {
+            st->cr[t] = cos(-2.0 * M_PI * t / radix[i]);
+            st->ci[t] = sin(-2.0 * M_PI * t / radix[i]);
+        }
+        n /= radix[i];
+        s *= radix[i];
+    }
+
+    /* Same phases as the kiss_fftr super twiddles, indexed from 1 */
+    h->sr = pt;
+    pt += h->ncfft / 2 + 1;
+    h->si = pt;
+    pt += h->ncfft / 2 + 1;
+    for (i = 1; i <= h->ncfft / 2; i++)
+    {
+        const double phase = -M_PI * ((double)i / h->ncfft + 0.5);
+
+        h->sr[i] = cos(phase);
+        h->si[i] = sin(phase);
+    }
+    h->work = pt;
+    pt += 4 * (size_t)h->ncfft;
+    h->scratch = pt;
+
+    sats_fft_select(h);
+    *ph = h;
+    return 1;
+}
+
+
+SATS_FFT_Status SATS_FFT_ComputeForward(SATS_FFT_HANDLE h, double *in, SATS_FFT_Complex *out)
+{
+    h->forward(h, in, out);
+    return 1;
+}
+
+
+SATS_FFT_Status SATS_FFT_ComputeInverse(SATS_FFT_HANDLE h, SATS_FFT_Complex *in, double *out)
+{
+    h->inverse(h, in, out);
+    return 1;
+}
+
+
+SATS_FFT_Status SATS_FFT_Destroy(SATS_FFT_HANDLE *h)
+{
+    if (*h)
+    {
+        free((*h)->tables);
+        free(*h);
+        *h = 0;
+    }
+    return 1;
+}
+
+#endif /* SATS_FFT_SIMD */
+
+
+#define SATS_FFT_PLAN_MAX 32        /* plans kept alive at any one time */
+
+/* A cached plan; busy while a caller holds it between acquire and release */
+typedef struct
+{
+    int fft_size;
+    int direction;
+    int busy;
+    SATS_FFT_HANDLE h;
+} SATS_FFT_CachedPlan;
+
+static SATS_FFT_CachedPlan plan_cache[SATS_FFT_PLAN_MAX];
+static int plan_count = 0;
+
+#ifdef SATS_FFT_THREADS
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+#define PLAN_LOCK()     pthread_mutex_lock(&plan_lock)
+#define PLAN_UNLOCK()   pthread_mutex_unlock(&plan_lock)
+#elif defined(SATS_FFT_SRWLOCK)
+static SRWLOCK plan_lock = SRWLOCK_INIT;
+#define PLAN_LOCK()     AcquireSRWLockExclusive(&plan_lock)
+#define PLAN_UNLOCK()   ReleaseSRWLockExclusive(&plan_lock)
+#else
+#define PLAN_LOCK()
+#define PLAN_UNLOCK()
+#endif
+
+
+static void SATS_FFT_FreePlans(void)
+{
+    int i;
+
+    PLAN_LOCK();
+    for (i = 0; i < plan_count; i++)
+    {
+        (void)SATS_FFT_Destroy(&plan_cache[i].h);
+    }
+    plan_count = 0;
+    PLAN_UNLOCK();
+}
+
+
+/*
+ * Hand out a plan for fft_size/direction, creating it on first use.  Plans
+ * are never shared between concurrent callers (a KISS plan carries its own
+ * scratch buffer), so a second thread asking for a size already in use gets
+ * its own copy.  Returns 0 if no plan could be made; the caller should then
+ * fall back to SATS_FFT_Create().
+ */
+SATS_FFT_HANDLE SATS_FFT_AcquirePlan(int fft_size, int direction)
+{
+    SATS_FFT_HANDLE h = 0;
+    int i;
+
+    PLAN_LOCK();
+    for (i = 0; i < plan_count; i++)
+    {
+        if (!plan_cache[i].busy && plan_cache[i].fft_size == fft_size && plan_cache[i].direction == direction)
+        {
+            plan_cache[i].busy = 1;
+            h = plan_cache[i].h;
+            break;
+        }
+    }
+    if (!h && plan_count < SATS_FFT_PLAN_MAX)
+    {
+        if (SATS_FFT_CreateDirection(&h, fft_size, direction) != SATS_FFT_CREATE_OK || !h)
+        {
+            h = 0;
+        }
+        else
+        {
+            if (plan_count == 0)
+            {
+                atexit(SATS_FFT_FreePlans);
+            }
+            plan_cache[plan_count].fft_size = fft_size;
+            plan_cache[plan_count].direction = direction;
+            plan_cache[plan_count].busy = 1;
+            plan_cache[plan_count].h = h;
+            plan_count++;
+        }
+    }
+    PLAN_UNLOCK();
+    return h;
+}
+
+
+/* Return a plan obtained from SATS_FFT_AcquirePlan() to the cache */
+void SATS_FFT_ReleasePlan(SATS_FFT_HANDLE h)
+{
+    int i;
+
+    PLAN_LOCK();
+    for (i = 0; i < plan_count; i++)
+    {
+        if (plan_cache[i].h == h)
+        {
+            plan_cache[i].busy = 0;
+            break;
+        }
+    }
+    PLAN_UNLOCK();
+}
@@ -45,7 +45,30 @@
 #  define expm1(x) ((fabs(x) < 1e-5) ? ((x) + 0.5*(x)*(x)) : (exp(x) - 1.0))
 #endif
 
-#ifdef KISS_FFT
+/* Transform directions, used to key cached plans */
+#define SATS_FFT_FORWARD 0
+#define SATS_FFT_INVERSE 1
+
+#if defined(SATS_FFT_SIMD)
+
+/* ------------------- Native vectorised implementation (SATS_fft.c) ------------ */
+#include "tools/kiss_fftr.h"
+
+typedef struct SATS_FFT_Plan_s *SATS_FFT_HANDLE;
+typedef kiss_fft_cpx SATS_FFT_Complex;
+typedef int SATS_FFT_Status;
+
+#define SATS_FFT_REAL(c) (c).r
+#define SATS_FFT_IMAG(c) (c).i
+#define SATS_FFT_CREATE_OK 1
+
+extern SATS_FFT_Status SATS_FFT_CreateDirection(SATS_FFT_HANDLE *h, int fft_size, int direction);
+extern SATS_FFT_Status SATS_FFT_ComputeForward(SATS_FFT_HANDLE h, double *in, SATS_FFT_Complex *out);
+extern SATS_FFT_Status SATS_FFT_ComputeInverse(SATS_FFT_HANDLE h, SATS_FFT_Complex *in, double *out);
+extern SATS_FFT_Status SATS_FFT_Destroy(SATS_FFT_HANDLE *h);
+
+
+#elif defined(KISS_FFT)
 
 /* ------------------- KISS FFT Implementation ------------------------------ */
 #include "tools/kiss_fftr.h"
@@ -56,15 +79,17 @@ typedef int SATS_FFT_Status;
 
 #define SATS_FFT_REAL(c) (c).r
 #define SATS_FFT_IMAG(c) (c).i
+#define SATS_FFT_CREATE_OK 1
 
 static inline
 SATS_FFT_Status
-SATS_FFT_Create
+SATS_FFT_CreateDirection
     (SATS_FFT_HANDLE *h
     ,int fft_size
+    ,int direction
     )
 {
-    *h = kiss_fftr_alloc(fft_size, 0, NULL, NULL);
+    *h = kiss_fftr_alloc(fft_size, direction == SATS_FFT_INVERSE, NULL, NULL);
     return *h != 0;
 }
 
@@ -82,6 +107,19 @@ SATS_FFT_ComputeForward
 }
 
 
+static inline
+SATS_FFT_Status
+SATS_FFT_ComputeInverse
+    (SATS_FFT_HANDLE h
+    ,SATS_FFT_Complex *in
+    ,double *out
+    )
+{
+    kiss_fftri(h, in, out);
+    return 1;
+}
+
+
 static inline
 SATS_FFT_Status
 SATS_FFT_Destroy
@@ -107,16 +145,21 @@ typedef MKL_LONG SATS_FFT_Status;
 
 #define SATS_FFT_REAL(c) (c).real
 #define SATS_FFT_IMAG(c) (c).imag
+#define SATS_FFT_CREATE_OK DFTI_NO_ERROR
 
 
+/* One MKL descriptor serves both directions; the argument only keys the plan cache */
 static inline
 SATS_FFT_Status
-SATS_FFT_Create
+SATS_FFT_CreateDirection
     (SATS_FFT_HANDLE *h_in
     ,int fft_size
+    ,int direction
     )
 {
     SATS_FFT_HANDLE h;
+    (void)direction;
+
 //	Configuring FFT:
 //		* Double precision
 //		* Real input
@@ -143,6 +186,18 @@ SATS_FFT_ComputeForward
 }
 
 
+static inline
+SATS_FFT_Status
+SATS_FFT_ComputeInverse
+    (SATS_FFT_HANDLE h
+    ,SATS_FFT_Complex *in
+    ,double *out
+    )
+{
+    return DftiComputeBackward(h, in, out);
+}
+
+
 static inline
 SATS_FFT_Status
 SATS_FFT_Destroy
@@ -157,6 +212,67 @@ SATS_FFT_Destroy
 
 /** --------------------------- common defs ------------------------- */
 
+static inline
+SATS_FFT_Status
+SATS_FFT_Create
+    (SATS_FFT_HANDLE *h
+    ,int fft_size
+    )
+{
+    return SATS_FFT_CreateDirection(h, fft_size, SATS_FFT_FORWARD);
+}
+
+
+/*
+ * Batched forward transform: count frames of the plan's size, frame f read
+ * from in + f*in_dist (doubles; frames may overlap) and written to
+ * out + f*out_dist (complex bins).  Every backend currently runs the
+ * frames one after another through the same plan.
+ */
+static inline
+SATS_FFT_Status
+SATS_FFT_ComputeForwardBatch
+    (SATS_FFT_HANDLE h
+    ,double *in
+    ,long in_dist
+    ,SATS_FFT_Complex *out
+    ,long out_dist
+    ,int count
+    )
+{
+    SATS_FFT_Status status = 0;
+    int f;
+
+    for (f = 0; f < count; f++)
+    {
+        status = SATS_FFT_ComputeForward(h, in + f * in_dist, out + f * out_dist);
+    }
+    return status;
+}
+
+
+/*
+ * Frames worth queueing for one SATS_FFT_ComputeForwardBatch() call.  As no
+ * backend transforms a batch faster than frame by frame, this is 1, and the
+ * callers keep one frame of input and output; a backend that does batch can
+ * return more here.
+ */
+static inline
+int
+SATS_FFT_BatchSize
+    (long fft_size
+    )
+{
+    (void) fft_size;
+    return 1;
+}
+
+
+/* Process-wide plan cache, keyed by size and direction (SATS_fft.c) */
+extern SATS_FFT_HANDLE SATS_FFT_AcquirePlan(int fft_size, int direction);
+extern void SATS_FFT_ReleasePlan(SATS_FFT_HANDLE h);
+
+
 static inline
 void*
 SATS_FFT_malloc
@@ -212,6 +328,15 @@ SATS_FFT_ComputeForward2
     )
 {
     SATS_FFT_HANDLE h;
+    SATS_FFT_Status status;
+
+    h = SATS_FFT_AcquirePlan(fft_size, SATS_FFT_FORWARD);
+    if (h)
+    {
+        status = SATS_FFT_ComputeForward(h, in, out);
+        SATS_FFT_ReleasePlan(h);
+        return status;
+    }
 
     (void)SATS_FFT_Create(&h, fft_size);
     (void)SATS_FFT_ComputeForward(h, in, out);
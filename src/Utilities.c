@@ -31,7 +31,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
 #include "debug.h"
+#include "Utilities.h"
 
 extern int getFileLineCount(char * );
 extern double min_d( double , double  );
@@ -149,3 +153,93 @@ int sign( double value )
     }
 }
 
+/**
+ * @brief   Make sure a workspace holds at least size bytes
+ *
+ * @details Growing moves the arena, so this is only allowed while nothing is handed out.
+ *          A zeroed workspace_t is an empty workspace.
+ *
+ * @param   ws              IN/OUT: Workspace
+ * @param   size            IN: Capacity needed, in bytes (see WORKSPACE_SIZE())
+ *
+ * @return  Returns 0 if successful.  -1 otherwise.
+ */
+int workspace_reserve( workspace_t *ws, size_t size )
+{
+    unsigned char *raw;
+
+    assert(ws->used == 0);
+
+    if (size <= ws->size)
+    {
+        return (0);
+    }
+
+    if ((raw = (unsigned char *) malloc(size + WORKSPACE_ALIGN)) == NULL)
+    {
+        return (-1);
+    }
+
+    free(ws->raw);
+    ws->raw = raw;
+    ws->base = raw + ((WORKSPACE_ALIGN - ((uintptr_t) raw % WORKSPACE_ALIGN)) % WORKSPACE_ALIGN);
+    ws->size = size;
+
+    return (0);
+}
+
+/**
+ * @brief   Take an aligned buffer from a workspace
+ *
+ * @param   ws              IN/OUT: Workspace
+ * @param   size            IN: Buffer size in bytes
+ *
+ * @return  Returns the buffer, or NULL if the workspace is too small.
+ */
+void *workspace_alloc( workspace_t *ws, size_t size )
+{
+    void *p;
+
+    size = WORKSPACE_SIZE(size);
+    if (size > ws->size - ws->used)
+    {
+        return (NULL);
+    }
+
+    p = ws->base + ws->used;
+    ws->used += size;
+
+    return (p);
+}
+
+/**
+ * @brief   Take a zeroed, aligned array of count elements from a workspace
+ *
+ * @return  Returns the array, or NULL if the workspace is too small.
+ */
+void *workspace_calloc( workspace_t *ws, size_t count, size_t size )
+{
+    void *p = workspace_alloc(ws, count * size);
+
+    if (p != NULL)
+    {
+        memset(p, 0, count * size);
+    }
+
+    return (p);
+}
+
+/* Hand back everything taken from a workspace */
+void workspace_reset( workspace_t *ws )
+{
+    ws->used = 0;
+}
+
+void workspace_free( workspace_t *ws )
+{
+    free(ws->raw);
+    ws->raw = NULL;
+    ws->base = NULL;
+    ws->size = 0;
+    ws->used = 0;
+}
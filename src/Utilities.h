@@ -32,6 +32,7 @@
 #ifndef __UTILITIES__
 #define __UTILITIES__
 
+#include <stddef.h>
 #include "debug.h"
 
 /* To shorten error handling code */
@@ -58,5 +59,25 @@ long long imin64( long long i1, long long i2 );
 int imax( int i1, int i2 );
 int sign ( double value );
 
+/* Scratch arena shared by the routines of one analysis.  Routines take their buffers
+ * with workspace_alloc(); the owner sizes it with workspace_reserve() and hands
+ * everything back with workspace_reset() between calls. */
+#define WORKSPACE_ALIGN         ( 32 )
+#define WORKSPACE_SIZE(bytes)   ( (((size_t) (bytes) + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN) * WORKSPACE_ALIGN )
+
+typedef struct
+{
+    unsigned char *raw;         /* as returned by malloc */
+    unsigned char *base;        /* raw, aligned to WORKSPACE_ALIGN */
+    size_t size;                /* capacity in bytes */
+    size_t used;                /* bytes handed out */
+} workspace_t;
+
+int workspace_reserve( workspace_t *ws, size_t size );
+void *workspace_alloc( workspace_t *ws, size_t size );
+void *workspace_calloc( workspace_t *ws, size_t count, size_t size );
+void workspace_reset( workspace_t *ws );
+void workspace_free( workspace_t *ws );
+
 #endif /*__UTILITIES__*/
 
@@ -41,10 +41,9 @@
 extern void print_usage( void );
 char *chart = "title, Amplitude vs. Time,\nxlabel, Time (s),\nylabel, Amplitude (normalized values)\n";
 
-fstruct fst;
-
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res;
     int startCh, endCh;
     int ch;
@@ -73,7 +72,7 @@ int main( int argc, char *argv[] )
 
         fio_resetpos(&fst);
         if (fst.xminSet)
-            fio_setpos(&fst, (long) ((double) fst.xmin * fst.fs));
+            fio_setpos(&fst, (__int64) ((double) fst.xmin * fst.fs));
         res=amplitude_vs_time(&fst);
 		if (res)
 		{
@@ -90,10 +89,14 @@ void print_usage( void )
     fprintf(stderr, "Amplitude vs Time Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: amp_vs_time [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: amp_vs_time [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multichannel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf( stderr, "                   -c a for all channels\n" );
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
     fprintf(stderr, "-xmin <lim>,        selects minimum x-axis limit\n");
@@ -48,8 +48,28 @@ extern real64_T lp_48000_b[][3];
 extern int lp_48000_al[];
 extern real64_T lp_48000_a[][3];
 
+extern int lp_88200_bl[];
+extern real64_T lp_88200_b[][3];
+extern int lp_88200_al[];
+extern real64_T lp_88200_a[][3];
+
+extern int lp_96000_bl[];
+extern real64_T lp_96000_b[][3];
+extern int lp_96000_al[];
+extern real64_T lp_96000_a[][3];
+
+extern int lp_176400_bl[];
+extern real64_T lp_176400_b[][3];
+extern int lp_176400_al[];
+extern real64_T lp_176400_a[][3];
+
+extern int lp_192000_bl[];
+extern real64_T lp_192000_b[][3];
+extern int lp_192000_al[];
+extern real64_T lp_192000_a[][3];
+
 /* dynamic range 200 Hz notch filter for 32000 kHz sample rate */
-SOS_FILTER dr_no_32000 =
+const SOS_FILTER dr_no_32000 =
 	{
 	DR_NO_32000_NSEC,
 	dr_no_32000_bl,
@@ -61,7 +81,7 @@ SOS_FILTER dr_no_32000 =
 	};
 
 /* dynamic range ccir468 filter for 32000 kHz sample rate */
-SOS_FILTER ccir468_32000 =
+const SOS_FILTER ccir468_32000 =
 	{
 	CCIR468_32000_NSEC,
 	ccir468_32000_bl,
@@ -73,7 +93,7 @@ SOS_FILTER ccir468_32000 =
 	};
 
 /* dynamic range filters concatenated for 32000 kHz sample rate */
-SOS_FILTER dr_32000 =
+const SOS_FILTER dr_32000 =
 	{
 	DR_32000_NSEC,
 	dr_32000_bl,
@@ -85,7 +105,7 @@ SOS_FILTER dr_32000 =
 	};
 
 /* dynamic range 200 Hz notch filter for 44100 kHz sample rate */
-SOS_FILTER dr_no_44100 =
+const SOS_FILTER dr_no_44100 =
 	{
 	DR_NO_44100_NSEC,
 	dr_no_44100_bl,
@@ -97,7 +117,7 @@ SOS_FILTER dr_no_44100 =
 	};
 
 /* dynamic range low pass filter for 44100 kHz sample rate */
-SOS_FILTER dr_lp_44100 =
+const SOS_FILTER dr_lp_44100 =
 	{
 	LP_44100_NSEC,
 	lp_44100_bl,
@@ -109,7 +129,7 @@ SOS_FILTER dr_lp_44100 =
 	};
 
 /* dynamic range ccir468 filter for 44100 kHz sample rate */
-SOS_FILTER ccir468_44100 =
+const SOS_FILTER ccir468_44100 =
 	{
 	CCIR468_44100_NSEC,
 	ccir468_44100_bl,
@@ -121,7 +141,7 @@ SOS_FILTER ccir468_44100 =
 	};
 
 /* dynamic range filters concatenated for 44100 kHz sample rate */
-SOS_FILTER dr_44100 =
+const SOS_FILTER dr_44100 =
 	{
 	DR_44100_NSEC,
 	dr_44100_bl,
@@ -133,7 +153,7 @@ SOS_FILTER dr_44100 =
 	};
 
 /* dynamic range 200 Hz notch filter for 48000 kHz sample rate */
-SOS_FILTER dr_no_48000 =
+const SOS_FILTER dr_no_48000 =
 	{
 	DR_NO_48000_NSEC,
 	dr_no_48000_bl,
@@ -145,7 +165,7 @@ SOS_FILTER dr_no_48000 =
 	};
 
 /* dynamic range low pass filter for 48000 kHz sample rate */
-SOS_FILTER dr_lp_48000 =
+const SOS_FILTER dr_lp_48000 =
 	{
 	LP_48000_NSEC,
 	lp_48000_bl,
@@ -157,7 +177,7 @@ SOS_FILTER dr_lp_48000 =
 	};
 
 /* dynamic range ccir468 filter for 48000 kHz sample rate */
-SOS_FILTER ccir468_48000 =
+const SOS_FILTER ccir468_48000 =
 	{
 	CCIR468_48000_NSEC,
 	ccir468_48000_bl,
@@ -169,7 +189,7 @@ SOS_FILTER ccir468_48000 =
 	};
 
 /* dynamic range filters concatenated for 48000 kHz sample rate */
-SOS_FILTER dr_48000 =
+const SOS_FILTER dr_48000 =
 	{
 	DR_48000_NSEC,
 	dr_48000_bl,
@@ -180,7 +200,55 @@ SOS_FILTER dr_48000 =
 	z2
 	};
 
-SOS_FILTER on_fly_notch =
+/* dynamic range low pass filter for 88200 kHz sample rate */
+const SOS_FILTER dr_lp_88200 =
+	{
+	LP_88200_NSEC,
+	lp_88200_bl,
+	lp_88200_b,
+	lp_88200_al,
+	lp_88200_a,
+	z1,
+	z2
+	};
+
+/* dynamic range low pass filter for 96000 kHz sample rate */
+const SOS_FILTER dr_lp_96000 =
+	{
+	LP_96000_NSEC,
+	lp_96000_bl,
+	lp_96000_b,
+	lp_96000_al,
+	lp_96000_a,
+	z1,
+	z2
+	};
+
+/* dynamic range low pass filter for 176400 kHz sample rate */
+const SOS_FILTER dr_lp_176400 =
+	{
+	LP_176400_NSEC,
+	lp_176400_bl,
+	lp_176400_b,
+	lp_176400_al,
+	lp_176400_a,
+	z1,
+	z2
+	};
+
+/* dynamic range low pass filter for 192000 kHz sample rate */
+const SOS_FILTER dr_lp_192000 =
+	{
+	LP_192000_NSEC,
+	lp_192000_bl,
+	lp_192000_b,
+	lp_192000_al,
+	lp_192000_a,
+	z1,
+	z2
+	};
+
+const SOS_FILTER on_fly_notch =
 	{
 	ON_FLY_NOTCH_NSEC,
 	on_fly_notch_bl,
@@ -210,65 +278,3 @@ SOS_FILTER ellip_48000 =
 	};			
 */	
 
-void init_dr_filters( void )
-{
-    if (init_sos_filter(&dr_no_32000))
-        exit(-10);
-    if (init_sos_filter(&ccir468_32000))
-        exit(-10);
-    if (init_sos_filter(&dr_32000))
-        exit(-10);
-
-    if (init_sos_filter(&dr_no_44100))
-        exit(-10);
-    if (init_sos_filter(&dr_lp_44100))
-        exit(-10);
-    if (init_sos_filter(&ccir468_44100))
-        exit(-10);
-    if (init_sos_filter(&dr_44100))
-        exit(-10);
-
-    if (init_sos_filter(&dr_no_48000))
-        exit(-10);
-    if (init_sos_filter(&dr_lp_48000))
-        exit(-10);
-    if (init_sos_filter(&ccir468_48000))
-        exit(-10);
-    if (init_sos_filter(&dr_48000))
-        exit(-10);
-
-    if (init_sos_filter(&on_fly_notch))
-        exit(-10);
-
-}
-void free_dr_filters( void )
-{
-    if (free_sos_filter(&dr_no_32000))
-        exit(-10);
-    if (free_sos_filter(&ccir468_32000))
-        exit(-10);
-    if (free_sos_filter(&dr_32000))
-        exit(-10);
-
-    if (free_sos_filter(&dr_no_44100))
-        exit(-10);
-    if (free_sos_filter(&dr_lp_44100))
-        exit(-10);
-    if (free_sos_filter(&ccir468_44100))
-        exit(-10);
-    if (free_sos_filter(&dr_44100))
-        exit(-10);
-
-    if (free_sos_filter(&dr_no_48000))
-        exit(-10);
-    if (free_sos_filter(&dr_lp_48000))
-        exit(-10);
-    if (free_sos_filter(&ccir468_48000))
-        exit(-10);
-    if (free_sos_filter(&dr_48000))
-        exit(-10);
-
-    if (free_sos_filter(&on_fly_notch))
-        exit(-10);
-
-}
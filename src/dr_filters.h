@@ -33,23 +33,26 @@
 #define __DR_FILTERS_H__
 #include "sos_filter.h"
 
-extern SOS_FILTER dr_no_32000;
-extern SOS_FILTER ccir468_32000;
-extern SOS_FILTER dr_32000;
+extern const SOS_FILTER dr_no_32000;
+extern const SOS_FILTER ccir468_32000;
+extern const SOS_FILTER dr_32000;
 
-extern SOS_FILTER dr_no_44100;
-extern SOS_FILTER dr_lp_44100;
-extern SOS_FILTER ccir468_44100;
-extern SOS_FILTER dr_44100;
+extern const SOS_FILTER dr_no_44100;
+extern const SOS_FILTER dr_lp_44100;
+extern const SOS_FILTER ccir468_44100;
+extern const SOS_FILTER dr_44100;
 
-extern SOS_FILTER dr_no_48000;
-extern SOS_FILTER dr_lp_48000;
-extern SOS_FILTER ccir468_48000;
-extern SOS_FILTER dr_48000;
+extern const SOS_FILTER dr_no_48000;
+extern const SOS_FILTER dr_lp_48000;
+extern const SOS_FILTER ccir468_48000;
+extern const SOS_FILTER dr_48000;
 
-extern SOS_FILTER on_fly_notch;
+extern const SOS_FILTER dr_lp_88200;
+extern const SOS_FILTER dr_lp_96000;
+extern const SOS_FILTER dr_lp_176400;
+extern const SOS_FILTER dr_lp_192000;
+
+extern const SOS_FILTER on_fly_notch;
  
-void init_dr_filters( void );
-void free_dr_filters( void );
 
 #endif /* __DR_FILTERS_H__ */
@@ -1,36 +1,37 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	fchange.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	fchange.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdarg.h>
 #include <math.h>
 #include <limits.h>
@@ -45,10 +46,27 @@
 #include "SATS_fft.h"
 
 
-/* FFT size */
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* FFT and search window sizes up to 48kHz; higher rates scale both, see fchange_rate_multiple() */
 #define FFTSIZE     ( 65536 )
+#define WINDOWSIZE  ( 16384 )
+
+/* Tone tracker, see fchange_track_tone() */
+#define TRACK_ZOOM      ( 4 )           /* zero padding factor of the search window */
+#define TRACK_SPAN      ( 2 )           /* unpadded bins either side of the coarse peak that are refined */
+#define TRACK_GROUP     ( 8 )           /* bins per Goertzel pass */
+#define TRACK_MAX_BINS  ( 2 * TRACK_GROUP )    /* 2 * TRACK_SPAN * (TRACK_ZOOM - 1) around the peak, 4 in the reference pulse */
+#define TRACK_MARGIN    ( 4.0 )         /* 6dB, over the 3.9dB worst case scalloping of a rectangular window */
 
 static void fchange_debug( char *fmt, ... );
+static int fchange_rate_multiple( unsigned long fs );
+static void fchange_goertzel( const double *x, int n, int fftsize, const int *bins, SATS_FFT_Complex *out );
+static int fchange_track_tone( double *x, int n, int fftsize, int ref_ind, SATS_FFT_Complex *coarse, SATS_FFT_Complex *out );
+static int fchange_map_header( FILE *fp, const char *input );
+static int fchange_map_add( fchange_map_t *map, int settle_point, double dwell_end, double dwell_start, double ref_freq );
 
 static void fchange_debug( char *fmt, ... )
 {
@@ -66,6 +84,221 @@ static void fchange_debug( char *fmt, ... )
     return;
 }
 
+/**
+ * @brief   Scale factor for the analysis sizes at a sample rate
+ *
+ * @details FFTSIZE and WINDOWSIZE suit 32 to 48kHz.  Higher rates multiply both by the
+ *          power of two nearest fs / 48kHz, which keeps the bin spacing and window
+ *          duration (and so the pulse shape) about the same while every FFT stays a
+ *          power of two.
+ *
+ * @param   fs          IN: Sampling rate in Hz
+ *
+ * @return  1 up to 48kHz, 2 at 88.2/96kHz, 4 at 176.4/192kHz.
+ */
+static int fchange_rate_multiple( unsigned long fs )
+{
+    double octaves = round(log((double) fs / 48000.0) / log(2));
+
+    return (octaves > 0) ? (1 << (int) octaves) : 1;
+}
+
+/**
+ * @brief   Evaluate single bins of the zero padded window spectrum
+ *
+ * @details Runs a Goertzel filter for each of the TRACK_GROUP bins listed and writes the
+ *          resulting fftsize-point DFT values (of x zero padded to fftsize) into out at the
+ *          listed indices.  The two halves of the window are filtered side by side so the
+ *          recursions have twice the independent work per step.
+ *
+ * @param   x           IN: Window samples
+ * @param   n           IN: Number of samples in the window, even
+ * @param   fftsize     IN: Padded FFT size
+ * @param   bins        IN: TRACK_GROUP bin indices
+ * @param   out         OUT: FFT output array
+ */
+static void fchange_goertzel( const double *x, int n, int fftsize, const int *bins, SATS_FFT_Complex *out )
+{
+    double coef[TRACK_GROUP];
+    double a1[TRACK_GROUP], a2[TRACK_GROUP];        /* first half of the window */
+    double b1[TRACK_GROUP], b2[TRACK_GROUP];        /* second half of the window */
+    const int h = n / 2;
+    int i, k;
+
+    for (k = 0; k < TRACK_GROUP; k++)
+    {
+        coef[k] = 2.0 * cos(2.0 * M_PI * (double) bins[k] / fftsize);
+        a1[k] = a2[k] = 0.0;
+        b1[k] = b2[k] = 0.0;
+    }
+
+    for (i = 0; i < h; i++)
+    {
+        const double xa = x[i];
+        const double xb = x[i + h];
+
+        for (k = 0; k < TRACK_GROUP; k++)
+        {
+            const double a0 = xa + coef[k] * a1[k] - a2[k];
+            const double b0 = xb + coef[k] * b1[k] - b2[k];
+
+            a2[k] = a1[k];
+            a1[k] = a0;
+            b2[k] = b1[k];
+            b1[k] = b0;
+        }
+    }
+
+    for (k = 0; k < TRACK_GROUP; k++)
+    {
+        /* Each half sums to exp(-jw(h-1)) * (s1 - exp(-jw) s2), and the second half starts h samples later */
+        const double w = 2.0 * M_PI * (double) bins[k] / fftsize;
+        const double p1 = 2.0 * M_PI * (double) (((long) bins[k] * (h - 1)) % fftsize) / fftsize;
+        const double p2 = 2.0 * M_PI * (double) (((long) bins[k] * h) % fftsize) / fftsize;
+        const double yar = a1[k] - cos(w) * a2[k], yai = sin(w) * a2[k];
+        const double ybr = b1[k] - cos(w) * b2[k], ybi = sin(w) * b2[k];
+        const double yr = yar + ybr * cos(p2) + ybi * sin(p2);
+        const double yi = yai + ybi * cos(p2) - ybr * sin(p2);
+
+        SATS_FFT_REAL(out[bins[k]]) = yr * cos(p1) + yi * sin(p1);
+        SATS_FFT_IMAG(out[bins[k]]) = yi * cos(p1) - yr * sin(p1);
+    }
+}
+
+/**
+ * @brief   Find the spectral peak of the search window without the full padded FFT
+ *
+ * @details The search window is zero padded by TRACK_ZOOM, so its unpadded FFT gives every
+ *          TRACK_ZOOM-th bin of the padded spectrum exactly and serves as a coarse tone
+ *          detector.  The padded bins within TRACK_SPAN coarse bins of the coarse peak, and
+ *          the pulse around ref_ind, are then filled in with Goertzel filters and written
+ *          into out at their own indices.  No other entry of out is touched.
+ *
+ *          The peak of the padded bins around the coarse peak is accepted if every other
+ *          coarse bin is more than TRACK_MARGIN below it, as padded bins between two coarse
+ *          bins cannot then reach it.  Otherwise (two tones of similar level, as happens
+ *          when the window straddles a frequency change) the caller falls back to the full
+ *          FFT.
+ *
+ * @param   x           IN: Window samples (not zero padded)
+ * @param   n           IN: Number of samples in the window
+ * @param   fftsize     IN: Padded FFT size, n * TRACK_ZOOM
+ * @param   ref_ind     IN: Reference bin index
+ * @param   coarse      OUT: Scratch for the unpadded FFT, n / 2 + 1 entries
+ * @param   out         OUT: FFT output array, updated around the peak and ref_ind
+ *
+ * @return  Index of the spectral peak, or -1 if the full FFT is needed.
+ */
+static int fchange_track_tone( double *x, int n, int fftsize, int ref_ind, SATS_FFT_Complex *coarse, SATS_FFT_Complex *out )
+{
+    int bins[TRACK_MAX_BINS];
+    int nbins = 0;
+    int lo, hi, k, m;
+    int peak_m = 0;
+    int ind = -1;
+    double re, im, mag;
+    double peak = 0.0;
+    double rival = 0.0;
+
+    if (n * TRACK_ZOOM != fftsize)
+    {
+        return -1;
+    }
+
+    (void) SATS_FFT_ComputeForward2(x, coarse, n);
+
+    /* Coarse peak */
+    for (m = 0; m < n / 2; m++)
+    {
+        re = SATS_FFT_REAL(coarse[m]);
+        im = SATS_FFT_IMAG(coarse[m]);
+        mag = (re * re) + (im * im);
+        if (peak < mag)
+        {
+            peak = mag;
+            peak_m = m;
+        }
+    }
+
+    lo = (peak_m - TRACK_SPAN) * TRACK_ZOOM;
+    hi = (peak_m + TRACK_SPAN) * TRACK_ZOOM;
+    if ((lo < 0) || (hi >= fftsize / 2) || (ref_ind < 2) || (ref_ind + 2 >= fftsize / 2))
+    {
+        return -1;
+    }
+
+    /* Padded bins between the coarse ones: around the coarse peak, then the rest of the reference pulse */
+    for (k = lo; k <= hi; k++)
+    {
+        if (k % TRACK_ZOOM != 0)
+        {
+            bins[nbins++] = k;
+        }
+    }
+    for (k = ref_ind - 2; k <= ref_ind + 2; k++)
+    {
+        if ((k % TRACK_ZOOM != 0) && ((k < lo) || (k > hi)))
+        {
+            bins[nbins++] = k;
+        }
+    }
+    while (nbins % TRACK_GROUP != 0)
+    {
+        bins[nbins] = bins[nbins - 1];
+        nbins++;
+    }
+    for (k = 0; k < nbins; k += TRACK_GROUP)
+    {
+        fchange_goertzel(x, n, fftsize, &bins[k], out);
+    }
+
+    /* Padded bins that coincide with coarse ones */
+    for (k = lo; k <= hi; k += TRACK_ZOOM)
+    {
+        out[k] = coarse[k / TRACK_ZOOM];
+    }
+    for (k = ref_ind - 2; k <= ref_ind + 2; k++)
+    {
+        if (k % TRACK_ZOOM == 0)
+        {
+            out[k] = coarse[k / TRACK_ZOOM];
+        }
+    }
+
+    /* Padded peak, in the same order as a full search so ties resolve the same way */
+    peak = 0.0;
+    for (k = lo; k <= hi; k++)
+    {
+        re = SATS_FFT_REAL(out[k]);
+        im = SATS_FFT_IMAG(out[k]);
+        mag = (re * re) + (im * im);
+        if (peak < mag)
+        {
+            peak = mag;
+            ind = k;
+        }
+    }
+
+    /* Coarse bins bounding the padded bins that were not evaluated */
+    for (m = 0; m <= n / 2; m++)
+    {
+        if (abs(m - peak_m) >= TRACK_SPAN)
+        {
+            re = SATS_FFT_REAL(coarse[m]);
+            im = SATS_FFT_IMAG(coarse[m]);
+            rival = max_d(rival, (re * re) + (im * im));
+        }
+    }
+
+    /* The pulse around the peak must also lie within the evaluated bins */
+    if ((TRACK_MARGIN * rival >= peak) || (ind < lo + 2) || (ind > hi - 2))
+    {
+        return -1;
+    }
+
+    return ind;
+}
+
 /**
  * @brief   Find the next frequency change
  *
@@ -86,6 +319,7 @@ static void fchange_debug( char *fmt, ... )
  * @endverbatim
  *
  * @param   pfs             IN: Pointer to file structure
+ * @param   ws              IN/OUT: Scratch for the search, see find_next_fchange_workspace()
  * @param   settle_point    OUT: Pointer to calculated settle point
  * @param   dwell_end       OUT: Pointer to calculated dwell end
  * @param   dwell_start     OUT: Pointer to calculated dwell end
@@ -93,7 +327,7 @@ static void fchange_debug( char *fmt, ... )
  *
  * @return  Returns 0 if a new frequency is found.  -1 otherwise.
  */
-int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, double *dwell_start, double *ref_freq )
+int find_next_fchange( pfstruct pfs, workspace_t *ws, int *settle_point, double *dwell_end, double *dwell_start, double *ref_freq )
 {
     int i = 0;
 
@@ -117,8 +351,10 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     int found_new_tone_count = 0;       /* found new tone count */
     double new_tone_ratio = 0.0;        /* new tone ratio */
 
-    double fft_data_in[FFTSIZE];        /* buffer for FFT data */
-    SATS_FFT_Complex fft_data_out[FFTSIZE];/* Complex output datatype from FFT. */
+    int fftsize;                        /* FFT size, FFTSIZE scaled for the sample rate */
+    double *fft_data_in;                /* buffer for FFT data, fftsize */
+    SATS_FFT_Complex *fft_data_out;     /* Complex output datatype from FFT, fftsize / 2 + 1 */
+    SATS_FFT_Complex *coarse_out;       /* unpadded FFT for the tone tracker */
     SATS_FFT_Status fft_status;         /* Status variable for all FFT function returns. */
     int number_fft_samples;             /* number of samples supplied to the FFT */
 
@@ -126,7 +362,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     double mag = 0.0;                   /* magnitude */
     int ref_ind = 0;                    /* reference index */
     int found_new_tone = 0;             /* flag to indicate if a new tone has been found */
-    int sliding_window_length = 16384;  /* length of the sliding window */
+    int sliding_window_length;          /* length of the sliding window, WINDOWSIZE scaled for the sample rate */
     double val = 0.0;
     int ind = 0;
     int found_freq_count;
@@ -134,8 +370,8 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     double new_val, pulse_start, pulse_end;
     double fftdata_start, fftdata_end;
     int diff_index_fftdata, diff_index_pulse;
-    long original_data_position;
-    long old_pos;
+    __int64 original_data_position;
+    __int64 old_pos;
     double start_idx, stop_idx;         /* indices used for debug printing */
 
     /* Input argument checking */
@@ -144,17 +380,20 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     assert(dwell_start != NULL);
     assert(dwell_end != NULL);
     assert(ref_freq != NULL);
+    assert(ws != NULL);
 
     /* Configure parameters based on input arguments */
     fs = pfs->fs;
     init_analysis = (unsigned long) round(( (double) (fs / 3) ));
     thres = fs / 20;
+    fftsize = FFTSIZE * fchange_rate_multiple(fs);
+    sliding_window_length = WINDOWSIZE * fchange_rate_multiple(fs);
     original_data_position = pfs->data_position;
 
     fchange_debug("START----\n");
 
     /* Checking for settling in frequency and amplitude.  Will update *settle_point pointer. */
-    if (check_settling( FREQ_AMP_NO_GRADIENT, FSTRUCT, pfs, NULL, 0, 0, c_freq, thres_db, alpha, numblocks, INT_MAX, settle_point ) != 0)
+    if (check_settling( FREQ_AMP_NO_GRADIENT, FSTRUCT, pfs, NULL, 0, 0, c_freq, thres_db, alpha, numblocks, INT_MAX, ws, settle_point ) != 0)
     {
         fchange_debug("Check settling failed.\n");
     }
@@ -177,10 +416,22 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     *settle_point += original_data_position;
     pfs->data_position = *settle_point;
 
+    fft_data_in = (double *) workspace_alloc(ws, fftsize * sizeof(double));
+    fft_data_out = (SATS_FFT_Complex *) workspace_alloc(ws, (fftsize / 2 + 1) * sizeof(SATS_FFT_Complex));
+    coarse_out = (SATS_FFT_Complex *) workspace_alloc(ws, (fftsize / TRACK_ZOOM / 2 + 1) * sizeof(SATS_FFT_Complex));
+    if ((fft_data_in == NULL) || (fft_data_out == NULL) || (coarse_out == NULL))
+    {
+        *dwell_end = 0.0;
+        *dwell_start = 0.0;
+        *ref_freq = 0.0;
+        error("Frequency change workspace too small\n");
+        return(-1);
+    }
+
     /* Zero the input and output buffers.  Output buffer is complex - hence factor of 2. */
-    for (i = 0; i < FFTSIZE; i++)
+    memset(fft_data_in, 0, fftsize * sizeof(double));
+    for (i = 0; i < fftsize / 2 + 1; i++)
     {
-        fft_data_in[i] = 0.0;
         SATS_FFT_REAL(fft_data_out[i]) = 0.0;
         SATS_FFT_IMAG(fft_data_out[i]) = 0.0;
     }
@@ -189,8 +440,8 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     //printf("%d\n", pfs->data_position);
     if ((pfs->data_size - pfs->data_position) > init_analysis)
     {
-        memcpy(fft_data_in, &pfs->data[pfs->data_position], init_analysis * sizeof(fft_data_in[0]));
-        memset(&fft_data_in[init_analysis], 0, (FFTSIZE - init_analysis) * sizeof(fft_data_in[0]));
+        memcpy(fft_data_in, fio_window_get(pfs, pfs->data_position, init_analysis), init_analysis * sizeof(fft_data_in[0]));
+        memset(&fft_data_in[init_analysis], 0, (fftsize - init_analysis) * sizeof(fft_data_in[0]));
         pfs->data_position += init_analysis;
 
         /* Log the analysis window boundaries */
@@ -211,14 +462,14 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     }
 
     /* Forward FFT for audio data in blk array */
-    fft_status = SATS_FFT_ComputeForward2(fft_data_in, fft_data_out, FFTSIZE);
+    fft_status = SATS_FFT_ComputeForward2(fft_data_in, fft_data_out, fftsize);
 
     /* Resetting the index and initial max value */
     val = 0.0;
     ind = 0;
 
     /* Find the maximum magnitude, and associated index */
-    for (i = 0; i < FFTSIZE / 2; i++)
+    for (i = 0; i < fftsize / 2; i++)
     {
         re = SATS_FFT_REAL(fft_data_out[i]);
         im = SATS_FFT_IMAG(fft_data_out[i]);
@@ -232,7 +483,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     }
 
     /* Calculating the corresponding frequency value from sample index */
-    *ref_freq = round((double) (ind * fs) / FFTSIZE);
+    *ref_freq = round((double) (ind * fs) / fftsize);
 
     fchange_debug("New reference frequency: %dHz\n", (int) *ref_freq);
 
@@ -264,8 +515,8 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     }
 
     /* Copy into fft_data_in and zero pad to the end */
-    memcpy(fft_data_in, &pfs->data[pfs->data_position], number_fft_samples * sizeof(fft_data_in[0]));
-    memset(&fft_data_in[number_fft_samples], 0, (FFTSIZE - number_fft_samples) * sizeof(fft_data_in[0]));
+    memcpy(fft_data_in, fio_window_get(pfs, pfs->data_position, number_fft_samples), number_fft_samples * sizeof(fft_data_in[0]));
+    memset(&fft_data_in[number_fft_samples], 0, (fftsize - number_fft_samples) * sizeof(fft_data_in[0]));
     pfs->data_position += number_fft_samples;
 
     /* Log the analysis window boundaries */
@@ -279,22 +530,34 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     /* Main search loop */
     while (number_fft_samples == sliding_window_length)
     {
-        fft_status = SATS_FFT_ComputeForward2(fft_data_in, fft_data_out, FFTSIZE);
-
-        /* Search for the max absolute value and index */
-        new_val = 0.0;
-        ind = 0;
-        for (i = 0; i < (FFTSIZE / 2); i++)
+        /* Once the reference bin is known the tracker finds the peak and fills in the bins
+         * the two pulses need; the full FFT is only taken when it cannot tell tones apart */
+        ind = (ref_val == -1) ? -1 : fchange_track_tone(fft_data_in, number_fft_samples, fftsize, ref_ind, coarse_out, fft_data_out);
+        if (ind >= 0)
         {
-            /* Calculating power of the new data for normalization */
-            re = SATS_FFT_REAL(fft_data_out[i]);
-            im = SATS_FFT_IMAG(fft_data_out[i]);
-            mag = ((re * re) + (im * im)) * 2;
+            re = SATS_FFT_REAL(fft_data_out[ind]);
+            im = SATS_FFT_IMAG(fft_data_out[ind]);
+            new_val = ((re * re) + (im * im)) * 2;
+        }
+        else
+        {
+            fft_status = SATS_FFT_ComputeForward2(fft_data_in, fft_data_out, fftsize);
 
-            if (new_val < fabs(mag))
+            /* Search for the max absolute value and index */
+            new_val = 0.0;
+            ind = 0;
+            for (i = 0; i < (fftsize / 2); i++)
             {
-                new_val = fabs(mag);
-                ind = i;
+                /* Calculating power of the new data for normalization */
+                re = SATS_FFT_REAL(fft_data_out[i]);
+                im = SATS_FFT_IMAG(fft_data_out[i]);
+                mag = ((re * re) + (im * im)) * 2;
+
+                if (new_val < fabs(mag))
+                {
+                    new_val = fabs(mag);
+                    ind = i;
+                }
             }
         }
 
@@ -303,7 +566,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
 
         /* Clamp pulse start and end values in case ind is bogus.  +1 for the conversion from MATLAB to C indexing. */
         pulse_start = max_d(1, ((ind + 1) - pulse_off));
-        pulse_end = min_d(((ind + 1) + pulse_off), (FFTSIZE / 2));
+        pulse_end = min_d(((ind + 1) + pulse_off), (fftsize / 2));
 
         /* +1 to match the Matlab array offset */
         fftdata_start = (int) ((1 + pulse_start - ((ind + 1) - pulse_off)));
@@ -328,7 +591,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
         }
 
         /* converts the sample index into frequency value */
-        freq = round((double) (ind * fs) / ((double) FFTSIZE));
+        freq = round((double) (ind * fs) / ((double) fftsize));
 
         /* prints out the new frequency value */
         fchange_debug("Detected frequency : %.0fHz\n", freq);
@@ -341,7 +604,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
         /* clamp pulse start and end values in case ind is bogus */
         /* the plus one is there in order to match the Matlab version */
         pulse_start = max_d(1, ((ref_ind + 1) - pulse_off));
-        pulse_end = min_d(((ref_ind + 1) + pulse_off), (FFTSIZE / 2));
+        pulse_end = min_d(((ref_ind + 1) + pulse_off), (fftsize / 2));
 
         /* minus one to match the Matlab array offset */
         fftdata_start = (int) ((1 + pulse_start - ((ref_ind + 1) - pulse_off)));
@@ -422,7 +685,7 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
             pfs->data_position = pfs->data_size - sliding_window_length;
 
             /* Set window step to match */
-            sliding_window_step = pfs->data_position - old_pos;
+            sliding_window_step = (int) (pfs->data_position - old_pos);
         }
 
         fchange_debug("Sliding window step: %d\n", sliding_window_step);
@@ -504,9 +767,8 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
         }
 
         /* Copy into fft_data_in and zero pad to the end */
-        debug("0x%x 0x%x %d %d\n", fft_data_in, &pfs->data[pfs->data_position], pfs->data_position, number_fft_samples);
-        memcpy(fft_data_in, &pfs->data[pfs->data_position], number_fft_samples * sizeof(double));
-        memset(&fft_data_in[number_fft_samples], 0, (FFTSIZE - number_fft_samples) * sizeof(double));
+        memcpy(fft_data_in, fio_window_get(pfs, pfs->data_position, number_fft_samples), number_fft_samples * sizeof(double));
+        memset(&fft_data_in[number_fft_samples], 0, (fftsize - number_fft_samples) * sizeof(double));
         pfs->data_position += number_fft_samples;
 
         /* Log the analysis window boundaries */
@@ -528,9 +790,321 @@ int find_next_fchange( pfstruct pfs, int *settle_point, double *dwell_end, doubl
     /* Reset data_position */
     pfs->data_position = original_data_position;
 
-    fchange_debug("FAIL.\n\n");
-
+    fchange_debug("FAIL.\n\n");
+
     fft_status = fft_status;
 
     return(-1);
 }
+
+/**
+ * @brief   Workspace needed by find_next_fchange()
+ *
+ * @param   fs      IN: Sampling rate in Hz of the files to be searched
+ *
+ * @return  Returns the number of bytes find_next_fchange() takes from its workspace,
+ *          including those of the check_settling() call it makes.
+ */
+size_t find_next_fchange_workspace( unsigned long fs )
+{
+    const int fftsize = FFTSIZE * fchange_rate_multiple(fs);
+
+    return WORKSPACE_SIZE(fftsize * sizeof(double))
+         + WORKSPACE_SIZE((fftsize / 2 + 1) * sizeof(SATS_FFT_Complex))
+         + WORKSPACE_SIZE((fftsize / TRACK_ZOOM / 2 + 1) * sizeof(SATS_FFT_Complex))
+         + check_settling_workspace(fs);
+}
+
+/* Dwell map (-dwells): the dwells find_next_fchange() finds in a channel depend only on
+ * its audio from the end of the lead silence, so thd_vs_freq and freq_resp, and re-runs
+ * with other options, can share one search.  fchange_map_load() looks the channel up in
+ * the map file; if it's there, fchange_map_next() hands its dwells out in place of
+ * find_next_fchange(), otherwise fchange_map_next() searches and records, and
+ * fchange_map_save() adds the channel to the file once the search has run to the end,
+ * in place of an earlier entry of the same channel and start.
+ * The file is text:
+ *
+ *   SATS dwell map 1
+ *   input <fio_input_id() of the WAV file>
+ *   channel <channel> start <pfs->position the search starts from> dwells <n>
+ *   <settle point> <dwell end> <dwell start> <frequency>       (n lines)
+ *   channel ...
+ *
+ * A file made for another input, or a different version of it, or that isn't a map at
+ * all, is neither used nor overwritten: the dwells are searched for, with a warning.
+ * An empty file is taken as a new map.
+ */
+#define FCHANGE_MAP_MAGIC   "SATS dwell map 1"
+#define FCHANGE_MAP_LINE    ( 1200 )
+
+/* Check the first two lines of a map file are for this input: 0 if they are, 1 if the
+ * file is empty, -1 otherwise */
+static int fchange_map_header( FILE *fp, const char *input )
+{
+    char line[FCHANGE_MAP_LINE];
+    char expect[FCHANGE_MAP_LINE];
+
+    if (fgets(line, sizeof(line), fp) == NULL)
+    {
+        return (feof(fp) && !ferror(fp)) ? 1 : -1;
+    }
+    if (strcmp(line, FCHANGE_MAP_MAGIC "\n") != 0)
+    {
+        return (-1);
+    }
+    snprintf(expect, sizeof(expect), "input %s\n", input);
+    if (fgets(line, sizeof(line), fp) == NULL || strcmp(line, expect) != 0)
+    {
+        return (-1);
+    }
+    return (0);
+}
+
+static int fchange_map_add( fchange_map_t *map, int settle_point, double dwell_end, double dwell_start, double ref_freq )
+{
+    fchange_dwell_t *d;
+    void *p;
+
+    if (map->count == map->alloc)
+    {
+        map->alloc = (map->alloc > 0) ? 2 * map->alloc : 64;
+        if ((p = realloc(map->dwell, map->alloc * sizeof(fchange_dwell_t))) == NULL)
+        {
+            return (-1);
+        }
+        map->dwell = (fchange_dwell_t *) p;
+    }
+    d = &map->dwell[map->count++];
+    d->settle_point = settle_point;
+    d->dwell_end = dwell_end;
+    d->dwell_start = dwell_start;
+    d->ref_freq = ref_freq;
+    return (0);
+}
+
+/**
+ * @brief   Set up the dwell map of the current channel
+ *
+ * @details Call after strip_lead_silence().  Without -dwells, or if the input is a stream,
+ *          the map is off and fchange_map_next() just calls find_next_fchange().
+ *
+ * @param   pfs             IN: Pointer to file structure
+ * @param   map             OUT: Dwell map, see fchange_map_free()
+ *
+ * @return  Returns 1 if the dwells were read from the map file, 0 otherwise.
+ */
+int fchange_map_load( pfstruct pfs, fchange_map_t *map )
+{
+    char line[FCHANGE_MAP_LINE];
+    FILE *fp;
+    int settle_point;
+    double dwell_end, dwell_start, ref_freq;
+    long long start;
+    int ch, n, i;
+    int header;
+
+    memset(map, 0, sizeof(*map));
+    map->state = FCHANGE_MAP_OFF;
+    if (pfs->dwellMap[0] == '\0')
+    {
+        return (0);
+    }
+    if (fio_input_id(pfs, map->input, sizeof(map->input)) != 0)
+    {
+        warning("-dwells needs the input to be a file, the dwells are searched for\n");
+        return (0);
+    }
+    map->state = FCHANGE_MAP_RECORD;
+
+    if ((fp = fopen(pfs->dwellMap, "r")) == NULL)
+    {
+        return (0);
+    }
+    header = fchange_map_header(fp, map->input);
+    if (header < 0)
+    {
+        warning("%s is not a dwell map of this input, it is left as is and the dwells are searched for\n", pfs->dwellMap);
+        map->state = FCHANGE_MAP_OFF;
+    }
+    else if (header == 0)
+    {
+        while (fgets(line, sizeof(line), fp) != NULL)
+        {
+            if (sscanf(line, "channel %d start %lld dwells %d", &ch, &start, &n) != 3 || n < 0)
+            {
+                break;
+            }
+            for (i = 0; i < n && fgets(line, sizeof(line), fp) != NULL; i++)
+            {
+                if (ch == pfs->channel && start == (long long) pfs->position)
+                {
+                    if (sscanf(line, "%d %lf %lf %lf", &settle_point, &dwell_end, &dwell_start, &ref_freq) != 4 ||
+                        fchange_map_add(map, settle_point, dwell_end, dwell_start, ref_freq) != 0)
+                    {
+                        break;
+                    }
+                }
+            }
+            if (ch == pfs->channel && start == (long long) pfs->position)
+            {
+                if (i == n)
+                {
+                    fchange_debug("%d dwells from %s\n", n, pfs->dwellMap);
+                    map->state = FCHANGE_MAP_REPLAY;
+                }
+                else
+                {
+                    map->count = 0;
+                }
+                break;
+            }
+        }
+    }
+    fclose(fp);
+
+    return (map->state == FCHANGE_MAP_REPLAY);
+}
+
+/**
+ * @brief   find_next_fchange() through the dwell map
+ *
+ * @details Same parameters and results as find_next_fchange(), see there.  A loaded map
+ *          gives the dwells saved in it, in order, without searching.
+ *
+ * @return  Returns 0 if a new frequency is found.  -1 otherwise.
+ */
+int fchange_map_next( pfstruct pfs, fchange_map_t *map, workspace_t *ws, int *settle_point, double *dwell_end, double *dwell_start, double *ref_freq )
+{
+    const fchange_dwell_t *d;
+    int res;
+
+    if (map->state == FCHANGE_MAP_REPLAY)
+    {
+        if (map->next < map->count)
+        {
+            d = &map->dwell[map->next++];
+            *settle_point = d->settle_point;
+            *dwell_end = d->dwell_end;
+            *dwell_start = d->dwell_start;
+            *ref_freq = d->ref_freq;
+            return (0);
+        }
+        /* as find_next_fchange() at the end of the search */
+        *ref_freq = 0;
+        *dwell_end = *settle_point;
+        *dwell_start = (double) pfs->data_size;
+        return (-1);
+    }
+
+    res = find_next_fchange(pfs, ws, settle_point, dwell_end, dwell_start, ref_freq);
+    if (map->state == FCHANGE_MAP_RECORD && !map->complete)
+    {
+        if (*ref_freq <= 0)
+        {
+            map->complete = 1;
+        }
+        else if (fchange_map_add(map, *settle_point, *dwell_end, *dwell_start, *ref_freq) != 0)
+        {
+            warning("Out of memory for the dwell map, it is not saved\n");
+            map->state = FCHANGE_MAP_OFF;
+        }
+    }
+    return (res);
+}
+
+/**
+ * @brief   Add the dwells recorded by fchange_map_next() to the map file
+ *
+ * @details Does nothing unless the search was recorded to the end.  The other entries
+ *          already in the file are kept; one of the same channel and start is replaced.
+ *          A file that has become something other than a map of this input since
+ *          fchange_map_load() is left as is.
+ *
+ * @param   pfs             IN: Pointer to file structure
+ * @param   map             IN: Dwell map
+ *
+ * @return  Returns 0 if successful.  -1 otherwise.
+ */
+int fchange_map_save( pfstruct pfs, const fchange_map_t *map )
+{
+    char tmp[sizeof(pfs->dwellMap) + 8];
+    char line[FCHANGE_MAP_LINE];
+    FILE *in, *out;
+    long long start;
+    int ch, n, i;
+    int keep;
+    int ok;
+
+    if (map->state != FCHANGE_MAP_RECORD || !map->complete)
+    {
+        return (0);
+    }
+
+    if ((in = fopen(pfs->dwellMap, "r")) != NULL && fchange_map_header(in, map->input) < 0)
+    {
+        warning("%s is not a dwell map of this input, the dwells are not saved\n", pfs->dwellMap);
+        fclose(in);
+        return (-1);
+    }
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", pfs->dwellMap);
+    if ((out = fopen(tmp, "w")) == NULL)
+    {
+        warning("cannot write the dwell map %s\n", tmp);
+        if (in != NULL)
+        {
+            fclose(in);
+        }
+        return (-1);
+    }
+    fprintf(out, "%s\ninput %s\n", FCHANGE_MAP_MAGIC, map->input);
+
+    if (in != NULL)
+    {
+        while (fgets(line, sizeof(line), in) != NULL)
+        {
+            if (sscanf(line, "channel %d start %lld dwells %d", &ch, &start, &n) != 3 || n < 0)
+            {
+                break;
+            }
+            keep = (ch != pfs->channel || start != (long long) pfs->position);
+            if (keep)
+            {
+                fputs(line, out);
+            }
+            for (i = 0; i < n && fgets(line, sizeof(line), in) != NULL; i++)
+            {
+                if (keep)
+                {
+                    fputs(line, out);
+                }
+            }
+        }
+        fclose(in);
+    }
+
+    fprintf(out, "channel %d start %lld dwells %d\n", pfs->channel, (long long) pfs->position, map->count);
+    for (i = 0; i < map->count; i++)
+    {
+        fprintf(out, "%d %.17g %.17g %.17g\n", map->dwell[i].settle_point, map->dwell[i].dwell_end,
+                map->dwell[i].dwell_start, map->dwell[i].ref_freq);
+    }
+
+    ok = !ferror(out);
+    ok = (fclose(out) == 0) && ok;
+    if (!ok || rename(tmp, pfs->dwellMap) != 0)
+    {
+        warning("cannot write the dwell map %s\n", pfs->dwellMap);
+        remove(tmp);
+        return (-1);
+    }
+    return (0);
+}
+
+void fchange_map_free( fchange_map_t *map )
+{
+    free(map->dwell);
+    map->dwell = NULL;
+    map->count = 0;
+    map->alloc = 0;
+}
@@ -33,8 +33,42 @@
 #define __FCHANGE_H__
 
 #include "fio.h"
+#include "Utilities.h"
 
-int find_next_fchange( pfstruct pfs , int *settle_point , double *dwell_end , double *dwell_start , double *ref_freq );
+int find_next_fchange( pfstruct pfs , workspace_t *ws , int *settle_point , double *dwell_end , double *dwell_start , double *ref_freq );
+size_t find_next_fchange_workspace( unsigned long fs );
+
+/* Dwell map (-dwells), the results of find_next_fchange() for a channel kept in a file */
+typedef enum
+{
+    FCHANGE_MAP_OFF = 0,        /* no map, fchange_map_next() searches */
+    FCHANGE_MAP_RECORD = 1,     /* the channel isn't in the file, fchange_map_next() searches and records */
+    FCHANGE_MAP_REPLAY = 2      /* the dwells came from the file */
+} fchange_map_state;
+
+typedef struct
+{
+    int settle_point;
+    double dwell_end;
+    double dwell_start;
+    double ref_freq;
+} fchange_dwell_t;
+
+typedef struct
+{
+    fchange_map_state state;
+    char input[256];            /* fio_input_id() of the input */
+    int complete;               /* recorded up to the end of the search */
+    int next;                   /* dwell fchange_map_next() replays next */
+    int count;
+    int alloc;
+    fchange_dwell_t *dwell;
+} fchange_map_t;
+
+int fchange_map_load( pfstruct pfs, fchange_map_t *map );
+int fchange_map_next( pfstruct pfs, fchange_map_t *map, workspace_t *ws, int *settle_point, double *dwell_end, double *dwell_start, double *ref_freq );
+int fchange_map_save( pfstruct pfs, const fchange_map_t *map );
+void fchange_map_free( fchange_map_t *map );
 
 #endif /*__FCHANGE_H__*/
 
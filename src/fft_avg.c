@@ -61,6 +61,7 @@ int fft_avg( pfstruct pfs, double *po, int n )
     SATS_FFT_HANDLE fft_handle;  // FFT handle for configuring the FFT.
     SATS_FFT_Status fft_status;  //Status variable for all FFT function returns.
     int i, nc;
+    int b, nbatch, queued;       // frames per FFT batch, frames waiting in pd
     double mag = 0.0;
     double *pi, *pw, *pd;
     double wf;
@@ -94,18 +95,19 @@ int fft_avg( pfstruct pfs, double *po, int n )
     //    compute window compensation
     wf = compute_window_comp( pw, block_size );
 
-    // storage for windowed samples
-    pd = (double *)SATS_FFT_malloc( block_size * sizeof( double ), BUFFER_ALLIGN );
+    // storage for a batch of windowed frames, transformed together
+    nbatch = SATS_FFT_BatchSize( block_size );
+    pd = (double *)SATS_FFT_malloc( nbatch * block_size * sizeof( double ), BUFFER_ALLIGN );
     if ( pd == NULL ) exit( -24 );
 
-    for (i=0;i<block_size;i++) pd[i]=0.0;
+    for (i=0;i<nbatch*block_size;i++) pd[i]=0.0;
         
     //    storage for fft output
-    fft_out = SATS_FFT_malloc ( sizeof ( SATS_FFT_Complex ) * nc, BUFFER_ALLIGN );
+    fft_out = SATS_FFT_malloc ( sizeof ( SATS_FFT_Complex ) * nc * nbatch, BUFFER_ALLIGN );
     
     if ( fft_out == NULL ) exit( -25 );
     
-    for (i=0;i<nc;i++)
+    for (i=0;i<nc*nbatch;i++)
     {
         SATS_FFT_REAL(fft_out[i])=0.0;
         SATS_FFT_IMAG(fft_out[i])=0.0;
@@ -126,21 +128,31 @@ int fft_avg( pfstruct pfs, double *po, int n )
     fio_read( pfs, block_size / 2 );
     copy_doubles( pfs->data, &pi[block_size/2], pfs->data_size );
     
+    queued = 0;
     while( pfs->data_size == block_size / 2 )
         {
-        window_array( pi, pw, pd, block_size );
-        fft_status = SATS_FFT_ComputeForward(fft_handle, pd, fft_out);
-        for ( i = 0; i < nc; i++ )
-            {
-            re = SATS_FFT_REAL(fft_out[i]);
-            im = SATS_FFT_IMAG(fft_out[i]);
-            mag = ( re * re ) + ( im * im );    // calculate power
-            mag = mag * 2.0;                    // compensate for one sided fft
-            mag = mag / ( pfs->fs * wf * block_size );    //    normalize for block size and window
-            po[i] = po[i] + mag;
-            }
+        window_array( pi, pw, &pd[queued * block_size], block_size );
+        queued++;
         block++;
         fio_read( pfs, block_size / 2 );
+        if ( queued == nbatch || pfs->data_size != block_size / 2 )
+            {
+            // transform the queued frames, then accumulate them in order
+            fft_status = SATS_FFT_ComputeForwardBatch(fft_handle, pd, block_size, fft_out, nc, queued);
+            for ( b = 0; b < queued; b++ )
+                {
+                for ( i = 0; i < nc; i++ )
+                    {
+                    re = SATS_FFT_REAL(fft_out[b * nc + i]);
+                    im = SATS_FFT_IMAG(fft_out[b * nc + i]);
+                    mag = ( re * re ) + ( im * im );    // calculate power
+                    mag = mag * 2.0;                    // compensate for one sided fft
+                    mag = mag / ( pfs->fs * wf * block_size );    //    normalize for block size and window
+                    po[i] = po[i] + mag;
+                    }
+                }
+            queued = 0;
+            }
         if ( pfs->data_size != block_size / 2 )
             break;
         copy_doubles( &pi[block_size/2], pi, block_size/2 );
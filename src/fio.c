@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	fio.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	fio.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <stdio.h>
@@ -34,15 +34,35 @@
 #include <stdarg.h>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 #include "fio.h"
 #include "wavelib.h"
 #include "power.h"
 #include "Utilities.h"
 #include "version.h"
 #include "debug.h"
+#include "stdio64.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FIO_MMAP 1
+#include <sys/mman.h>
+#define FIO_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#endif
+
 
+/* Upper limit on the memory used to hold every channel of a file in decoded form */
+#ifndef FIO_PLANAR_MAX_BYTES
+#define FIO_PLANAR_MAX_BYTES 2147483648.0
+#endif
+#define FIO_PLANAR_BLOCK 65536      /* frames decoded per pass of fio_decode_planes() */
 
-enum endianess endian_type = LITTLE;
 
 static void fio_debug( char *fmt, ... );
 
@@ -62,6 +82,50 @@ static void fio_debug( char *fmt, ... )
     return;
 }
 
+/* Map the input file into memory so that fio_read() can decode straight from the
+ * data chunk.  Leaves pfs->map NULL (and fio_read() on the fread() path) if mapping
+ * isn't available, or if the file is shorter than its header claims.
+ */
+static
+void fio_map_init( pfstruct pfs )
+{
+#ifdef FIO_MMAP
+    struct stat st;
+    double map_size;
+    void *p;
+
+    pfs->map = NULL;
+    pfs->map_size = 0;
+
+    if (pfs->stream || pfs->fp == NULL || fstat(fileno(pfs->fp), &st) != 0)
+    {
+        return;
+    }
+
+    map_size = (double) pfs->header_size + (double) pfs->size * pfs->channels * pfs->bytespersamp;
+    if (pfs->size <= 0 || map_size > (double) st.st_size || map_size > (double) ((size_t) -1))
+    {
+        return;
+    }
+
+    p = mmap(NULL, (size_t) map_size, PROT_READ, MAP_PRIVATE, fileno(pfs->fp), 0);
+    if (p == MAP_FAILED)
+    {
+        fio_debug("mmap failed, falling back to fread()\n");
+        return;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(p, (size_t) map_size, MADV_SEQUENTIAL);
+#endif
+
+    pfs->map = (unsigned char *) p;
+    pfs->map_size = (unsigned long) map_size;
+#else
+    pfs->map = NULL;
+    pfs->map_size = 0;
+#endif
+}
+
 static
 const char *OS_string(void)
 {
@@ -98,9 +162,9 @@ int fio_init( pfstruct pfs,
               const char *axis1,
               const char *axis2,
               const char *axis3) /* 3rd axis added here to meet spectrogram demands*/
-{
+{
 	int i;
-	const char *axes[3];
+	const char *axes[3];
 	const char *format_tag;
 	axes[0] = axis1;
 	axes[1] = axis2;
@@ -109,6 +173,13 @@ int fio_init( pfstruct pfs,
 
     assert( tool != NULL );
 
+    fio_map_init(pfs);
+    if (pfs->stream)
+    {
+        pfs->sbuf.keep = pfs->fs;
+    }
+    pfs->convert = pcm_convert_select(pfs->bytespersamp, pfs->audio_type, pfs->format_tag);
+
     if (strcmp(tool, "bandwidth") == 0)
     {
         /* It is unclear what this tool does and why it exists */
@@ -308,354 +379,1414 @@ int fio_eof_audio_data( paudio_struct adst )
 }
 */
 
-unsigned char *wavbuf = NULL;
-int wavbuf_size = 0;
-
+/* Convert "num" samples, "stride" bytes apart, from WAV data to floating point */
 static
-int convert_2_bytes( unsigned char *icp )
+int fio_decode( pfstruct pfs, const unsigned char *cp, unsigned long stride, double *pd, long num )
 {
-    int i = 0;
-    unsigned char *ocp = (unsigned char *) &i;
-
-    switch (endian_type)
+    if (pfs->convert == NULL)
     {
-        case DONT_KNOW:
-            return (0);
-            break;
-        case LITTLE:
-            *ocp++ = 0;
-            *ocp++ = 0;
-            *ocp++ = *(icp + 0);
-            *ocp++ = *(icp + 1);
-            return (i);
-            break;
-        case BIG:
-            *ocp++ = *(icp + 1);
-            *ocp++ = *(icp + 0);
-            return (i);
-            break;
-        case CANT_TELL:
-        default:
-            return (0); // that ought to break things
-            break;
+        if (pfs->bytespersamp == 4)
+        {
+            error("Invalid 32 bit wave file format.");
+        }
+        else
+        {
+            error("Invalid wave file format. please use only 16,24,32 bit files.");
+        }
+        return(-44);
     }
+
+    pfs->convert(cp, stride, pd, num);
+
+    return (0);
 }
 
+/* Free pfs->data, unless it points into the planar buffers */
 static
-int convert_3_bytes( unsigned char *icp )
+void fio_release_data( pfstruct pfs )
 {
-    int i = 0;
-    unsigned char *ocp = (unsigned char *) &i;
-
-    switch (endian_type)
+    if (pfs->malloc_size != 0)
     {
-        case DONT_KNOW:
-            return (0);
-            break;
-        case LITTLE:
-            *ocp++ = 0;
-            *ocp++ = *(icp + 0);
-            *ocp++ = *(icp + 1);
-            *ocp++ = *(icp + 2);
-            return (i);
-            break;
-        case BIG:
-            *ocp++ = *(icp + 2);
-            *ocp++ = *(icp + 1);
-            *ocp++ = *(icp + 0);
-            return (i);
-            break;
-        case CANT_TELL:
-        default:
-            return (0); // that ought to break things
-            break;
+        free(pfs->data);
     }
+    pfs->data = NULL;
+    pfs->malloc_size = 0;
 }
 
+/* Read forward from a streamed input until pfs->sbuf holds every frame before "end",
+ * first dropping the frames more than sbuf.keep behind "from" (unless sbuf.hold).
+ * A stream that ends early shortens pfs->size to what it actually delivered.
+ */
 static
-int convert_4_bytes( unsigned char *icp )
+int fio_stream_fill( pfstruct pfs, __int64 from, __int64 end )
 {
-    int i = 0;
-    unsigned char *ocp = (unsigned char *) &i;
-
-    switch (endian_type)
+    fio_stream_t *ps = &pfs->sbuf;
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+    unsigned char *p;
+    __int64 dead;
+    long need;
+    long got;
+    long n;
+
+    if (end > pfs->size)
     {
-        case DONT_KNOW:
-            return (0);
-            break;
-        case LITTLE:
-            *ocp++ = *(icp + 0);
-            *ocp++ = *(icp + 1);
-            *ocp++ = *(icp + 2);
-            *ocp++ = *(icp + 3);
-            return (i);
-            break;
-        case BIG:
-        	*ocp++ = *(icp + 3);
-            *ocp++ = *(icp + 2);
-            *ocp++ = *(icp + 1);
-            *ocp++ = *(icp + 0);
-            return (i);
-            break;
-        case CANT_TELL:
-        default:
-            return (0); // that ought to break things
-            break;
+        end = pfs->size;
+    }
+    if (end <= ps->start + ps->frames)
+    {
+        return (0);
     }
-}
-
-/* Read audio data from a file into memory */
-int fio_read( pfstruct pfs, unsigned long num_samples_to_read )
-{
-    unsigned long bytes_to_read;
-    int i;
-    unsigned char *cp;
-    double d, *pd;
 
-    /* Limit number of samples to read, if necessary */
-    if ( ((long) num_samples_to_read) + pfs->position >= pfs->size)
+    dead = ps->hold ? 0 : from - ps->keep - ps->start;
+    if (dead > ps->frames)
     {
-        /* Check the position is sensible */
-        if (pfs->position >= pfs->size)
+        /* Skipping ahead: drop the whole window and read past the gap */
+        ps->start += ps->frames;
+        ps->frames = 0;
+        dead = from - ps->keep - ps->start;
+        if (ps->alloc == 0 && dead > 0)
         {
-            if (pfs->data != NULL)
+            ps->alloc = FIO_PLANAR_BLOCK;
+            if ((ps->buf = (unsigned char *) malloc(ps->alloc * frame_bytes)) == NULL)
             {
-                free(pfs->data);
-                pfs->malloc_size = 0;
+                error("stream buffer malloc failed\n");
+                return (-1);
+            }
+        }
+        while (dead > 0)
+        {
+            n = (dead < ps->alloc) ? (long) dead : ps->alloc;
+            got = (long) fread(ps->buf, frame_bytes, n, pfs->fp);
+            ps->start += got;
+            dead -= got;
+            if (got < n)
+            {
+                break;
             }
-
-            pfs->data = NULL;
-            pfs->data_size = 0;
-            pfs->data_position = 0;
-            return (1);
         }
-        num_samples_to_read = pfs->size - pfs->position;
     }
-
-    /* Convert from samples to bytes */
-    bytes_to_read = (num_samples_to_read * pfs->channels * pfs->bytespersamp);
-
-    /* Allocate memory to read into */
-    if ((int) bytes_to_read != wavbuf_size)
+    else if (dead > 0)
     {
-        /* Free if previously allocated */
-        if (wavbuf)
-            free(wavbuf);
-
-        wavbuf = (unsigned char *) calloc(bytes_to_read, 1);
+        memmove(ps->buf, ps->buf + dead * frame_bytes, (ps->frames - dead) * frame_bytes);
+        ps->start += dead;
+        ps->frames -= (long) dead;
+    }
 
-        if (wavbuf)
-            wavbuf_size = (int) bytes_to_read;
-        else
+    need = (long) (end - (ps->start + ps->frames));
+    if (need > 0 && ps->frames + need > ps->alloc)
+    {
+        n = (2 * ps->alloc > ps->frames + need) ? 2 * ps->alloc : ps->frames + need;
+        if ((p = (unsigned char *) realloc(ps->buf, n * frame_bytes)) == NULL)
         {
-            error("wavbuf malloc failed\n");
-            return(-1);
+            error("stream buffer malloc failed\n");
+            return (-1);
         }
+        ps->buf = p;
+        ps->alloc = n;
     }
 
-    /* Do the read */
-    if (fread(wavbuf, 1, bytes_to_read, pfs->fp) != bytes_to_read)
+    got = (need > 0) ? (long) fread(ps->buf + ps->frames * frame_bytes, frame_bytes, need, pfs->fp) : 0;
+    ps->frames += got;
+    if (got < need || ps->start + ps->frames < end)
     {
-       if (feof(pfs->fp))
-	   {
-			   return 0;
-	   }
-	   else
-	   {
-		error("Read failed\n");
-		return (-1);
-	   }
+        if (ferror(pfs->fp))
+        {
+            error("Read failed\n");
+            return (-1);
+        }
+        warning("Input stream ended after %lld samples, its header promised %lld\n",
+                (long long) (ps->start + ps->frames), (long long) pfs->size);
+        pfs->size = ps->start + ps->frames;
     }
-	
 
-    /* Set data_position and data_size */
-    pfs->data_position = 0;
-    pfs->data_size = num_samples_to_read;
+    return (0);
+}
 
-    /* Update "position" */
-    pfs->position = pfs->position + num_samples_to_read;
+/* Frames of a streamed input, starting at sample "pos" */
+static
+const unsigned char *fio_stream_frames( pfstruct pfs, __int64 pos )
+{
+    if (pos < pfs->sbuf.start)
+    {
+        error("%s needs sample %lld of the input again, but it was read from a stream "
+              "and is gone; write the stream to a file and use that instead\n",
+              pfs->tool ? pfs->tool : "this tool", (long long) pos);
+        exit(1);
+    }
+    return (pfs->sbuf.buf + (pos - pfs->sbuf.start) * pfs->channels * pfs->bytespersamp);
+}
 
-    /* Convert to floating point and scale */
-    if (pfs->malloc_size != num_samples_to_read * sizeof(double))
+/* Decode every channel of the data chunk in a single pass into pfs->planes,
+ * so that "-c a" runs don't re-read and re-decode the whole file once per
+ * channel.  Gives up,
+ * leaving pfs->planes NULL, if the file doesn't fit FIO_PLANAR_MAX_BYTES.
+ */
+static
+void fio_decode_planes( pfstruct pfs )
+{
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+    unsigned char *buf = NULL;
+    const unsigned char *cp;
+    double bytes;
+    __int64 done;
+    long n;
+    int ch;
+
+    pfs->planar_off = 1;
+
+    bytes = (double) pfs->size * pfs->channels * sizeof(double);
+    if (pfs->stream && pfs->sbuf.start != 0)
     {
+        return;
+    }
+    if (pfs->size <= 0 || bytes > FIO_PLANAR_MAX_BYTES || bytes > (double) ((size_t) -1) / 2)
+    {
+        return;
+    }
 
-        if (pfs->data)
+    pfs->planes = (double **) calloc(pfs->channels, sizeof(double *));
+    if (pfs->planes == NULL)
+    {
+        return;
+    }
+    pfs->planes[0] = (double *) malloc((size_t) bytes);
+    if (pfs->planes[0] == NULL)
+    {
+        free(pfs->planes);
+        pfs->planes = NULL;
+        return;
+    }
+    for (ch = 1; ch < pfs->channels; ch++)
+    {
+        pfs->planes[ch] = pfs->planes[0] + ch * pfs->size;
+    }
+
+    if (pfs->map == NULL && !pfs->stream)
+    {
+        buf = (unsigned char *) malloc(FIO_PLANAR_BLOCK * frame_bytes);
+        if (buf == NULL || fseeko(pfs->fp, (__int64) pfs->header_size, SEEK_SET) != 0)
         {
-            free(pfs->data);
-            pfs->malloc_size = 0;
-            pfs->data = NULL;
+            goto fail;
         }
+    }
 
-        if ((pfs->data = (double *) calloc(num_samples_to_read, sizeof(double))) == NULL)
+    /* Block by block, so the interleaved bytes are still in cache for every channel */
+    for (done = 0; done < pfs->size; done += n)
+    {
+        n = FIO_PLANAR_BLOCK;
+        if (n > pfs->size - done)
         {
-            error("malloc failed\n");
+            n = (long) (pfs->size - done);
         }
 
-        if (pfs->data)
-            pfs->malloc_size = num_samples_to_read * sizeof(double);
+        if (pfs->map != NULL)
+        {
+            cp = pfs->map + pfs->header_size + done * frame_bytes;
+        }
+        else if (pfs->stream)
+        {
+            if (fio_stream_fill(pfs, done, done + n) != 0)
+            {
+                goto fail;
+            }
+            if (n > pfs->size - done)
+            {
+                n = (long) (pfs->size - done);
+            }
+            cp = fio_stream_frames(pfs, done);
+        }
         else
-            error("data malloc failed\n");
+        {
+            if (fread(buf, frame_bytes, n, pfs->fp) != (size_t) n)
+            {
+                goto fail;
+            }
+            cp = buf;
+        }
+
+        for (ch = 0; ch < pfs->channels; ch++)
+        {
+            if (fio_decode(pfs, cp + ch * pfs->bytespersamp, frame_bytes, pfs->planes[ch] + done, n) != 0)
+            {
+                goto fail;
+            }
+        }
     }
 
-    //	convert to floating point and scale
-    cp = (unsigned char *) wavbuf;
-    cp += (pfs->channel * pfs->bytespersamp);
-    pd = pfs->data;
-    for (i = 0; i < ((long) num_samples_to_read); i++)
-    {
-    	switch(pfs->bytespersamp)
-    	{
-    	    case 2:
-    	        d = (double) convert_2_bytes(cp);
-    	        d = d / (double) 0x80000000;
-    	        break;
+    free(buf);
+    if (pfs->stream)
+    {
+        /* Everything is in the planes now */
+        free(pfs->sbuf.buf);
+        pfs->sbuf.buf = NULL;
+        pfs->sbuf.start = pfs->size;
+        pfs->sbuf.frames = 0;
+        pfs->sbuf.alloc = 0;
+    }
+    fio_debug("decoded %d channels, %lld samples each\n", pfs->channels, (long long) pfs->size);
+    return;
 
-    	    case 3:
-    	        d = (double) convert_3_bytes(cp);
-    	        d = d / (double) 0x80000000;
-    	        break;
+fail:
+    /* e.g. a truncated file; stay on the per-channel path, which copes with that */
+    free(buf);
+    free(pfs->planes[0]);
+    free(pfs->planes);
+    pfs->planes = NULL;
+    if (!pfs->stream)
+    {
+        fseeko(pfs->fp, (__int64) pfs->header_size + pfs->position * frame_bytes, SEEK_SET);
+    }
+}
 
-    	    case 4:
-    	        // if(pfs->format_tag == 1) /* if data type is PCM */
-                if(pfs->audio_type == 1) /* if data type is PCM of usual 32 bit wav*/
-    	        {
-    	            /*convert to double*/
-    	            d = (double) convert_4_bytes(cp);
-    	            d = d / (double) 0x80000000;
-    	        }
-				else if(pfs->audio_type == -2 && pfs->format_tag == 0) /* if data type is PCM of 32 bit extensible wav */
-				{
-					/*convert to double*/
-    	            d = (double) convert_4_bytes(cp);
-    	            d = d / (double) 0x80000000;
-				}
-				else if(pfs->audio_type == -2 && pfs->format_tag == 1) /* if data type is float of 32 bit extensible wav */
-				{
-					d = (double) (*((float *) (cp)));
-				}
-				else if(pfs->audio_type == 3) /*if data type is IEEE float of usual 32 bit wav*/
-    	        {
-    	            d = (double) (*((float *) (cp)));
-    	        }
-				else
-				{
-                    error("Invalid 32 bit wave file format.");
-    	            return(-44);
-				}
+/* Decoded sample cache (-cache): the planes fio_decode_planes() produced are kept in
+ * "<input>.satscache", so the next tool run on the same file maps them instead of
+ * decoding again.  The file is a fio_cache_header_t followed by the planes, one after
+ * the other, as native doubles.  It is only used if the WAV file still has the size,
+ * modification time and content hash recorded in the header.  The hash covers the
+ * whole WAV file up to the end of the data chunk, so an edit that keeps the size and
+ * mtime (rsync -t, touch -r) is caught too; hashing is a fraction of the decode cost.
+ */
+#define FIO_CACHE_MAGIC "SATSDEC2"
+#define FIO_CACHE_ENDIAN 0x0102030405060708LL
+
+/* Every field 8 bytes wide, so the layout is the same for 32 and 64 bit builds */
+typedef struct
+{
+    char magic[8];
+    __int64 endian;             /* FIO_CACHE_ENDIAN as written, catches byte order */
+    __int64 channels;
+    __int64 frames;
+    __int64 fs;
+    __int64 bytespersamp;
+    __int64 audio_type;
+    __int64 wav_size;           /* size of the WAV file in bytes */
+    __int64 wav_mtime;          /* modification time of the WAV file */
+    unsigned long long hash;    /* see fio_cache_fnv() */
+} fio_cache_header_t;
+
+/* FNV-1a over 64-bit words (bytes for the tail), fast enough to hash the whole input.
+ * Only ever compared with a hash made on the same machine, so byte order doesn't matter.
+ */
+static
+unsigned long long fio_cache_fnv( unsigned long long h, const unsigned char *cp, size_t n )
+{
+    unsigned long long w;
 
-    	        break;
+    for (; n >= sizeof(w); n -= sizeof(w), cp += sizeof(w))
+    {
+        memcpy(&w, cp, sizeof(w));
+        h ^= w;
+        h *= 0x100000001b3ULL;
+    }
+    while (n-- > 0)
+    {
+        h ^= *cp++;
+        h *= 0x100000001b3ULL;
+    }
+    return (h);
+}
 
-    	    default:
-    	        error("Invalid wave file format. please use only 16,24,32 bit files.");
-    	        return(-44);
-    	        break;
-    	}
+/* Hash "n" bytes of the input from byte offset "from" */
+static
+int fio_cache_hash_range( pfstruct pfs, __int64 from, __int64 n, unsigned long long *h )
+{
+    unsigned char buf[65536];      /* a multiple of 8, so the word boundaries match the mapped case */
+    size_t len;
 
-        *pd++ = d;
-        cp += (pfs->channels * pfs->bytespersamp);
+    if (pfs->map != NULL)
+    {
+        *h = fio_cache_fnv(*h, pfs->map + from, (size_t) n);
+        return (0);
     }
 
+    if (fseeko(pfs->fp, from, SEEK_SET) != 0)
+    {
+        return (-1);
+    }
+    while (n > 0)
+    {
+        len = (n < (__int64) sizeof(buf)) ? (size_t) n : sizeof(buf);
+        if (fread(buf, 1, len, pfs->fp) != len)
+        {
+            return (-1);
+        }
+        *h = fio_cache_fnv(*h, buf, len);
+        n -= len;
+    }
     return (0);
 }
 
-int fio_setpos( pfstruct pfs, long new_pos )
+/* Fill in the header a cache of the current input has to match */
+static
+int fio_cache_key( pfstruct pfs, fio_cache_header_t *key )
 {
-    fio_debug("fio_setpos: new_pos: %ld\n", new_pos);
-    fio_debug("fio_setpos: position: %ld ftell: %ld\n", pfs->position, ftell(pfs->fp));
+    __int64 data_bytes = pfs->size * pfs->channels * pfs->bytespersamp;
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    struct stat st;
+    int res;
 
-    pfs->position = pfs->position + new_pos;
-    fseek(pfs->fp, new_pos * pfs->channels * pfs->bytespersamp, SEEK_CUR);
+    if (pfs->stream || stat(pfs->filename, &st) != 0)
+    {
+        return (-1);
+    }
 
-    fio_debug("fio_setpos: position: %ld ftell: %ld\n", pfs->position, ftell(pfs->fp));
+    /* The WAV header and every sample */
+    res = fio_cache_hash_range(pfs, 0, (__int64) pfs->header_size + data_bytes, &h);
+    if (pfs->map == NULL)
+    {
+        fseeko(pfs->fp, (__int64) pfs->header_size + pfs->position * pfs->channels * pfs->bytespersamp, SEEK_SET);
+    }
+    if (res != 0)
+    {
+        return (-1);
+    }
 
+    memset(key, 0, sizeof(*key));
+    memcpy(key->magic, FIO_CACHE_MAGIC, sizeof(key->magic));
+    key->endian = FIO_CACHE_ENDIAN;
+    key->channels = pfs->channels;
+    key->frames = pfs->size;
+    key->fs = pfs->fs;
+    key->bytespersamp = pfs->bytespersamp;
+    key->audio_type = pfs->audio_type;
+    key->wav_size = (__int64) st.st_size;
+    key->wav_mtime = (__int64) st.st_mtime;
+    key->hash = h;
     return (0);
 }
 
-int fio_resetpos( pfstruct pfs )
+int fio_input_id( pfstruct pfs, char *id, size_t len )
 {
-    pfs->position = 0;
+    fio_cache_header_t key;
 
-    if (pfs->data)
+    if (fio_cache_key(pfs, &key) != 0)
     {
-        free(pfs->data);
-        pfs->malloc_size = 0;
-        pfs->data = NULL;
+        return (-1);
     }
-
-    fseek(pfs->fp, pfs->header_size, SEEK_SET);
-
+    snprintf(id, len, "%lld %lld %lld %d %016llx", (long long) key.wav_size, (long long) key.wav_mtime,
+             (long long) key.frames, (int) key.fs, key.hash);
     return (0);
 }
 
-int fio_cleanup( pfstruct pfs )
+static
+void fio_cache_name( pfstruct pfs, char *name, size_t len, const char *suffix )
 {
-    sdf_writer_delete(&pfs->sdf_out);
-    sdf_config_delete(&pfs->header);
-    fclose(pfs->fp);
-    free(wavbuf);
-    free(pfs->data);
-    return (0);
+    snprintf(name, len, "%s.satscache%s", pfs->filename, suffix);
 }
 
-/*check the channel for silence and remove it if the -s flag is set*/
+/* Set up pfs->planes from a matching cache file.  Returns 0 on success. */
+static
+int fio_cache_load( pfstruct pfs )
+{
+    fio_cache_header_t key;
+    fio_cache_header_t hdr;
+    char name[1100];
+    FILE *fp;
+    double bytes;
+    int ch;
 
+    pfs->planar_off = 1;
 
-#define NUM_SUBBLOCKS_SILENCE_STRIP 5  /* Defines the number of successive subblocks, whose average power will be compared against the user-adjustable threshold. */
-void strip_lead_silence( pfstruct pfs )
-{
-	int    block_size;
-    int    i = 0;
-	int    j;
-    int    ch;
-    int    selected_ch   = pfs->channel;
-    long   start_pos = pfs->size;
-    long   candidate_pos = 0;
-	double abs_value;
-    double *pd;
-    double block_thres;
-    double rms_db;
-	double rms_watt = 0.0;
-    double sample_thres = 0.0;
-	int    step;
-	
-	
-	double subblock_pw [NUM_SUBBLOCKS_SILENCE_STRIP]; /*define an array with the size of [ NUM_SUBBLOCKS_SILENCE_STRIP ] to store the power of all corresponding subblocks*/
+    bytes = (double) pfs->size * pfs->channels * sizeof(double);
+    if (pfs->size <= 0 || bytes > FIO_PLANAR_MAX_BYTES || fio_cache_key(pfs, &key) != 0)
+    {
+        return (-1);
+    }
 
-	/* choose the model of block power threshold */
-	if ((pfs->thr_sSet == 0) && (pfs->thr_dbSet == 1))
-	{
-        block_size  = pfs->fs/20;
-        block_thres = pfs->block_thr; 
-		step = block_size / NUM_SUBBLOCKS_SILENCE_STRIP; /* step of block moving is [ 1/NUM_SUBBLOCKS_SILENCE_STRIP ] block_size, then overlap is [ (1-1/NUM_SUBBLOCKS_SILENCE_STRIP) ] block_size*/
+    fio_cache_name(pfs, name, sizeof(name), "");
+    fp = fopen(name, "rb");
+    if (fp == NULL)
+    {
+        return (-1);
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || memcmp(&hdr, &key, sizeof(hdr)) != 0 ||
+        fseeko(fp, 0, SEEK_END) != 0 || (double) ftello(fp) != sizeof(hdr) + bytes)
+    {
+        fio_debug("%s is stale, decoding again\n", name);
+        fclose(fp);
+        return (-1);
+    }
 
-	    switch (pfs->bytespersamp)
-	    {
-		    case 2:
-				sample_thres = 1.0/32768.0;
-				break;
-			case 3:
-	            sample_thres = 1.0/8388608.0;
-				break;
-			case 4:
-	            sample_thres = 1.0/2147483648.0;
-				break;
-		    default:
-    	        error("Invalid wave file format. please use only 16,24,32 bit files.");
-    	        break;
-	    }
-	
+    pfs->planes = (double **) calloc(pfs->channels, sizeof(double *));
+    if (pfs->planes == NULL)
+    {
+        fclose(fp);
+        return (-1);
+    }
 
-        for (ch=0; ch<pfs->channels; ch++)
-        {
-			pfs->channel = ch;    
-            rms_db       = -999.0;
+#ifdef FIO_MMAP
+    {
+        void *p = mmap(NULL, sizeof(hdr) + (size_t) bytes, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
 
-			/*initialize the five array elements to store the smallest power*/
-			for ( i=0; i < NUM_SUBBLOCKS_SILENCE_STRIP; i++)
-			{
-				subblock_pw [i] = -999.0;
-			}
-            i = 0;
+        if (p != MAP_FAILED)
+        {
+            pfs->cache_map = (unsigned char *) p;
+            pfs->cache_map_size = (unsigned long) (sizeof(hdr) + bytes);
+            pfs->planes[0] = (double *) (pfs->cache_map + sizeof(hdr));
+        }
+    }
+#endif
+    if (pfs->cache_map == NULL)
+    {
+        pfs->planes[0] = (double *) malloc((size_t) bytes);
+        if (pfs->planes[0] == NULL || fseeko(fp, sizeof(hdr), SEEK_SET) != 0 ||
+            fread(pfs->planes[0], sizeof(double), (size_t) (pfs->size * pfs->channels), fp) != (size_t) (pfs->size * pfs->channels))
+        {
+            free(pfs->planes[0]);
+            free(pfs->planes);
+            pfs->planes = NULL;
+            fclose(fp);
+            return (-1);
+        }
+    }
+    fclose(fp);
+
+    for (ch = 1; ch < pfs->channels; ch++)
+    {
+        pfs->planes[ch] = pfs->planes[0] + ch * pfs->size;
+    }
+    fio_debug("decoded samples taken from %s\n", name);
+    return (0);
+}
+
+/* Write pfs->planes to the cache file.  Failing to is not an error, the next run
+ * just decodes again.  Written under a temporary name that includes the process id
+ * and then renamed, so that concurrent runs on the same input neither map a half
+ * written cache nor write into each other's.
+ */
+static
+void fio_cache_save( pfstruct pfs )
+{
+    fio_cache_header_t key;
+    char name[1100];
+    char tmp[1100];
+    char suffix[32];
+    FILE *fp;
+    size_t n = (size_t) (pfs->size * pfs->channels);
+    int ok;
+
+    if (fio_cache_key(pfs, &key) != 0)
+    {
+        return;
+    }
+
+    fio_cache_name(pfs, name, sizeof(name), "");
+    snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long) getpid());
+    fio_cache_name(pfs, tmp, sizeof(tmp), suffix);
+    fp = fopen(tmp, "wb");
+    if (fp == NULL)
+    {
+        fio_debug("cannot create %s\n", tmp);
+        return;
+    }
+    ok = (fwrite(&key, sizeof(key), 1, fp) == 1 && fwrite(pfs->planes[0], sizeof(double), n, fp) == n);
+    ok = (fclose(fp) == 0) && ok;
+
+    /* rename() replaces "name" in one step where it can; Windows wants it gone first */
+    if (ok && rename(tmp, name) != 0)
+    {
+        remove(name);
+        ok = (rename(tmp, name) == 0);
+    }
+    if (!ok)
+    {
+        fio_debug("cannot write %s\n", name);
+        remove(tmp);
+    }
+}
+
+/* Read-ahead (-ra): while the tool works on the block fio_read() just returned, a
+ * background thread reads and decodes the block it's expected to ask for next, i.e.
+ * the same number of samples of the same channel straight after it.  A read that
+ * doesn't match the guess waits for the thread and is done (by the thread) on demand.
+ * pfs->data points into one of two buffers; the thread only ever fills the other one,
+ * which is why the data from fio_read() is valid only up to the next call, as before.
+ */
+enum { AHEAD_IDLE, AHEAD_QUEUED, AHEAD_BUSY, AHEAD_DONE };
+
+struct fio_ahead
+{
+#ifdef FIO_THREADS
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    int state;                  /* AHEAD_xxx */
+    int quit;                   /* set by fio_cleanup() */
+    __int64 pos;                /* the job: "num" samples of channel "ch" from "pos" */
+    long num;
+    int ch;
+    long got;                   /* samples decoded, fewer than num if the file is short */
+    int status;                 /* 0 or fio_decode() error */
+    double *buf[2];
+    long buf_len[2];
+    int lent;                   /* buf[lent] is (or was last) handed out as pfs->data */
+    unsigned char *raw;         /* fread() path: interleaved frames */
+    long raw_len;
+    __int64 file_pos;           /* frame pfs->fp is at (the thread owns it), -1: unknown */
+};
+
+#ifdef FIO_THREADS
+/* Do the queued job, into the buffer that isn't handed out */
+static
+void fio_ahead_run( pfstruct pfs, struct fio_ahead *pa )
+{
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+    const unsigned char *cp;
+    int b = 1 - pa->lent;
+    long n = pa->num;
+    void *p;
+
+    pa->status = 0;
+    pa->got = 0;
+
+    if (pfs->map != NULL)
+    {
+        cp = pfs->map + pfs->header_size + pa->pos * frame_bytes + pa->ch * pfs->bytespersamp;
+    }
+    else
+    {
+        if (pa->file_pos != pa->pos &&
+            fseeko(pfs->fp, (__int64) pfs->header_size + pa->pos * frame_bytes, SEEK_SET) != 0)
+        {
+            pa->file_pos = -1;
+            pa->status = -1;
+            return;
+        }
+        if (pa->raw_len < n)
+        {
+            if ((p = realloc(pa->raw, n * frame_bytes)) == NULL)
+            {
+                pa->status = -1;
+                return;
+            }
+            pa->raw = (unsigned char *) p;
+            pa->raw_len = n;
+        }
+        n = (long) fread(pa->raw, frame_bytes, n, pfs->fp);
+        pa->file_pos = pa->pos + n;
+        cp = pa->raw + pa->ch * pfs->bytespersamp;
+    }
+
+    if (pa->buf_len[b] < n)
+    {
+        if ((p = realloc(pa->buf[b], n * sizeof(double))) == NULL)
+        {
+            pa->status = -1;
+            return;
+        }
+        pa->buf[b] = (double *) p;
+        pa->buf_len[b] = n;
+    }
+
+    pa->got = n;
+    if (n > 0)
+    {
+        pa->status = fio_decode(pfs, cp, frame_bytes, pa->buf[b], n);
+    }
+}
+
+static
+void *fio_ahead_thread( void *arg )
+{
+    pfstruct pfs = (pfstruct) arg;
+    struct fio_ahead *pa = pfs->ahead;
+
+    pthread_mutex_lock(&pa->lock);
+    for (;;)
+    {
+        while (!pa->quit && pa->state != AHEAD_QUEUED)
+        {
+            pthread_cond_wait(&pa->cond, &pa->lock);
+        }
+        if (pa->quit)
+        {
+            break;
+        }
+        pa->state = AHEAD_BUSY;
+        pthread_mutex_unlock(&pa->lock);
+
+        fio_ahead_run(pfs, pa);
+
+        pthread_mutex_lock(&pa->lock);
+        pa->state = AHEAD_DONE;
+        pthread_cond_broadcast(&pa->cond);
+    }
+    pthread_mutex_unlock(&pa->lock);
+
+    return (NULL);
+}
+
+/* Hand a job to the thread; called with the lock held */
+static
+void fio_ahead_queue( struct fio_ahead *pa, __int64 pos, long num, int ch )
+{
+    pa->pos = pos;
+    pa->num = num;
+    pa->ch = ch;
+    pa->state = AHEAD_QUEUED;
+    pthread_cond_broadcast(&pa->cond);
+}
+#endif
+
+/* Start the read-ahead thread.  Without threads, or if that fails, clears
+ * pfs->readAhead and leaves fio_read() synchronous.
+ */
+static
+void fio_ahead_start( pfstruct pfs )
+{
+#ifdef FIO_THREADS
+    struct fio_ahead *pa = (struct fio_ahead *) calloc(1, sizeof(struct fio_ahead));
+
+    if (pa != NULL)
+    {
+        pa->file_pos = -1;
+        pthread_mutex_init(&pa->lock, NULL);
+        pthread_cond_init(&pa->cond, NULL);
+        pfs->ahead = pa;
+        if (pthread_create(&pa->thread, NULL, fio_ahead_thread, pfs) == 0)
+        {
+            return;
+        }
+        pthread_cond_destroy(&pa->cond);
+        pthread_mutex_destroy(&pa->lock);
+        free(pa);
+        pfs->ahead = NULL;
+    }
+    warning("read-ahead thread could not be started, reading synchronously\n");
+#endif
+    pfs->readAhead = 0;
+}
+
+static
+void fio_ahead_stop( pfstruct pfs )
+{
+#ifdef FIO_THREADS
+    struct fio_ahead *pa = pfs->ahead;
+
+    if (pa == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pa->lock);
+    pa->quit = 1;
+    pthread_cond_broadcast(&pa->cond);
+    pthread_mutex_unlock(&pa->lock);
+    pthread_join(pa->thread, NULL);
+
+    pthread_cond_destroy(&pa->cond);
+    pthread_mutex_destroy(&pa->lock);
+    free(pa->buf[0]);
+    free(pa->buf[1]);
+    free(pa->raw);
+    free(pa);
+    pfs->ahead = NULL;
+#endif
+}
+
+#ifdef FIO_THREADS
+/* fio_read() through the read-ahead thread; "num" is already limited to the file */
+static
+int fio_ahead_read( pfstruct pfs, __int64 num )
+{
+    struct fio_ahead *pa = pfs->ahead;
+    int status;
+
+    pthread_mutex_lock(&pa->lock);
+
+    if (pa->state == AHEAD_IDLE ||
+        pa->pos != pfs->position || pa->num != (long) num || pa->ch != pfs->channel)
+    {
+        /* Not the block we guessed: wait for the thread, then ask for this one */
+        while (pa->state == AHEAD_BUSY)
+        {
+            pthread_cond_wait(&pa->cond, &pa->lock);
+        }
+        fio_ahead_queue(pa, pfs->position, (long) num, pfs->channel);
+    }
+    while (pa->state != AHEAD_DONE)
+    {
+        pthread_cond_wait(&pa->cond, &pa->lock);
+    }
+    pa->state = AHEAD_IDLE;
+
+    if (pa->got < (long) num)
+    {
+        /* Short file: like the fread() path, leave everything as it was */
+        pthread_mutex_unlock(&pa->lock);
+        return (pa->status);
+    }
+
+    pa->lent = 1 - pa->lent;
+    status = pa->status;
+
+    fio_release_data(pfs);
+    pfs->data = pa->buf[pa->lent];
+    pfs->data_position = 0;
+    pfs->data_size = num;
+    pfs->position = pfs->position + num;
+
+    /* Guess that the tool reads on in blocks of the same size */
+    if (status == 0 && pfs->position < pfs->size)
+    {
+        if (num > pfs->size - pfs->position)
+        {
+            num = pfs->size - pfs->position;
+        }
+        fio_ahead_queue(pa, pfs->position, (long) num, pfs->channel);
+    }
+
+    pthread_mutex_unlock(&pa->lock);
+
+    return (status);
+}
+#endif
+
+/* Decode every channel in one go (or take them from the cache) the first time that
+ * pays off: several channels will be read, which a stream couldn't give twice.  A
+ * single channel of a stream is read through pfs->sbuf, which only holds what the
+ * tool asked to keep.
+ */
+static
+void fio_planes_init( pfstruct pfs )
+{
+    if (pfs->planes == NULL && !pfs->planar_off &&
+        ((pfs->cache && !pfs->stream) || (pfs->channels > 1 && pfs->allChannels)))
+    {
+        if (!pfs->cache || fio_cache_load(pfs) != 0)
+        {
+            fio_decode_planes(pfs);
+            if (pfs->cache && pfs->planes != NULL)
+            {
+                fio_cache_save(pfs);
+            }
+        }
+    }
+}
+
+/* Decode every channel now, if the options call for it (see fio_planes_init()).
+ * Returns 1 when pfs->planes holds them all, so that several channels can be worked
+ * on in the same pass; the current channel's fio_read() then tells the position. */
+int fio_planes_ready( pfstruct pfs )
+{
+    fio_planes_init(pfs);
+
+    return (pfs->planes != NULL);
+}
+
+/* Read audio data from a file into memory */
+int fio_read( pfstruct pfs, __int64 num_samples_to_read )
+{
+    size_t bytes_to_read;
+    unsigned long stride;
+    const unsigned char *cp;
+
+    fio_planes_init(pfs);
+
+    if (pfs->readAhead && pfs->ahead == NULL && pfs->planes == NULL && !pfs->stream)
+    {
+        fio_ahead_start(pfs);
+    }
+
+    if (pfs->stream && pfs->planes == NULL)
+    {
+        /* Keep enough behind the read position for overlapping blocks */
+        if (pfs->sbuf.keep < 2 * (long) num_samples_to_read)
+        {
+            pfs->sbuf.keep = 2 * (long) num_samples_to_read;
+        }
+        if (fio_stream_fill(pfs, pfs->position, pfs->position + num_samples_to_read) != 0)
+        {
+            return (-1);
+        }
+    }
+
+    /* Limit number of samples to read, if necessary */
+    if (num_samples_to_read + pfs->position >= pfs->size)
+    {
+        /* Check the position is sensible */
+        if (pfs->position >= pfs->size)
+        {
+            fio_release_data(pfs);
+
+            pfs->data_size = 0;
+            pfs->data_position = 0;
+            return (1);
+        }
+        num_samples_to_read = pfs->size - pfs->position;
+    }
+
+    if (pfs->planes != NULL && pfs->position >= 0)
+    {
+        /* Already decoded, just point at it */
+        fio_release_data(pfs);
+        pfs->data = pfs->planes[pfs->channel] + pfs->position;
+        pfs->data_position = 0;
+        pfs->data_size = num_samples_to_read;
+        pfs->position = pfs->position + num_samples_to_read;
+        return (0);
+    }
+
+#ifdef FIO_THREADS
+    if (pfs->ahead != NULL)
+    {
+        return (fio_ahead_read(pfs, num_samples_to_read));
+    }
+#endif
+
+    stride = pfs->channels * pfs->bytespersamp;
+
+    if (pfs->map != NULL)
+    {
+        /* Decode straight out of the mapped data chunk */
+        cp = fio_channel_view(pfs, pfs->channel, NULL, NULL);
+    }
+    else if (pfs->stream)
+    {
+        cp = fio_stream_frames(pfs, pfs->position) + pfs->channel * pfs->bytespersamp;
+    }
+    else
+    {
+        /* Convert from samples to bytes */
+        bytes_to_read = (size_t) num_samples_to_read * pfs->channels * pfs->bytespersamp;
+
+        /* Allocate memory to read into */
+        if (bytes_to_read != pfs->wavbuf_size)
+        {
+            /* Free if previously allocated */
+            if (pfs->wavbuf)
+                free(pfs->wavbuf);
+
+            pfs->wavbuf = (unsigned char *) calloc(bytes_to_read, 1);
+
+            if (pfs->wavbuf)
+                pfs->wavbuf_size = bytes_to_read;
+            else
+            {
+                pfs->wavbuf_size = 0;
+                error("wavbuf malloc failed\n");
+                return(-1);
+            }
+        }
+
+        /* Do the read */
+        if (fread(pfs->wavbuf, 1, bytes_to_read, pfs->fp) != bytes_to_read)
+        {
+            if (feof(pfs->fp))
+            {
+                return 0;
+            }
+            else
+            {
+                error("Read failed\n");
+                return (-1);
+            }
+        }
+
+        cp = pfs->wavbuf + (pfs->channel * pfs->bytespersamp);
+    }
+
+    /* Set data_position and data_size */
+    pfs->data_position = 0;
+    pfs->data_size = num_samples_to_read;
+
+    /* Update "position" */
+    pfs->position = pfs->position + num_samples_to_read;
+
+    /* Convert to floating point and scale */
+    if (pfs->malloc_size != (size_t) num_samples_to_read * sizeof(double))
+    {
+        fio_release_data(pfs);
+
+        if ((pfs->data = (double *) calloc((size_t) num_samples_to_read, sizeof(double))) == NULL)
+        {
+            error("malloc failed\n");
+        }
+
+        if (pfs->data)
+            pfs->malloc_size = (size_t) num_samples_to_read * sizeof(double);
+        else
+            error("data malloc failed\n");
+    }
+
+    //	convert to floating point and scale
+    return (fio_decode(pfs, cp, stride, pfs->data, (long) num_samples_to_read));
+}
+
+const unsigned char *fio_channel_view( pfstruct pfs, int ch, unsigned long *stride, __int64 *num_samples )
+{
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+
+    if (pfs->map == NULL || ch < 0 || ch >= pfs->channels)
+    {
+        return (NULL);
+    }
+
+    if (stride != NULL)
+    {
+        *stride = frame_bytes;
+    }
+    if (num_samples != NULL)
+    {
+        *num_samples = (pfs->position < pfs->size) ? pfs->size - pfs->position : 0;
+    }
+
+    return (pfs->map + pfs->header_size + pfs->position * frame_bytes + ch * pfs->bytespersamp);
+}
+
+/* Decode "num" samples of the current channel from file position "from" into "dst" */
+static
+int fio_window_decode( pfstruct pfs, __int64 from, long num, double *dst )
+{
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+    unsigned long offset = pfs->channel * pfs->bytespersamp;
+    const unsigned char *cp;
+    long n;
+
+    if (pfs->planes != NULL)
+    {
+        memcpy(dst, pfs->planes[pfs->channel] + from, num * sizeof(double));
+        return (0);
+    }
+
+    if (pfs->map != NULL)
+    {
+        return (fio_decode(pfs, pfs->map + pfs->header_size + from * frame_bytes + offset, frame_bytes, dst, num));
+    }
+
+    if (pfs->stream)
+    {
+        if (fio_stream_fill(pfs, from, from + num) != 0 || from + num > pfs->size)
+        {
+            return (-1);
+        }
+        cp = fio_stream_frames(pfs, from);
+        return (fio_decode(pfs, cp + offset, frame_bytes, dst, num));
+    }
+
+    if (fseeko(pfs->fp, (__int64) pfs->header_size + from * frame_bytes, SEEK_SET) != 0)
+    {
+        return (-1);
+    }
+    for (; num > 0; num -= n, dst += n)
+    {
+        n = (num < FIO_PLANAR_BLOCK) ? num : FIO_PLANAR_BLOCK;
+        if (pfs->wavbuf_size < n * frame_bytes)
+        {
+            free(pfs->wavbuf);
+            pfs->wavbuf_size = 0;
+            if ((pfs->wavbuf = (unsigned char *) malloc(FIO_PLANAR_BLOCK * frame_bytes)) == NULL)
+            {
+                return (-1);
+            }
+            pfs->wavbuf_size = FIO_PLANAR_BLOCK * frame_bytes;
+        }
+        if (fread(pfs->wavbuf, frame_bytes, n, pfs->fp) != (size_t) n ||
+            fio_decode(pfs, pfs->wavbuf + offset, frame_bytes, dst, n) != 0)
+        {
+            return (-1);
+        }
+    }
+    return (0);
+}
+
+/* Fill "dst" with window indices [from, from + num).  Whatever lies outside the file reads
+ * as zero, and so does a part that can't be read (after a warning).
+ */
+static
+void fio_window_fill( pfstruct pfs, __int64 from, long num, double *dst )
+{
+    __int64 lo = pfs->win.base + from;
+    __int64 hi = lo + num;
+    __int64 a = (lo < 0) ? 0 : lo;
+    __int64 b = (hi > pfs->size) ? pfs->size : hi;
+
+    memset(dst, 0, num * sizeof(double));
+    if (a < b && fio_window_decode(pfs, a, (long) (b - a), dst + (a - lo)) != 0)
+    {
+        warning("could not read samples %lld to %lld\n", (long long) a, (long long) b);
+        memset(dst, 0, num * sizeof(double));
+    }
+}
+
+int fio_window_open( pfstruct pfs )
+{
+    fio_window_close(pfs);
+
+    /* If every channel is decoded already (-cache, or -c a on a stream), the window is
+     * mostly a view into the planes */
+    fio_planes_init(pfs);
+    if (pfs->map == NULL && !pfs->stream)
+    {
+        /* the window seeks the file itself */
+        fio_ahead_stop(pfs);
+    }
+    if (pfs->stream && pfs->sbuf.keep < 2 * pfs->fs)
+    {
+        pfs->sbuf.keep = 2 * pfs->fs;
+    }
+
+    fio_release_data(pfs);
+    pfs->win.base = pfs->position;
+    pfs->win.start = 0;
+    pfs->win.len = 0;
+    pfs->win.keep = 0;
+    pfs->win.open = 1;
+    pfs->data_position = 0;
+    pfs->data_size = (pfs->position < pfs->size) ? pfs->size - pfs->position : 0;
+
+    return (0);
+}
+
+const double *fio_window_get( pfstruct pfs, __int64 pos, long num )
+{
+    fio_window_t *w = &pfs->win;
+    __int64 end = w->start + w->len;
+    __int64 lo, hi, ov_lo, ov_hi;
+    void *p;
+
+    if (!w->open)
+    {
+        return (pfs->data + pos);
+    }
+    if (pfs->planes != NULL && w->base + pos >= 0 && w->base + pos + num <= pfs->size)
+    {
+        return (pfs->planes[pfs->channel] + w->base + pos);
+    }
+    if (pos >= w->start && pos + num <= end)
+    {
+        return (w->buf + (pos - w->start));
+    }
+
+    /* New extent: from the release mark (or "pos", if earlier), up to a second past what
+     * is asked for, as the dwell search mostly moves forward */
+    lo = pos;
+    if (w->len > 0 && lo > w->start)
+    {
+        lo = (w->keep > w->start) ? w->keep : w->start;
+        lo = (lo < pos) ? lo : pos;
+    }
+    hi = pos + num + pfs->fs;
+    if (hi > pfs->data_size)
+    {
+        hi = (pfs->data_size > pos + num) ? pfs->data_size : pos + num;
+    }
+    if (w->len > 0 && hi < end)
+    {
+        hi = end;
+    }
+
+    if (w->alloc < hi - lo || w->alloc < w->len)
+    {
+        long alloc = (hi - lo > 2 * w->alloc) ? (long) (hi - lo) : 2 * w->alloc;
+
+        if ((p = realloc(w->buf, alloc * sizeof(double))) == NULL)
+        {
+            error("Out of memory for %ld samples\n", alloc);
+            exit(1);
+        }
+        w->buf = (double *) p;
+        w->alloc = alloc;
+    }
+
+    /* Keep what's already decoded, read the rest */
+    ov_lo = (lo > w->start) ? lo : w->start;
+    ov_hi = (hi < end) ? hi : end;
+    if (w->len > 0 && ov_lo < ov_hi)
+    {
+        memmove(w->buf + (ov_lo - lo), w->buf + (ov_lo - w->start), (ov_hi - ov_lo) * sizeof(double));
+        fio_window_fill(pfs, lo, (long) (ov_lo - lo), w->buf);
+        fio_window_fill(pfs, ov_hi, (long) (hi - ov_hi), w->buf + (ov_hi - lo));
+    }
+    else
+    {
+        fio_window_fill(pfs, lo, (long) (hi - lo), w->buf);
+    }
+    w->start = lo;
+    w->len = (long) (hi - lo);
+
+    return (w->buf + (pos - lo));
+}
+
+void fio_window_release( pfstruct pfs, __int64 pos )
+{
+    /* the search for the next dwell may look up to a second back */
+    pfs->win.keep = pos - pfs->fs;
+}
+
+void fio_window_close( pfstruct pfs )
+{
+    if (pfs->win.open && pfs->planes == NULL && pfs->map == NULL && !pfs->stream)
+    {
+        /* back to where fio_read() expects the file to be */
+        fseeko(pfs->fp, (__int64) pfs->header_size + pfs->position * pfs->channels * pfs->bytespersamp, SEEK_SET);
+    }
+    free(pfs->win.buf);
+    memset(&pfs->win, 0, sizeof(pfs->win));
+}
+
+void fio_windowed( pfstruct pfs )
+{
+    /* a stream's other channels couldn't be read again, and -cache keeps the planes on disk */
+    if (!pfs->stream && !pfs->cache)
+    {
+        pfs->planar_off = 1;
+    }
+}
+
+void fio_keep_all( pfstruct pfs )
+{
+    pfs->sbuf.hold = 1;
+}
+
+int fio_setpos( pfstruct pfs, __int64 new_pos )
+{
+    fio_debug("fio_setpos: new_pos: %lld\n", (long long) new_pos);
+    fio_debug("fio_setpos: position: %lld ftell: %lld\n", (long long) pfs->position, (long long) ftello(pfs->fp));
+
+    pfs->position = pfs->position + new_pos;
+    if (!pfs->stream && pfs->ahead == NULL)
+    {
+        fseeko(pfs->fp, new_pos * pfs->channels * pfs->bytespersamp, SEEK_CUR);
+    }
+
+    fio_debug("fio_setpos: position: %lld ftell: %lld\n", (long long) pfs->position, (long long) ftello(pfs->fp));
+
+    return (0);
+}
+
+int fio_resetpos( pfstruct pfs )
+{
+    pfs->position = 0;
+
+    fio_release_data(pfs);
+
+    if (!pfs->stream && pfs->ahead == NULL)
+    {
+        fseeko(pfs->fp, (__int64) pfs->header_size, SEEK_SET);
+    }
+
+    return (0);
+}
+
+int fio_cleanup( pfstruct pfs )
+{
+    sdf_writer_delete(&pfs->sdf_out);
+    sdf_config_delete(&pfs->header);
+    fio_ahead_stop(pfs);
+    fio_window_close(pfs);
+#ifdef FIO_MMAP
+    if (pfs->map != NULL)
+    {
+        munmap(pfs->map, pfs->map_size);
+        pfs->map = NULL;
+        pfs->map_size = 0;
+    }
+#endif
+    fclose(pfs->fp);
+    free(pfs->wavbuf);
+    pfs->wavbuf = NULL;
+    pfs->wavbuf_size = 0;
+    free(pfs->sbuf.buf);
+    pfs->sbuf.buf = NULL;
+    fio_release_data(pfs);
+    if (pfs->planes != NULL)
+    {
+        if (pfs->cache_map == NULL)
+        {
+            free(pfs->planes[0]);
+        }
+        free(pfs->planes);
+        pfs->planes = NULL;
+    }
+#ifdef FIO_MMAP
+    if (pfs->cache_map != NULL)
+    {
+        munmap(pfs->cache_map, pfs->cache_map_size);
+        pfs->cache_map = NULL;
+        pfs->cache_map_size = 0;
+    }
+#endif
+    return (0);
+}
+
+/* First frame in which a sample of any channel is at least "thres" (a fraction of full
+ * scale), or pfs->size if there is none.  That is the earliest of the channels' first
+ * crossings, so the interleaved data is searched as one run of samples, raw, in a single
+ * pass that stops at the first hit.  Already decoded planes are searched instead if
+ * there are any.
+ */
+static
+__int64 fio_find_level( pfstruct pfs, double thres )
+{
+    unsigned long frame_bytes = pfs->channels * pfs->bytespersamp;
+    pcm_find_fn find = pcm_find_select(pfs->bytespersamp, pfs->audio_type, pfs->format_tag);
+    unsigned char *buf = NULL;
+    const unsigned char *cp;
+    __int64 first = pfs->size;
+    __int64 done;
+    long n;
+    long i;
+    int ch;
+
+    if (pfs->planes != NULL)
+    {
+        for (ch = 0; ch < pfs->channels; ch++)
+        {
+            for (done = 0; done < first; done++)
+            {
+                if (fabs(pfs->planes[ch][done]) >= thres)
+                {
+                    first = done;
+                    break;
+                }
+            }
+        }
+        return (first);
+    }
+
+    if (find == NULL)
+    {
+        error("Invalid wave file format. please use only 16,24,32 bit files.");
+        return (0);
+    }
+
+    if (pfs->map == NULL && !pfs->stream)
+    {
+        /* the read-ahead thread would lose track of the file position */
+        fio_ahead_stop(pfs);
+        buf = (unsigned char *) malloc(FIO_PLANAR_BLOCK * frame_bytes);
+        if (buf == NULL || fseeko(pfs->fp, (__int64) pfs->header_size, SEEK_SET) != 0)
+        {
+            error("Read failed\n");
+            free(buf);
+            return (0);
+        }
+    }
+
+    for (done = 0; done < pfs->size; done += n)
+    {
+        n = FIO_PLANAR_BLOCK;
+        if (n > pfs->size - done)
+        {
+            n = (long) (pfs->size - done);
+        }
+
+        if (pfs->map != NULL)
+        {
+            cp = pfs->map + pfs->header_size + done * frame_bytes;
+        }
+        else if (pfs->stream)
+        {
+            if (fio_stream_fill(pfs, done, done + n) != 0)
+            {
+                break;
+            }
+            if (n > pfs->size - done)
+            {
+                n = (long) (pfs->size - done);
+            }
+            cp = fio_stream_frames(pfs, done);
+        }
+        else
+        {
+            n = (long) fread(buf, frame_bytes, n, pfs->fp);
+            if (n <= 0)
+            {
+                break;
+            }
+            cp = buf;
+        }
+
+        i = find(cp, n * pfs->channels, thres);
+        if (i < n * pfs->channels)
+        {
+            first = done + i / pfs->channels;
+            break;
+        }
+    }
+
+    free(buf);
+    if (first > pfs->size)
+    {
+        first = pfs->size;      /* a stream can turn out shorter than announced */
+    }
+    return (first);
+}
+
+/*check the channel for silence and remove it if the -s flag is set*/
+
+
+#define NUM_SUBBLOCKS_SILENCE_STRIP 5  /* Defines the number of successive subblocks, whose average power will be compared against the user-adjustable threshold. */
+void strip_lead_silence( pfstruct pfs )
+{
+	int    block_size;
+    int    i = 0;
+	int    j;
+    int    ch;
+    int    selected_ch   = pfs->channel;
+    __int64 start_pos = pfs->size;
+    __int64 candidate_pos = 0;
+	double abs_value;
+    double *pd;
+    double block_thres;
+    double rms_db;
+	double rms_watt = 0.0;
+    double sample_thres = 0.0;
+	int    step;
+    short  hold;
+	
+	
+	double subblock_pw [NUM_SUBBLOCKS_SILENCE_STRIP]; /*define an array with the size of [ NUM_SUBBLOCKS_SILENCE_STRIP ] to store the power of all corresponding subblocks*/
+
+    /* The result doesn't depend on the channel, so it's only worked out once */
+    if (pfs->leadSilenceSet)
+    {
+        fio_resetpos(pfs);
+        fio_setpos(pfs, pfs->leadSilence);
+        return;
+    }
+
+    /* every channel is scanned from the start, so a streamed input must keep it all */
+    hold = pfs->sbuf.hold;
+    pfs->sbuf.hold = 1;
+
+	/* choose the model of block power threshold */
+	if ((pfs->thr_sSet == 0) && (pfs->thr_dbSet == 1))
+	{
+        block_size  = pfs->fs/20;
+        block_thres = pfs->block_thr; 
+		step = block_size / NUM_SUBBLOCKS_SILENCE_STRIP; /* step of block moving is [ 1/NUM_SUBBLOCKS_SILENCE_STRIP ] block_size, then overlap is [ (1-1/NUM_SUBBLOCKS_SILENCE_STRIP) ] block_size*/
+
+	    switch (pfs->bytespersamp)
+	    {
+		    case 2:
+				sample_thres = 1.0/32768.0;
+				break;
+			case 3:
+	            sample_thres = 1.0/8388608.0;
+				break;
+			case 4:
+	            sample_thres = 1.0/2147483648.0;
+				break;
+		    default:
+    	        error("Invalid wave file format. please use only 16,24,32 bit files.");
+    	        break;
+	    }
+	
+
+        for (ch=0; ch<pfs->channels; ch++)
+        {
+			pfs->channel = ch;    
+            rms_db       = -999.0;
+
+			/*initialize the five array elements to store the smallest power*/
+			for ( i=0; i < NUM_SUBBLOCKS_SILENCE_STRIP; i++)
+			{
+				subblock_pw [i] = -999.0;
+			}
+            i = 0;
 
             /* find the first block over the block threshold */			
 	        while (rms_db < block_thres && !fio_eof(pfs))
@@ -693,15 +1824,11 @@ void strip_lead_silence( pfstruct pfs )
             }
 	        fio_resetpos(pfs);
 	    }
-        pfs->channel = selected_ch;
-        fio_setpos(pfs, start_pos);
 	}
 
 	/* choose the model of sample threshold */
 	else if ((pfs->thr_sSet == 1) && (pfs->thr_dbSet == 0))
 	{
-	    block_size = pfs->size;
-    
 	    switch (pfs->bytespersamp)
 		{
 		    case 2:
@@ -719,38 +1846,12 @@ void strip_lead_silence( pfstruct pfs )
 	    }
 	
 
-        for (ch=0; ch<pfs->channels; ch++)
-        {
-            pfs->channel = ch;    
-            fio_read(pfs, block_size);
-            pd = pfs->data;
-
-            for (i = 0; i < pfs->data_size; i++)
-            {
-			    abs_value=fabs(*pd );
-			    if (abs_value>= sample_thres)
-				{
-                    break;
-				}
-                pd++;
-            }
-        
-            candidate_pos = pfs->position - (pfs->data_size - i);
-            if (candidate_pos < start_pos)
-            {
-                start_pos = candidate_pos;
-            }
-	        fio_resetpos(pfs);
-	    }
-        pfs->channel = selected_ch;
-        fio_setpos(pfs, start_pos);
+        start_pos = fio_find_level(pfs, sample_thres);
 	}
 
     /* execute the default model */
 	else
 	{
-		block_size = pfs->size;
-    
 	    switch (pfs->bytespersamp)
 	    {
 		    case 2:
@@ -767,32 +1868,15 @@ void strip_lead_silence( pfstruct pfs )
     	        break;
 	    }
 	
-        for (ch=0; ch<pfs->channels; ch++)
-        {
-            pfs->channel = ch;    
-            fio_read(pfs, block_size);
-            pd = pfs->data;
-
-            for (i = 0; i < pfs->data_size; i++)
-            {
-				abs_value=fabs(*pd );
-		        if (abs_value >= sample_thres)
-			    {
-                    break;
-			    }
-                pd++;
-            }
-        
-            candidate_pos = pfs->position - (pfs->data_size - i);
-            if (candidate_pos < start_pos)
-            {
-                start_pos = candidate_pos;
-            }
-	        fio_resetpos(pfs);
-	    }
-        pfs->channel = selected_ch;
-        fio_setpos(pfs, start_pos);
+        start_pos = fio_find_level(pfs, sample_thres);
 	}
+
+    pfs->leadSilence = start_pos;
+    pfs->leadSilenceSet = 1;
+    fio_resetpos(pfs);
+    pfs->channel = selected_ch;
+    fio_setpos(pfs, start_pos);
+    pfs->sbuf.hold = hold;
 }
 
 char *channelMap_1[] =
@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	fio.h
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	fio.h
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #ifndef __FSTRUCT_H__
@@ -34,8 +34,32 @@
 
 #include "sdf_writer.h"
 #include "wavelib.h"
+#include "pcm_convert.h"
 #include <stdio.h>
 
+/* Raw interleaved frames [start, start + frames) of a streamed input */
+typedef struct
+{
+    unsigned char *buf;
+    __int64 start;              /* sample index of the first frame in buf */
+    long frames;                /* frames held */
+    long alloc;                 /* capacity of buf in frames */
+    long keep;                  /* frames kept behind the read position for re-reads */
+    short hold;                 /* set while nothing may be dropped */
+} fio_stream_t;
+
+/* Decoded samples of one channel, held for random access by the dwell search */
+typedef struct
+{
+    double *buf;
+    __int64 base;               /* sample index in the file of window index 0 */
+    __int64 start;              /* window index of buf[0] */
+    long len;                   /* samples held */
+    long alloc;                 /* capacity of buf in samples */
+    __int64 keep;               /* samples before this window index may be dropped */
+    short open;
+} fio_window_t;
+
 typedef struct
 {
     char filename[1024];
@@ -44,21 +68,31 @@ typedef struct
     int channel;                /* channel to test */
     short channels;               /* total number of channels */
     short allChannels;            /* true if -ca option used */
-    long position;              /* in samples */
-    long size;                  /* size of the entire file in samples */
+    __int64 position;           /* in samples */
+    __int64 size;               /* size of the entire file in samples (64-bit for RF64/Wave64) */
     long fs;                    /* in Hertz */
 
     double *data;               /* pointer to data */
-    long data_position;         /* in samples */
-    long data_size;             /* in samples */
-    unsigned long malloc_size;  /* size of "data" in bytes */
+    __int64 data_position;      /* in samples */
+    __int64 data_size;          /* in samples */
+    size_t malloc_size;         /* size of "data" in bytes, 0 if "data" points into "planes" */
+    double **planes;            /* every channel decoded in one pass, or NULL */
+    short planar_off;           /* set once the single pass decode has been tried */
 
 
     unsigned long header_size;  /* wave file header size in bytes */
+    unsigned char *map;         /* memory-mapped input file, NULL if read through fp */
+    unsigned long map_size;     /* size of the mapping in bytes */
+    unsigned char *wavbuf;      /* raw frames read by fio_read() when not memory mapped */
+    size_t wavbuf_size;         /* size of "wavbuf" in bytes */
+    short stream;               /* input is stdin, a pipe or a FIFO: it can only be read forward */
+    fio_stream_t sbuf;          /* recently read frames of a streamed input */
+    fio_window_t win;           /* see fio_window_open() */
     short bitspersamp;
     short bytespersamp;
     int audio_type;             /* WAV audio format (1: PCM, 3: FLOAT) */
     short format_tag;           /* Flag set if wav file type is PCM type   */
+    pcm_convert_fn convert;     /* sample decoder for this file's format */
 
     int time;                   /*used as a counter for the number of frames in spectrogram*/
     short channelMap;           /* true if -m option used */
@@ -85,6 +119,15 @@ typedef struct
     double xmax;				/* value, undefined if xmaxSet false */
 
     short noSilence;            /* turn off strip_lead_silence */
+    short leadSilenceSet;       /* strip_lead_silence() has run, its result is in leadSilence */
+    __int64 leadSilence;        /* samples of lead silence, the same for every channel */
+    short readAhead;            /* -ra option, read and decode the next block in the background */
+    struct fio_ahead *ahead;    /* read-ahead thread state, NULL if not running */
+    short cache;                /* -cache option, keep decoded samples in <input>.satscache */
+    unsigned char *cache_map;   /* memory-mapped cache file the planes point into, or NULL */
+    unsigned long cache_map_size;
+    int threads;                /* -j option, threads measuring dwells in thd_freq(), 1: none */
+    char dwellMap[1024];        /* -dwells option, dwell map file for thd_freq(), "" if none */
     
     short windowtype;           /* Window type for spectrogram tool */
     short top;                  /* output top envelope data, mainly used for "res_envelope" */
@@ -115,12 +158,52 @@ int fio_next_chunk( pfstruct pfs, int ch );
 
 int fio_eof( pfstruct pfs ); /*function that checks for the end of file */
 
-int fio_read( pfstruct pfs, unsigned long num ); /*Read the file*/
+int fio_read( pfstruct pfs, __int64 num ); /*Read the file*/
+
+/* Decode every channel up front when the options allow it; 1 if pfs->planes holds them */
+int fio_planes_ready( pfstruct pfs );
 
-int fio_setpos( pfstruct pfs, long new_pos ); /*set the position to start reading the file*/
+/* For tools that read each channel through fio_window_open(): the window decodes only
+ * the span being worked on, so every channel isn't decoded up front for "-c a" as well.
+ * Call before the first read.
+ */
+void fio_windowed( pfstruct pfs );
+
+/* For tools that read a channel more than once: a streamed input then keeps every frame
+ * it delivers, as a file would.  Other inputs are unaffected.
+ */
+void fio_keep_all( pfstruct pfs );
+
+int fio_setpos( pfstruct pfs, __int64 new_pos ); /*set the position to start reading the file*/
+
+/* Strided view of channel "ch" in the memory-mapped data chunk, starting at the current
+ * position.  Returns NULL if the file is not memory mapped, otherwise *stride is set to
+ * the byte distance between successive samples and *num_samples to the samples left.
+ */
+const unsigned char *fio_channel_view( pfstruct pfs, int ch, unsigned long *stride, __int64 *num_samples );
 
 int fio_resetpos( pfstruct pfs ); /*reset the starting postion*/
 
+/* Random access to the current channel from the current position to the end of the file,
+ * without holding all of it in memory.  After fio_window_open(), pfs->data_size is the
+ * number of samples from the current position to the end and fio_window_get() returns
+ * "num" of them from index "pos" on (index 0 being the current position; a negative
+ * "pos" reaches back before it).  Samples outside the file read as zero.  The pointer is
+ * valid until the next call.  fio_window_release() says that nothing much before index
+ * "pos" will be asked for again, so that the memory can be reused.  Without an open
+ * window, fio_window_get() indexes pfs->data.
+ */
+int fio_window_open( pfstruct pfs );
+const double *fio_window_get( pfstruct pfs, __int64 pos, long num );
+void fio_window_release( pfstruct pfs, __int64 pos );
+void fio_window_close( pfstruct pfs );
+
+/* Identify the input file, as -cache does, by its size, modification time and a hash of
+ * everything up to the end of its data, written to "id" as a line of text to compare
+ * with a later run's.  Returns -1 if the input is a stream, 0 otherwise.
+ */
+int fio_input_id( pfstruct pfs, char *id, size_t len );
+
 int fio_cleanup( pfstruct pfs ); /*cleanup function*/
 
 void strip_lead_silence( pfstruct pfs ); /*function to strip the leading silence*/
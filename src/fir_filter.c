@@ -31,17 +31,171 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <assert.h>
 
 #include "fir_filter.h"
-#include "debug.h"
-
+#include "debug.h"
+
+#include "SATS_fft.h"
+
 extern double fir_filter( double , pFIR_FILTER  );
 
+/* Overlap-save transform size: a power of two of at least 8 times the taps, so most of
+ * every transform is new output */
+static int fir_fft_size( int bl, int *lg )
+{
+    int n = 256;
+
+    *lg = 8;
+    while (n < 8 * bl)
+    {
+        n <<= 1;
+        (*lg)++;
+    }
+    return (n);
+}
+
+static void cleanup_fir_fft( pFIR_FILTER pf )
+{
+    if (pf->fwd != NULL)
+    {
+        SATS_FFT_ReleasePlan((SATS_FFT_HANDLE) pf->fwd);
+    }
+    if (pf->inv != NULL)
+    {
+        SATS_FFT_ReleasePlan((SATS_FFT_HANDLE) pf->inv);
+    }
+    free(pf->H);
+    free(pf->X);
+    free(pf->frame);
+    free(pf->y);
+    pf->fwd = pf->inv = NULL;
+    pf->H = pf->X = NULL;
+    pf->frame = pf->y = NULL;
+    pf->nfft = 0;
+}
+
+/* Sets pf up for overlap-save; returns -1, leaving pf in direct form, if it can't */
+static int init_fir_fft( pFIR_FILTER pf )
+{
+    SATS_FFT_Complex *H;
+    double scale;
+    int i;
+
+    pf->nfft = fir_fft_size(pf->bl, &pf->lg);
+    pf->hop = pf->nfft - pf->bl + 1;
+    pf->fill = 0;
+    pf->fwd = SATS_FFT_AcquirePlan(pf->nfft, SATS_FFT_FORWARD);
+    pf->inv = SATS_FFT_AcquirePlan(pf->nfft, SATS_FFT_INVERSE);
+    pf->H = calloc(pf->nfft / 2 + 1, sizeof(SATS_FFT_Complex));
+    pf->X = calloc(pf->nfft / 2 + 1, sizeof(SATS_FFT_Complex));
+    pf->frame = (double *) calloc(pf->nfft, sizeof(double));
+    pf->y = (double *) calloc(pf->nfft, sizeof(double));
+    if (pf->fwd == NULL || pf->inv == NULL || pf->H == NULL || pf->X == NULL || pf->frame == NULL || pf->y == NULL)
+    {
+        cleanup_fir_fft(pf);
+        return (-1);
+    }
+
+    /* spectrum of the zero padded taps, with the inverse transform's 1/nfft folded in */
+    H = (SATS_FFT_Complex *) pf->H;
+    for (i = 0; i < pf->bl; i++)
+    {
+        pf->frame[i] = pf->b[i];
+    }
+    (void) SATS_FFT_ComputeForward((SATS_FFT_HANDLE) pf->fwd, pf->frame, H);
+    scale = 1.0 / pf->nfft;
+    for (i = 0; i <= pf->nfft / 2; i++)
+    {
+        SATS_FFT_REAL(H[i]) *= scale;
+        SATS_FFT_IMAG(H[i]) *= scale;
+    }
+
+    memset(pf->frame, 0, pf->nfft * sizeof(double));
+
+    return (0);
+}
+
+/*
+ * Filters the c new samples just stored at frame[bl - 1 + fill] (fill + c <= hop) into
+ * out.  Those outputs of the circular convolution reach back no further than frame[0]
+ * and never past the new samples, so stale data beyond them needs no clearing.
+ */
+static void fir_fft_hop( pFIR_FILTER pf, double *out, int c )
+{
+    const int m = pf->bl - 1;
+    SATS_FFT_Complex *H = (SATS_FFT_Complex *) pf->H;
+    SATS_FFT_Complex *X = (SATS_FFT_Complex *) pf->X;
+    int i, k;
+
+    if ((double) c * pf->bl < 2.0 * pf->nfft * pf->lg)
+    {
+        /* too few samples to pay for the transforms: convolve directly */
+        for (i = 0; i < c; i++)
+        {
+            const double *px = &pf->frame[m + pf->fill + i];
+            double sum = 0.0;
+
+            for (k = 0; k < pf->bl; k++)
+            {
+                sum += pf->b[k] * px[-k];
+            }
+            out[i] = sum;
+        }
+    }
+    else
+    {
+        (void) SATS_FFT_ComputeForward((SATS_FFT_HANDLE) pf->fwd, pf->frame, X);
+        for (i = 0; i <= pf->nfft / 2; i++)
+        {
+            double re = SATS_FFT_REAL(X[i]) * SATS_FFT_REAL(H[i]) - SATS_FFT_IMAG(X[i]) * SATS_FFT_IMAG(H[i]);
+            double im = SATS_FFT_REAL(X[i]) * SATS_FFT_IMAG(H[i]) + SATS_FFT_IMAG(X[i]) * SATS_FFT_REAL(H[i]);
+
+            SATS_FFT_REAL(X[i]) = re;
+            SATS_FFT_IMAG(X[i]) = im;
+        }
+        (void) SATS_FFT_ComputeInverse((SATS_FFT_HANDLE) pf->inv, X, pf->y);
+        memcpy(out, &pf->y[m + pf->fill], c * sizeof(double));
+    }
+
+    /* once the hop is complete its last bl - 1 inputs become the history */
+    pf->fill += c;
+    if (pf->fill == pf->hop)
+    {
+        memmove(pf->frame, &pf->frame[pf->hop], m * sizeof(double));
+        pf->fill = 0;
+    }
+}
+
+static void fir_fft_array( double *in, pFIR_FILTER pf, double *out, unsigned long l )
+{
+    unsigned long i, c;
+
+    for (i = 0; i < l; i += c)
+    {
+        c = (unsigned long) (pf->hop - pf->fill);
+        if (c > l - i)
+        {
+            c = l - i;
+        }
+        memcpy(&pf->frame[pf->bl - 1 + pf->fill], &in[i], c * sizeof(double));
+        fir_fft_hop(pf, &out[i], (int) c);
+    }
+}
+
 int init_fir_filter( pFIR_FILTER pf )
 {
 
     assert(pf->input == NULL);
+    assert(pf->frame == NULL);
+
+    pf->nfft = 0;
+    if (pf->bl >= FIR_FFT_MIN_TAPS && init_fir_fft(pf) == 0)
+    {
+        return(0);
+    }
 
     pf->input = (double *) calloc(sizeof(double), pf->bl);
     if (pf->input == NULL)
@@ -60,6 +214,13 @@ void reset_fir_filter( pFIR_FILTER pf )
 {
     int i;
 
+    if (pf->nfft > 0)
+    {
+        memset(pf->frame, 0, pf->nfft * sizeof(double));
+        pf->fill = 0;
+        return;
+    }
+
     assert(pf->input != NULL);
 
     for (i = 0; i < pf->bl; i++)
@@ -75,6 +236,12 @@ double fir_filter( double x, pFIR_FILTER pf )
     double *pi;
     double sum = 0.0;
 
+    if (pf->nfft > 0)
+    {
+        fir_fft_array(&x, pf, &sum, 1);
+        return (sum);
+    }
+
     assert(pf->input != NULL);
 
     pc = pf->b;
@@ -111,6 +278,18 @@ void fir_filter_array( double *in, pFIR_FILTER pf, double *out, unsigned long l
 {
     unsigned long i;
 
+    if (pf->nfft > 0)
+    {
+        fir_fft_array(in, pf, out, l);
+#ifdef DEBUG
+        for (i = 0; i < l; i++)
+        {
+            debugSample(out[i]);
+        }
+#endif
+        return;
+    }
+
     for (i = 0; i < l; i++)
     {
         *out = fir_filter(*in++, pf);
@@ -123,6 +302,12 @@ void fir_filter_array( double *in, pFIR_FILTER pf, double *out, unsigned long l
 
 void cleanup_fir_filter( pFIR_FILTER pf )
 {
+    if (pf->nfft > 0)
+    {
+        cleanup_fir_fft(pf);
+        return;
+    }
+
     assert(pf->input != NULL);
 
     free(pf->input);
@@ -32,12 +32,26 @@
 #ifndef __FIR_FILTER_H__
 #define __FIR_FILTER_H__
 
+/* Filters with at least this many taps are run as an FFT overlap-save convolution */
+#define FIR_FFT_MIN_TAPS (64)
+
 typedef struct
 {
 	double *input;
 	const double *b;
 	int bl;
 	double *new;
+	/* overlap-save state, nfft is 0 when the filter runs in direct form */
+	int nfft;		/* transform size */
+	int hop;		/* new samples per transform, nfft - bl + 1 */
+	int fill;		/* samples of the current hop already filtered */
+	int lg;			/* log2(nfft) */
+	void *fwd;		/* forward and inverse plans held from the SATS_fft cache */
+	void *inv;
+	void *H;		/* spectrum of the taps, scaled by 1/nfft */
+	void *X;		/* spectrum of the current frame */
+	double *frame;	/* bl - 1 inputs of history followed by the current hop */
+	double *y;		/* circular convolution of frame */
 } FIR_FILTER, *pFIR_FILTER;
 
 
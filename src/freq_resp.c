@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	freq_resp.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	freq_resp.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <math.h>
@@ -39,15 +39,14 @@
 #include "parse_args.h"
 #include "Utilities.h"
 #include "debug.h"
-
-extern void print_usage( void );
 
-char *chart = "title, Frequency Response,\nxlabel, Frequency (Hz),\nylabel, Amplitude (dBFS)\nxlog,\n";
+extern void print_usage( void );
 
-fstruct fst;
+char *chart = "title, Frequency Response,\nxlabel, Frequency (Hz),\nylabel, Amplitude (dBFS)\nxlog,\n";
 
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res;
     int startCh, endCh; 
     int ch; 
@@ -70,6 +69,7 @@ int main( int argc, char *argv[] )
 
     debugInit();
     fio_init(&fst, "freq_resp", "Frequency", "Amplitude", NULL);
+    fio_windowed(&fst);
 
     for (ch = startCh; ch < endCh; ch++)
     {
@@ -92,13 +92,21 @@ void print_usage( void )
     fprintf(stderr, "Frequency Response Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: freq_resp [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: freq_resp [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multichannel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf(stderr, "-c a                for all channels\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
+    fprintf(stderr, "-j <threads>,       measure the dwells on this many threads (default 1)\n");
+    fprintf(stderr, "-dwells <file>,     take the dwells from a map file saved by an earlier run of\n");
+    fprintf(stderr, "                    thd_vs_freq or freq_resp on the same input, or save them there\n");
+    fprintf(stderr, "                    (a file that isn't a map of this input is left as is)\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
     fprintf(stderr, "-powermin <lim>,    select dB level to which very low power values will be clipped\n");
@@ -0,0 +1,981 @@
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	iir_design.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
+;***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "iir_design.h"
+#include "dr_filters.h"
+#include "Utilities.h"
+#include "debug.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define IIR_DESIGN_THREADS 1
+#include <pthread.h>
+#elif defined(_WIN32)
+#define IIR_DESIGN_SRWLOCK 1
+#include <windows.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* What the tables were designed for, in Hz.  The notch bandwidths are those of the
+ * 48 kHz tables (0.002 and 0.0221317704915428 of Nyquist); the 32 and 44.1 kHz tables
+ * keep the same fraction of Nyquist, which a designed rate doesn't.
+ */
+#define DR_NOTCH_HZ         200.0
+#define DR_NOTCH_BW         48.0
+#define DR_NOTCHES          3
+#define TA_NOTCH_HZ         4000.0
+#define TA_NOTCH_BW         (0.0221317704915428 * 24000.0)
+#define TA_NOTCHES          4
+#define TA_BP_LO_HZ         3900.0
+#define TA_BP_HI_HZ         4100.0
+#define TA_BP_ORDER         4           /* of the low-pass prototype, the band-pass is twice that */
+#define TA_BP_RP            1.0
+#define TA_BP_RS            120.0
+#define LP_PASS_HZ          20100.0
+#define LP_STOP_HZ          21000.0     /* the 48 kHz table gets to 120 dB at 20.94 kHz */
+#define LP_RP               0.1
+#define LP_RS               120.0
+#define LP_ORDER_MIN        12          /* the 44.1 and 48 kHz tables */
+#define LP_ORDER_MAX        32
+#define CCIR_REF_HZ         1000.0
+#define CCIR_FIT_LO_HZ      20.0
+#define CCIR_FIT_TOP        0.95        /* of Nyquist */
+#define CCIR_FIT_POINTS     100
+#define CCIR_FIT_ITER       20
+#define CCIR_FIT_PARAMS     6           /* two per section */
+#define DR_CHECK_MID_HZ     10000.0     /* see iir_check_dr() */
+#define DR_CHECK_MID_DB     0.5
+#define DR_CHECK_TOP_DB     3.5
+
+/* Poles of the CCIR-468 weighting network in rad/s, from the polynomials of ITU-R
+ * BS.468-4; its one zero is at s = 0.  The two real poles share a section. */
+static const double ccir468_poles[3][2] = {
+    { -25903.701047816874, -62675.17005846786 },    /* real, real */
+    { -23615.53521363498, 36379.90893732908 },      /* re, im of a conjugate pair */
+    { -18743.746690721426, 62460.15645250662 }
+};
+
+#define IIR_SECTIONS_MAX    64
+#define IIR_LANDEN_MAX      16
+#define IIR_CACHE_MAX       64
+
+typedef struct
+{
+    int nsec;
+    int bl[IIR_SECTIONS_MAX];
+    double b[IIR_SECTIONS_MAX][3];
+    double a[IIR_SECTIONS_MAX][3];
+} iir_sections;
+
+enum { IIR_DR, IIR_TA_STOP, IIR_TA_PASS, IIR_LP };
+
+/*-- Complex arithmetic (no C99 complex with MSVC) --*/
+
+typedef struct
+{
+    double re;
+    double im;
+} iir_cplx;
+
+static iir_cplx c_make( double re, double im )
+{
+    iir_cplx c;
+
+    c.re = re;
+    c.im = im;
+    return (c);
+}
+
+static iir_cplx c_mul( iir_cplx x, iir_cplx y )
+{
+    return (c_make(x.re * y.re - x.im * y.im, x.re * y.im + x.im * y.re));
+}
+
+static iir_cplx c_div( iir_cplx x, iir_cplx y )
+{
+    double d = y.re * y.re + y.im * y.im;
+
+    return (c_make((x.re * y.re + x.im * y.im) / d, (x.im * y.re - x.re * y.im) / d));
+}
+
+static iir_cplx c_sqrt( iir_cplx x )
+{
+    double m = hypot(x.re, x.im);
+    double re = sqrt(0.5 * (m + x.re));
+    double im = sqrt(0.5 * (m - x.re));
+
+    return (c_make(re, (x.im < 0.0) ? -im : im));
+}
+
+/*-- Jacobi elliptic functions, by Landen transformations (after S. J. Orfanidis,
+ *   "Lecture notes on elliptic filter design").  Arguments are in units of the
+ *   quarter period K, and the complementary modulus is passed along so that moduli
+ *   close to 1 keep their precision. --*/
+
+/* Descending Landen sequence of moduli, until they are negligible */
+static int landen( double k, double kp, double v[IIR_LANDEN_MAX] )
+{
+    int n = 0;
+
+    while (k > 1e-15 && n < IIR_LANDEN_MAX)
+    {
+        k = k / (1.0 + kp);
+        k = k * k;
+        kp = 2.0 * sqrt(kp) / (1.0 + kp);
+        v[n++] = k;
+    }
+    return (n);
+}
+
+/* Ascending Landen transformation, from w = sin(u*pi/2) or cos(u*pi/2) to sn or cd */
+static iir_cplx landen_up( iir_cplx w, const double v[], int n )
+{
+    iir_cplx one_v, den;
+
+    while (n-- > 0)
+    {
+        one_v = c_make(1.0 + v[n], 0.0);
+        den = c_mul(w, w);
+        den = c_make(1.0 + v[n] * den.re, v[n] * den.im);
+        w = c_div(c_mul(one_v, w), den);
+    }
+    return (w);
+}
+
+/* cd(u*K, k) */
+static iir_cplx cde( iir_cplx u, double k, double kp )
+{
+    double v[IIR_LANDEN_MAX];
+    int n = landen(k, kp, v);
+    double a = u.re * M_PI / 2.0, b = u.im * M_PI / 2.0;
+
+    return (landen_up(c_make(cos(a) * cosh(b), -sin(a) * sinh(b)), v, n));
+}
+
+/* sn(u*K, k) */
+static iir_cplx sne( iir_cplx u, double k, double kp )
+{
+    double v[IIR_LANDEN_MAX];
+    int n = landen(k, kp, v);
+    double a = u.re * M_PI / 2.0, b = u.im * M_PI / 2.0;
+
+    return (landen_up(c_make(sin(a) * cosh(b), cos(a) * sinh(b)), v, n));
+}
+
+/* u such that sn(j*u*K, k) = j*y */
+static double asne_imag( double y, double k, double kp )
+{
+    double v[IIR_LANDEN_MAX];
+    int n = landen(k, kp, v);
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        double v1 = (i == 0) ? k : v[i - 1];
+
+        y = y / (1.0 + sqrt(1.0 + y * y * v1 * v1)) * 2.0 / (1.0 + v[i]);
+    }
+    return (2.0 / M_PI * log(y + sqrt(y * y + 1.0)));   /* asinh() */
+}
+
+/* Selectivity k (and 1 - k^2 as kp^2) of an order "n" elliptic filter with
+ * discrimination k1 */
+static void ellipdeg( int n, double k1, double *k, double *kp )
+{
+    double k1p = sqrt(1.0 - k1 * k1);
+    double p = 1.0;
+    int i;
+
+    for (i = 1; i <= n / 2; i++)
+    {
+        p *= sne(c_make((2.0 * i - 1.0) / n, 0.0), k1p, k1).re;
+    }
+    *kp = pow(k1p, n) * pow(p, 4.0);
+    *k = sqrt(1.0 - *kp * *kp);
+}
+
+/* Analog elliptic low-pass prototype of even order "n", passband edge 1 rad/s: n/2
+ * zero frequencies wz[] (zeros at +-j*wz) and poles p[] in the upper half plane
+ * (their conjugates too).  Returns the gain at s = 0 over prod(wz^2 / |p|^2), so that
+ * H(s) = h0 * prod((s^2 + wz^2) / ((s - p)(s - p*))).  The stopband starts at 1/k. */
+static double ellip_prototype( int n, double rp, double rs, double wz[], iir_cplx p[], double *stop )
+{
+    double ep = sqrt(pow(10.0, rp / 10.0) - 1.0);
+    double es = sqrt(pow(10.0, rs / 10.0) - 1.0);
+    double k1 = ep / es;
+    double k, kp, v0, h0;
+    iir_cplx cd;
+    int i;
+
+    ellipdeg(n, k1, &k, &kp);
+    v0 = asne_imag(1.0 / ep, k1, sqrt(1.0 - k1 * k1)) / n;
+
+    h0 = 1.0 / sqrt(1.0 + ep * ep);
+    for (i = 0; i < n / 2; i++)
+    {
+        double ui = (2.0 * (i + 1) - 1.0) / n;
+
+        wz[i] = 1.0 / (k * cde(c_make(ui, 0.0), k, kp).re);
+        cd = cde(c_make(ui, -v0), k, kp);
+        p[i] = c_make(-cd.im, cd.re);                       /* j * cd */
+        if (p[i].im < 0.0)
+        {
+            p[i].im = -p[i].im;
+        }
+        h0 *= (p[i].re * p[i].re + p[i].im * p[i].im) / (wz[i] * wz[i]);
+    }
+    *stop = 1.0 / k;
+
+    return (h0);
+}
+
+/*-- Section lists --*/
+
+static int push_gain( iir_sections *s, double g )
+{
+    if (s->nsec == IIR_SECTIONS_MAX)
+    {
+        return (-1);
+    }
+    s->bl[s->nsec] = 1;
+    s->b[s->nsec][0] = g;
+    s->b[s->nsec][1] = s->b[s->nsec][2] = 0.0;
+    s->a[s->nsec][0] = 1.0;
+    s->a[s->nsec][1] = s->a[s->nsec][2] = 0.0;
+    s->nsec++;
+    return (0);
+}
+
+static int push_biquad( iir_sections *s, const double b[3], const double a[3] )
+{
+    int i;
+
+    if (s->nsec == IIR_SECTIONS_MAX)
+    {
+        return (-1);
+    }
+    s->bl[s->nsec] = 3;
+    for (i = 0; i < 3; i++)
+    {
+        s->b[s->nsec][i] = b[i];
+        s->a[s->nsec][i] = a[i];
+    }
+    s->nsec++;
+    return (0);
+}
+
+/* Bilinear transform, s = k (1 - 1/z) / (1 + 1/z), of the analog biquad
+ * (bs[0] s^2 + bs[1] s + bs[2]) / (as[0] s^2 + as[1] s + as[2]).  The numerator is
+ * scaled to b[0] = 1 (if it isn't 0) and the scale goes into *g. */
+static int push_bilinear( iir_sections *s, const double bs[3], const double as[3], double k, double *g )
+{
+    double b[3], a[3];
+    int i;
+
+    b[0] = bs[0] * k * k + bs[1] * k + bs[2];
+    b[1] = 2.0 * (bs[2] - bs[0] * k * k);
+    b[2] = bs[0] * k * k - bs[1] * k + bs[2];
+    a[0] = as[0] * k * k + as[1] * k + as[2];
+    a[1] = 2.0 * (as[2] - as[0] * k * k);
+    a[2] = as[0] * k * k - as[1] * k + as[2];
+
+    *g *= ((b[0] != 0.0) ? b[0] : 1.0) / a[0];
+    for (i = 2; i >= 0; i--)
+    {
+        b[i] /= (b[0] != 0.0) ? b[0] : 1.0;
+        a[i] /= a[0];
+    }
+    return (push_biquad(s, b, a));
+}
+
+/* |H| of sections "from" to the end at "f" Hz */
+static double sections_gain( const iir_sections *s, int from, double f, int fs )
+{
+    double w = 2.0 * M_PI * f / fs;
+    iir_cplx z1 = c_make(cos(w), -sin(w));          /* 1/z */
+    iir_cplx z2 = c_mul(z1, z1);
+    iir_cplx h = c_make(1.0, 0.0);
+    iir_cplx nb, na;
+    int i;
+
+    for (i = from; i < s->nsec; i++)
+    {
+        if (s->bl[i] == 1)
+        {
+            h = c_make(h.re * s->b[i][0], h.im * s->b[i][0]);
+        }
+        else
+        {
+            nb = c_make(s->b[i][0] + s->b[i][1] * z1.re + s->b[i][2] * z2.re, s->b[i][1] * z1.im + s->b[i][2] * z2.im);
+            na = c_make(s->a[i][0] + s->a[i][1] * z1.re + s->a[i][2] * z2.re, s->a[i][1] * z1.im + s->a[i][2] * z2.im);
+            h = c_mul(h, c_div(nb, na));
+        }
+    }
+    return (hypot(h.re, h.im));
+}
+
+/*-- The filters --*/
+
+/* iirnotch(): "count" identical notches at f0 Hz, bandwidth bw Hz.  With "split", the
+ * gain of each goes into a gain section in front, as in the THD+N tables. */
+static int push_notch( iir_sections *s, double f0, double bw, int fs, int count, int split )
+{
+    double w0 = 2.0 * M_PI * f0 / fs;
+    double g = 1.0 / (1.0 + tan(M_PI * bw / fs));
+    double b[3], a[3];
+    int i;
+
+    a[0] = 1.0;
+    a[1] = -2.0 * g * cos(w0);
+    a[2] = 2.0 * g - 1.0;
+    b[0] = split ? 1.0 : g;
+    b[1] = -2.0 * cos(w0) * b[0];
+    b[2] = b[0];
+
+    if (split && push_gain(s, pow(g, count)) != 0)
+    {
+        return (-1);
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (push_biquad(s, b, a) != 0)
+        {
+            return (-1);
+        }
+    }
+    return (0);
+}
+
+/* The 20 kHz elliptic low-pass, of the lowest order whose stopband edge is no higher
+ * than LP_STOP_HZ once through the bilinear transform.  Returns 1 if "fs" has no room
+ * for it (nothing is added). */
+static int push_lowpass( iir_sections *s, int fs )
+{
+    double k = 2.0 * fs;
+    double wp = k * tan(M_PI * LP_PASS_HZ / fs);
+    double wz[LP_ORDER_MAX / 2];
+    iir_cplx p[LP_ORDER_MAX / 2];
+    double h0 = 0.0, stop, g;
+    double bs[3], as[3];
+    int n, i, gsec;
+
+    if (fs <= 2.0 * LP_STOP_HZ)
+    {
+        return (1);
+    }
+    for (n = LP_ORDER_MIN; n <= LP_ORDER_MAX; n += 2)
+    {
+        h0 = ellip_prototype(n, LP_RP, LP_RS, wz, p, &stop);
+        if (fs / M_PI * atan(wp * stop / k) <= LP_STOP_HZ)
+        {
+            break;
+        }
+    }
+    if (n > LP_ORDER_MAX)
+    {
+        return (1);
+    }
+
+    gsec = s->nsec;
+    if (push_gain(s, 1.0) != 0)
+    {
+        return (-1);
+    }
+    g = h0;
+    for (i = 0; i < n / 2; i++)
+    {
+        bs[0] = 1.0;
+        bs[1] = 0.0;
+        bs[2] = wz[i] * wp * wz[i] * wp;
+        as[0] = 1.0;
+        as[1] = -2.0 * p[i].re * wp;
+        as[2] = (p[i].re * p[i].re + p[i].im * p[i].im) * wp * wp;
+        if (push_bilinear(s, bs, as, k, &g) != 0)
+        {
+            return (-1);
+        }
+    }
+    s->b[gsec][0] = g;
+
+    return (0);
+}
+
+/* The 3.9-4.1 kHz elliptic band-pass: the low-pass prototype moved to the band by
+ * s -> (s^2 + w0^2) / (B s), both band edges prewarped.  Each prototype section turns
+ * into two, the zeros of the higher one with the poles of the higher one. */
+static int push_bandpass( iir_sections *s, int fs )
+{
+    double k = 2.0 * fs;
+    double w1 = k * tan(M_PI * TA_BP_LO_HZ / fs);
+    double w2 = k * tan(M_PI * TA_BP_HI_HZ / fs);
+    double w0sq = w1 * w2, bw = w2 - w1;
+    double wz[TA_BP_ORDER / 2];
+    iir_cplx p[TA_BP_ORDER / 2];
+    iir_cplx pb, d, r[2];
+    double stop, g, h0, zr, zd;
+    double bs[3], as[3];
+    int i, j, gsec;
+
+    h0 = ellip_prototype(TA_BP_ORDER, TA_BP_RP, TA_BP_RS, wz, p, &stop);
+
+    gsec = s->nsec;
+    if (push_gain(s, 1.0) != 0)
+    {
+        return (-1);
+    }
+    g = h0;
+    for (i = 0; i < TA_BP_ORDER / 2; i++)
+    {
+        /* roots of s^2 - p B s + w0^2 */
+        pb = c_make(p[i].re * bw, p[i].im * bw);
+        d = c_sqrt(c_make(pb.re * pb.re - pb.im * pb.im - 4.0 * w0sq, 2.0 * pb.re * pb.im));
+        r[0] = c_make((pb.re + d.re) / 2.0, (pb.im + d.im) / 2.0);
+        r[1] = c_make((pb.re - d.re) / 2.0, (pb.im - d.im) / 2.0);
+        if (fabs(r[0].im) < fabs(r[1].im))
+        {
+            iir_cplx t = r[0];
+
+            r[0] = r[1];
+            r[1] = t;
+        }
+        /* zeros at +-j (wz B +- sqrt(wz^2 B^2 + 4 w0^2)) / 2 */
+        zr = wz[i] * bw / 2.0;
+        zd = sqrt(zr * zr + w0sq);
+        for (j = 0; j < 2; j++)
+        {
+            double wzj = (j == 0) ? zr + zd : zd - zr;
+
+            bs[0] = 1.0;
+            bs[1] = 0.0;
+            bs[2] = wzj * wzj;
+            as[0] = 1.0;
+            as[1] = -2.0 * r[j].re;
+            as[2] = r[j].re * r[j].re + r[j].im * r[j].im;
+            if (push_bilinear(s, bs, as, k, &g) != 0)
+            {
+                return (-1);
+            }
+        }
+    }
+    s->b[gsec][0] = g;
+
+    return (0);
+}
+
+/* |p[0] + p[1]/z + p[2]/z^2|^2 on the unit circle, as a function of phi = sin^2(w/2)
+ * (M. Vicanek, "Matched second order digital filters") */
+static double quad_power( const double p[3], double phi )
+{
+    double lo = p[0] + p[1] + p[2];
+    double hi = p[0] - p[1] + p[2];
+
+    return (lo * lo * (1.0 - phi) + hi * hi * phi - 16.0 * p[0] * p[2] * phi * (1.0 - phi));
+}
+
+/* The numerator with |b|^2 = B[0] (1 - phi) + B[1] phi + 4 B[2] phi (1 - phi) */
+static void quad_from_power( const double B[3], double b[3] )
+{
+    double r0 = sqrt(max_d(B[0], 0.0));
+    double r1 = sqrt(max_d(B[1], 0.0));
+    double w = (r0 + r1) / 2.0;
+
+    b[0] = (w + sqrt(max_d(w * w + B[2], 0.0))) / 2.0;
+    b[1] = (r0 - r1) / 2.0;
+    b[2] = (b[0] != 0.0) ? -B[2] / (4.0 * b[0]) : 0.0;
+}
+
+/* |H|^2 of analog CCIR-468 section "i" at "w" rad/s */
+static double ccir468_power( int i, double w )
+{
+    double re = ccir468_poles[i][0];
+    double im = ccir468_poles[i][1];
+
+    if (i == 0)
+    {
+        return (w * w / ((w * w + re * re) * (w * w + im * im)));
+    }
+    return (1.0 / ((re * re + (w - im) * (w - im)) * (re * re + (w + im) * (w + im))));
+}
+
+/* Gaussian elimination with partial pivoting: m x = v for the n x n row-major "m",
+ * x into "v".  Returns -1 if "m" is singular. */
+static int solve( double *m, double *v, int n )
+{
+    double t;
+    int i, j, k, p;
+
+    for (k = 0; k < n; k++)
+    {
+        p = k;
+        for (i = k + 1; i < n; i++)
+        {
+            if (fabs(m[i * n + k]) > fabs(m[p * n + k]))
+            {
+                p = i;
+            }
+        }
+        if (m[p * n + k] == 0.0)
+        {
+            return (-1);
+        }
+        for (j = 0; j < n; j++)
+        {
+            t = m[k * n + j];
+            m[k * n + j] = m[p * n + j];
+            m[p * n + j] = t;
+        }
+        t = v[k];
+        v[k] = v[p];
+        v[p] = t;
+        for (i = k + 1; i < n; i++)
+        {
+            t = m[i * n + k] / m[k * n + k];
+            for (j = k; j < n; j++)
+            {
+                m[i * n + j] -= t * m[k * n + j];
+            }
+            v[i] -= t * v[k];
+        }
+    }
+    for (k = n - 1; k >= 0; k--)
+    {
+        for (j = k + 1; j < n; j++)
+        {
+            v[k] -= m[k * n + j] * v[j];
+        }
+        v[k] /= m[k * n + k];
+    }
+    return (0);
+}
+
+/* Sum of squared log errors of the numerators "x" against "ly" (-1 if a numerator
+ * goes negative somewhere) */
+static double ccir468_cost( const double B0[3], const double x[CCIR_FIT_PARAMS], const double phi[], const double ly[] )
+{
+    double cost = 0.0, q, e;
+    int i, k;
+
+    for (k = 0; k < CCIR_FIT_POINTS; k++)
+    {
+        e = -ly[k];
+        for (i = 0; i < 3; i++)
+        {
+            q = B0[i] * (1.0 - phi[k]) + x[2 * i] * phi[k] + x[2 * i + 1] * 4.0 * phi[k] * (1.0 - phi[k]);
+            if (q <= 0.0)
+            {
+                return (-1.0);
+            }
+            e += log(q);
+        }
+        cost += e * e;
+    }
+    return (cost);
+}
+
+/* CCIR-468 weighting, scaled to 0 dB at 1 kHz.  The bilinear transform squeezes the
+ * top of the curve into the last few kHz below Nyquist (a 48 kHz design prewarped at
+ * 6.3 kHz is 16 dB low at 15 kHz), so instead the poles are mapped by z = e^(sT) and the
+ * numerators are fitted to the analog magnitude.  Each section's |b|^2 is linear in three
+ * coefficients of phi = sin^2(w/2) (see quad_power()): the one at DC is the analog
+ * section's, the other two start from a least squares fit of the section on its own and
+ * are then refined together, Levenberg-Marquardt on the log of the whole cascade, over
+ * CCIR_FIT_POINTS from 20 Hz to 0.95 of Nyquist.  The result is within 0.2 dB of
+ * BS.468 over that range at every rate from 16 to 384 kHz.
+ */
+static int push_ccir468( iir_sections *s, int fs )
+{
+    double wk[CCIR_FIT_POINTS], phi[CCIR_FIT_POINTS], ly[CCIR_FIT_POINTS];
+    double a[3][3], B0[3], B[3], b[3];
+    double x[CCIR_FIT_PARAMS], xn[CCIR_FIT_PARAMS];
+    double h[CCIR_FIT_PARAMS * CCIR_FIT_PARAMS], g[CCIR_FIT_PARAMS];
+    double m[CCIR_FIT_PARAMS * CCIR_FIT_PARAMS], v[CCIR_FIT_PARAMS];
+    double t = 1.0 / fs, wr = 2.0 * M_PI * CCIR_REF_HZ;
+    double f, u1, u2, y, q, e, cost, ncost, lambda = 1e-3;
+    int i, j, k, it, gsec;
+
+    /* poles */
+    for (i = 0; i < 3; i++)
+    {
+        a[i][0] = 1.0;
+        if (i == 0)
+        {
+            a[i][1] = -(exp(ccir468_poles[0][0] * t) + exp(ccir468_poles[0][1] * t));
+            a[i][2] = exp((ccir468_poles[0][0] + ccir468_poles[0][1]) * t);
+        }
+        else
+        {
+            a[i][1] = -2.0 * exp(ccir468_poles[i][0] * t) * cos(ccir468_poles[i][1] * t);
+            a[i][2] = exp(2.0 * ccir468_poles[i][0] * t);
+        }
+        B0[i] = (i == 0) ? 0.0 : ccir468_power(i, 0.0) / ccir468_power(i, wr) * quad_power(a[i], 0.0);
+    }
+
+    /* the points, and the log of what the whole cascade's |b|^2 should come to there */
+    for (k = 0; k < CCIR_FIT_POINTS; k++)
+    {
+        f = CCIR_FIT_LO_HZ * pow(CCIR_FIT_TOP * fs / 2.0 / CCIR_FIT_LO_HZ, k / (CCIR_FIT_POINTS - 1.0));
+        wk[k] = 2.0 * M_PI * f;
+        phi[k] = sin(M_PI * f / fs) * sin(M_PI * f / fs);
+        ly[k] = 0.0;
+        for (i = 0; i < 3; i++)
+        {
+            ly[k] += log(ccir468_power(i, wk[k]) / ccir468_power(i, wr) * quad_power(a[i], phi[k]));
+        }
+    }
+
+    /* each section on its own: weighted least squares for the two free coefficients */
+    for (i = 0; i < 3; i++)
+    {
+        m[0] = m[1] = m[3] = v[0] = v[1] = 0.0;
+        for (k = 0; k < CCIR_FIT_POINTS; k++)
+        {
+            y = ccir468_power(i, wk[k]) / ccir468_power(i, wr) * quad_power(a[i], phi[k]);
+            u1 = phi[k] / y;
+            u2 = 4.0 * phi[k] * (1.0 - phi[k]) / y;
+            e = 1.0 - B0[i] * (1.0 - phi[k]) / y;
+            m[0] += u1 * u1;
+            m[1] += u1 * u2;
+            m[3] += u2 * u2;
+            v[0] += u1 * e;
+            v[1] += u2 * e;
+        }
+        m[2] = m[1];
+        if (solve(m, v, 2) != 0)
+        {
+            return (-1);
+        }
+        x[2 * i] = v[0];
+        x[2 * i + 1] = v[1];
+    }
+
+    /* then all of them together */
+    cost = ccir468_cost(B0, x, phi, ly);
+    for (it = 0; it < CCIR_FIT_ITER && cost > 0.0; it++)
+    {
+        for (j = 0; j < CCIR_FIT_PARAMS * CCIR_FIT_PARAMS; j++)
+        {
+            h[j] = 0.0;
+        }
+        for (j = 0; j < CCIR_FIT_PARAMS; j++)
+        {
+            g[j] = 0.0;
+        }
+        for (k = 0; k < CCIR_FIT_POINTS; k++)
+        {
+            double jr[CCIR_FIT_PARAMS];
+
+            e = -ly[k];
+            for (i = 0; i < 3; i++)
+            {
+                q = B0[i] * (1.0 - phi[k]) + x[2 * i] * phi[k] + x[2 * i + 1] * 4.0 * phi[k] * (1.0 - phi[k]);
+                e += log(q);
+                jr[2 * i] = phi[k] / q;
+                jr[2 * i + 1] = 4.0 * phi[k] * (1.0 - phi[k]) / q;
+            }
+            for (i = 0; i < CCIR_FIT_PARAMS; i++)
+            {
+                g[i] -= jr[i] * e;
+                for (j = 0; j < CCIR_FIT_PARAMS; j++)
+                {
+                    h[i * CCIR_FIT_PARAMS + j] += jr[i] * jr[j];
+                }
+            }
+        }
+        /* raise the damping until the step improves the fit */
+        for (ncost = -1.0; lambda < 1e8; lambda *= 10.0)
+        {
+            for (j = 0; j < CCIR_FIT_PARAMS * CCIR_FIT_PARAMS; j++)
+            {
+                m[j] = h[j];
+            }
+            for (j = 0; j < CCIR_FIT_PARAMS; j++)
+            {
+                m[j * CCIR_FIT_PARAMS + j] *= 1.0 + lambda;
+                v[j] = g[j];
+            }
+            if (solve(m, v, CCIR_FIT_PARAMS) == 0)
+            {
+                for (j = 0; j < CCIR_FIT_PARAMS; j++)
+                {
+                    xn[j] = x[j] + v[j];
+                }
+                ncost = ccir468_cost(B0, xn, phi, ly);
+                if (ncost >= 0.0 && ncost < cost)
+                {
+                    break;
+                }
+            }
+        }
+        if (lambda >= 1e8)
+        {
+            break;
+        }
+        for (j = 0; j < CCIR_FIT_PARAMS; j++)
+        {
+            x[j] = xn[j];
+        }
+        cost = ncost;
+        lambda /= 10.0;
+    }
+
+    gsec = s->nsec;
+    if (push_gain(s, 1.0) != 0)
+    {
+        return (-1);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        B[0] = B0[i];
+        B[1] = x[2 * i];
+        B[2] = x[2 * i + 1];
+        quad_from_power(B, b);
+        if (push_biquad(s, b, a[i]) != 0)
+        {
+            return (-1);
+        }
+    }
+    s->b[gsec][0] = 1.0 / sections_gain(s, gsec, CCIR_REF_HZ, fs);
+
+    return (0);
+}
+
+static int design( iir_sections *s, int kind, int fs )
+{
+    s->nsec = 0;
+
+    switch (kind)
+    {
+        case IIR_DR:
+            if (push_notch(s, DR_NOTCH_HZ, DR_NOTCH_BW, fs, DR_NOTCHES, 0) != 0 ||
+                push_lowpass(s, fs) < 0 ||
+                push_ccir468(s, fs) != 0)
+            {
+                return (-1);
+            }
+            break;
+        case IIR_TA_STOP:
+        case IIR_TA_PASS:
+            if ((kind == IIR_TA_STOP ? push_notch(s, TA_NOTCH_HZ, TA_NOTCH_BW, fs, TA_NOTCHES, 1) : push_bandpass(s, fs)) != 0 ||
+                push_lowpass(s, fs) < 0)
+            {
+                return (-1);
+            }
+            break;
+        default:
+            if (push_lowpass(s, fs) != 0)
+            {
+                return (-1);
+            }
+            break;
+    }
+    return (0);
+}
+
+#ifndef NDEBUG
+/* Debug builds hold the 48 kHz design of the dynamic range cascade against dr_48000 at
+ * the third octaves from 20 Hz to 20 kHz: within DR_CHECK_MID_DB up to 10 kHz and
+ * DR_CHECK_TOP_DB above, where the table itself is up to 3.2 dB over BS.468.
+ * Returns 1 if it is.
+ */
+static int iir_check_dr( void )
+{
+    iir_sections s, t;
+    double f, d;
+    int i, k;
+
+    if (design(&s, IIR_DR, 48000) != 0)
+    {
+        return (0);
+    }
+    t.nsec = dr_48000.nsec;
+    for (i = 0; i < t.nsec; i++)
+    {
+        t.bl[i] = dr_48000.bl[i];
+        for (k = 0; k < 3; k++)
+        {
+            t.b[i][k] = dr_48000.b[i][k];
+            t.a[i][k] = dr_48000.a[i][k];
+        }
+    }
+    for (k = -17; k <= 13; k++)
+    {
+        f = 1000.0 * pow(10.0, k / 10.0);
+        d = 20.0 * log10(sections_gain(&s, 0, f, 48000) / sections_gain(&t, 0, f, 48000));
+        if (fabs(d) > ((f <= DR_CHECK_MID_HZ) ? DR_CHECK_MID_DB : DR_CHECK_TOP_DB))
+        {
+            error("designed weighting is %.2f dB off dr_48000 at %.0f Hz\n", d, f);
+            return (0);
+        }
+    }
+    return (1);
+}
+#endif
+
+/*-- Cache of designs, one per filter and rate --*/
+
+typedef struct
+{
+    int kind;
+    int fs;
+    pSOS_FILTER pf;
+} iir_cached;
+
+static iir_cached iir_cache[IIR_CACHE_MAX];
+static int iir_cache_count = 0;
+
+#ifdef IIR_DESIGN_THREADS
+static pthread_mutex_t iir_lock = PTHREAD_MUTEX_INITIALIZER;
+#define IIR_LOCK()      pthread_mutex_lock(&iir_lock)
+#define IIR_UNLOCK()    pthread_mutex_unlock(&iir_lock)
+#elif defined(IIR_DESIGN_SRWLOCK)
+static SRWLOCK iir_lock = SRWLOCK_INIT;
+#define IIR_LOCK()      AcquireSRWLockExclusive(&iir_lock)
+#define IIR_UNLOCK()    ReleaseSRWLockExclusive(&iir_lock)
+#else
+#define IIR_LOCK()
+#define IIR_UNLOCK()
+#endif
+
+static void iir_filter_free( pSOS_FILTER pf )
+{
+    free(pf->bl);
+    free(pf->al);
+    free(pf->b);
+    free(pf->a);
+    free(pf);
+}
+
+static void iir_cache_free( void )
+{
+    int i;
+
+    IIR_LOCK();
+    for (i = 0; i < iir_cache_count; i++)
+    {
+        iir_filter_free(iir_cache[i].pf);
+    }
+    iir_cache_count = 0;
+    IIR_UNLOCK();
+}
+
+static pSOS_FILTER iir_filter_new( const iir_sections *s )
+{
+    pSOS_FILTER pf = (pSOS_FILTER) calloc(1, sizeof(SOS_FILTER));
+    int i;
+
+    if (pf == NULL)
+    {
+        return (NULL);
+    }
+    pf->nsec = s->nsec;
+    pf->bl = (int *) malloc(s->nsec * sizeof(int));
+    pf->al = (int *) malloc(s->nsec * sizeof(int));
+    pf->b = (double (*)[3]) malloc(s->nsec * sizeof(*pf->b));
+    pf->a = (double (*)[3]) malloc(s->nsec * sizeof(*pf->a));
+    if (pf->bl == NULL || pf->al == NULL || pf->b == NULL || pf->a == NULL)
+    {
+        iir_filter_free(pf);
+        return (NULL);
+    }
+    for (i = 0; i < s->nsec; i++)
+    {
+        pf->bl[i] = pf->al[i] = s->bl[i];
+        pf->b[i][0] = s->b[i][0];
+        pf->b[i][1] = s->b[i][1];
+        pf->b[i][2] = s->b[i][2];
+        pf->a[i][0] = s->a[i][0];
+        pf->a[i][1] = s->a[i][1];
+        pf->a[i][2] = s->a[i][2];
+    }
+    return (pf);
+}
+
+static const SOS_FILTER *iir_design( int kind, int fs )
+{
+    iir_sections s;
+    pSOS_FILTER pf = NULL;
+    int i;
+
+    if (fs < IIR_FS_MIN || fs > IIR_FS_MAX)
+    {
+        return (NULL);
+    }
+
+    IIR_LOCK();
+    for (i = 0; i < iir_cache_count; i++)
+    {
+        if (iir_cache[i].kind == kind && iir_cache[i].fs == fs)
+        {
+            pf = iir_cache[i].pf;
+            break;
+        }
+    }
+    if (pf == NULL && iir_cache_count < IIR_CACHE_MAX && design(&s, kind, fs) == 0)
+    {
+        assert(kind != IIR_DR || iir_check_dr());
+        pf = iir_filter_new(&s);
+        if (pf != NULL)
+        {
+            if (iir_cache_count == 0)
+            {
+                atexit(iir_cache_free);
+            }
+            iir_cache[iir_cache_count].kind = kind;
+            iir_cache[iir_cache_count].fs = fs;
+            iir_cache[iir_cache_count].pf = pf;
+            iir_cache_count++;
+        }
+    }
+    IIR_UNLOCK();
+
+    return (pf);
+}
+
+const SOS_FILTER *iir_design_dr( int fs )
+{
+    return (iir_design(IIR_DR, fs));
+}
+
+const SOS_FILTER *iir_design_ta( int fs, int stop )
+{
+    return (iir_design(stop ? IIR_TA_STOP : IIR_TA_PASS, fs));
+}
+
+const SOS_FILTER *iir_design_lp( int fs )
+{
+    return (iir_design(IIR_LP, fs));
+}
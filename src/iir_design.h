@@ -0,0 +1,62 @@
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	iir_design.h
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
+;***************************************************************************/
+
+#ifndef __IIR_DESIGN_H__
+#define __IIR_DESIGN_H__
+
+#include "sos_filter.h"
+
+/* Sample rates the measurement filters can be designed for */
+#define IIR_FS_MIN  16000
+#define IIR_FS_MAX  384000
+
+/* The measurement filters worked out at run time for sample rates without coefficient
+ * tables: the analog responses the 48 kHz tables stand for, mapped to "fs" with the
+ * bilinear transform, prewarped at the frequencies that matter, except for the CCIR-468
+ * weighting, whose poles are mapped by z = e^(sT) and whose zeros are fitted to the
+ * analog magnitude up to 0.95 of Nyquist (within 0.2 dB).  A design is made once
+ * per rate and kept until exit; like the tables it is a shared coefficient set without
+ * a delay line, to be run through init_sos_instance().  NULL if "fs" is out of range
+ * (or leaves no room for the filter, for iir_design_lp()).
+ */
+
+/* Dynamic range: 200 Hz notch (three times), 20 kHz low-pass where there is room for
+ * it, then the CCIR-468 weighting, 0 dB at 1 kHz */
+const SOS_FILTER *iir_design_dr( int fs );
+
+/* THD+N vs level: the 4 kHz notch (four times) when "stop", otherwise the 3.9-4.1 kHz
+ * elliptic band-pass, each followed by the 20 kHz low-pass where there is room for it */
+const SOS_FILTER *iir_design_ta( int fs, int stop );
+
+/* 20 kHz low-pass: elliptic, 0.1 dB ripple up to 20.1 kHz, 120 dB down from 21 kHz */
+const SOS_FILTER *iir_design_lp( int fs );
+
+#endif // __IIR_DESIGN_H__
@@ -104,3 +104,187 @@ real64_T lp_48000_a[LP_48000_NSEC][3] = {
   { 1,                 0,                 0 }
 };
 
+ /* 88.2kHz Sample Rate Filters */
+int lp_88200_bl[LP_88200_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_88200_b[LP_88200_NSEC][3] = {
+  { 0.0004178786638465,                 0,                 0 },
+  { 1,    1.898587111314,                 1 },
+  { 1,                 0,                 0 },
+  { 1,    1.304361732056,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   0.6970485321698,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   0.2966743982948,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  0.06465070767633,                 1 },
+  { 1,                 0,                 0 },
+  { 1, -0.06485329486491,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.1356237705176,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.1724001557942,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.1880570869196,                 1 },
+  { 1,                 0,                 0 }
+};
+int lp_88200_al[LP_88200_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_88200_a[LP_88200_NSEC][3] = {
+  { 1,                 0,                 0 },
+  { 1,   -1.264617540997,   0.4328957828577 },
+  { 1,                 0,                 0 },
+  { 1,   -1.076301393152,   0.5365753367796 },
+  { 1,                 0,                 0 },
+  { 1,  -0.8238813603814,   0.6756322915002 },
+  { 1,                 0,                 0 },
+  { 1,  -0.6089752451137,   0.7942328189974 },
+  { 1,                 0,                 0 },
+  { 1,   -0.460051696556,   0.8768455700188 },
+  { 1,                 0,                 0 },
+  { 1,   -0.367309214079,   0.9290988931364 },
+  { 1,                 0,                 0 },
+  { 1,  -0.3134398455864,   0.9609389371513 },
+  { 1,                 0,                 0 },
+  { 1,  -0.2847582993538,       0.980654842 },
+  { 1,                 0,                 0 },
+  { 1,  -0.2729767586442,   0.9941687807616 },
+  { 1,                 0,                 0 }
+};
+
+ /* 96kHz Sample Rate Filters */
+int lp_96000_bl[LP_96000_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_96000_b[LP_96000_NSEC][3] = {
+  { 0.0002436230174029,                 0,                 0 },
+  { 1,    1.872279032138,                 1 },
+  { 1,                 0,                 0 },
+  { 1,    1.157225895287,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   0.4805267942894,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  0.06144151382482,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.1723171956749,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.3000135881946,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.3689771682638,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.4045891866091,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.4197039602191,                 1 },
+  { 1,                 0,                 0 }
+};
+int lp_96000_al[LP_96000_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_96000_a[LP_96000_NSEC][3] = {
+  { 1,                 0,                 0 },
+  { 1,   -1.336710084227,   0.4750451343417 },
+  { 1,                 0,                 0 },
+  { 1,   -1.184463505311,   0.5666714582201 },
+  { 1,                 0,                 0 },
+  { 1,  -0.9754937061765,   0.6925209771702 },
+  { 1,                 0,                 0 },
+  { 1,  -0.7930140865481,   0.8026325707035 },
+  { 1,                 0,                 0 },
+  { 1,  -0.6640486219808,   0.8808940129578 },
+  { 1,                 0,                 0 },
+  { 1,   -0.582741067745,   0.9310740972698 },
+  { 1,                 0,                 0 },
+  { 1,  -0.5352953941239,   0.9619126148781 },
+  { 1,                 0,                 0 },
+  { 1,  -0.5102333515949,   0.9811069058539 },
+  { 1,                 0,                 0 },
+  { 1,  -0.5005357261975,   0.9943014108501 },
+  { 1,                 0,                 0 }
+};
+
+ /* 176.4kHz Sample Rate Filters */
+int lp_176400_bl[LP_176400_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_176400_b[LP_176400_NSEC][3] = {
+  { 1.475292069727e-05,                 0,                 0 },
+  { 1,    1.506722393439,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.1294542602453,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.8927101133596,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.201682109905,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.340905965611,                 1 },
+  { 1,                 0,                 0 },
+  { 1,    -1.40916221939,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.444007650273,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.461483032403,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.468796867093,                 1 },
+  { 1,                 0,                 0 }
+};
+int lp_176400_al[LP_176400_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_176400_a[LP_176400_NSEC][3] = {
+  { 1,                 0,                 0 },
+  { 1,   -1.658012200571,   0.6967127547681 },
+  { 1,                 0,                 0 },
+  { 1,   -1.632622173017,    0.742571366318 },
+  { 1,                 0,                 0 },
+  { 1,   -1.595370803018,   0.8099623485322 },
+  { 1,                 0,                 0 },
+  { 1,   -1.560371831224,   0.8735628455317 },
+  { 1,                 0,                 0 },
+  { 1,   -1.534222610623,   0.9216804967447 },
+  { 1,                 0,                 0 },
+  { 1,   -1.517340305056,   0.9539119778632 },
+  { 1,                 0,                 0 },
+  { 1,   -1.507836273388,    0.974282850237 },
+  { 1,                 0,                 0 },
+  { 1,   -1.503891527305,   0.9871801901065 },
+  { 1,                 0,                 0 },
+  { 1,   -1.504643695504,   0.9961279433721 },
+  { 1,                 0,                 0 }
+};
+
+ /* 192kHz Sample Rate Filters */
+int lp_192000_bl[LP_192000_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_192000_b[LP_192000_NSEC][3] = {
+  { 1.122169107948e-05,                 0,                 0 },
+  { 1,    1.421695749781,                 1 },
+  { 1,                 0,                 0 },
+  { 1,  -0.3106734443345,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.033544589099,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.312557867627,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.435852509016,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.495760075706,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.526208066319,                 1 },
+  { 1,                 0,                 0 },
+  { 1,   -1.541443810653,                 1 },
+  { 1,                 0,                 0 },
+  { 1,    -1.54781352894,                 1 },
+  { 1,                 0,                 0 }
+};
+int lp_192000_al[LP_192000_NSEC] = { 1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1 };
+real64_T lp_192000_a[LP_192000_NSEC][3] = {
+  { 1,                 0,                 0 },
+  { 1,   -1.686421888823,   0.7191199121902 },
+  { 1,                 0,                 0 },
+  { 1,   -1.668365885859,   0.7613539113862 },
+  { 1,                 0,                 0 },
+  { 1,   -1.641818740674,   0.8235711272145 },
+  { 1,                 0,                 0 },
+  { 1,   -1.616829551486,    0.882456232614 },
+  { 1,                 0,                 0 },
+  { 1,   -1.598163667399,   0.9271148074289 },
+  { 1,                 0,                 0 },
+  { 1,   -1.586188565976,   0.9570815856759 },
+  { 1,                 0,                 0 },
+  { 1,   -1.579623827393,   0.9760427070359 },
+  { 1,                 0,                 0 },
+  { 1,   -1.577264316069,   0.9880557510202 },
+  { 1,                 0,                 0 },
+  { 1,    -1.57865575323,   0.9963925747147 },
+  { 1,                 0,                 0 }
+};
+
@@ -34,5 +34,9 @@
 
 #define LP_44100_NSEC 13
 #define LP_48000_NSEC 13
+#define LP_88200_NSEC 19
+#define LP_96000_NSEC 19
+#define LP_176400_NSEC 19
+#define LP_192000_NSEC 19
 
 #endif /* __LP_COEF_H__ */
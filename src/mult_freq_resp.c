@@ -47,10 +47,9 @@ extern void print_usage( void );
 
 char *chart = "title, Multiple Tone Frequency Response,\nxlabel, Frequency (Hz),\nylabel, Amplitude (dBFS),\nxlog,\n";
 
-fstruct fst; 
-
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int startCh, endCh;
     int ch;
 	int res;
@@ -96,12 +95,16 @@ void print_usage( void )
     fprintf(stderr,"Multitone Frequency Response Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr,"Usage: mult_freq_resp [OPTION]... -f <.txt file containing list of multitone frequencies> -i WAVFILE\n\n");
+    fprintf(stderr,"Usage: mult_freq_resp [OPTION]... -f <.txt file containing list of multitone frequencies> -i WAVFILE\n");
+    fprintf(stderr,"Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr,"-c <chan>,           selects channel in multichannel file\n");
     fprintf(stderr,"                     0 = first channel\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr,"-ra,                 read ahead: decode the next block in a background thread\n");
+    fprintf(stderr,"-cache,              keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr,"                     them in later runs on the same, unchanged file\n");
     fprintf(stderr,"-t,                  selects text output mode\n");
     fprintf(stderr,"-to <name>,          create a text file\n");
     fprintf(stderr,"-f <name>,           selects file containing list of\n");
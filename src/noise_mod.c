@@ -47,9 +47,9 @@ extern void print_usage( void );
 char *chart = "title, Noise Modulation vs. Level,\nxlabel, Level (dBFS),\nylabel, Noise Modulation (dB),\n \
 xreverse,\n";
 
-fstruct fst;
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res;
     int startCh, endCh;
     int ch;
@@ -73,16 +73,28 @@ int main( int argc, char *argv[] )
 
     fio_init(&fst, "noise_mod", "Level", "Noise modulation", NULL);
 
-    for (ch = startCh; ch < endCh; ch++)
+    /* With every channel decoded up front, the channels are filtered side by side */
+    if (endCh - startCh > 1 && fio_planes_ready(&fst))
     {
-        check( fio_next_chunk(&fst, ch) );
+        res = thd_ampl_channels(&fst, 0, startCh, endCh);
+        if (res)
+        {
+            return (1);
+        }
+    }
+    else
+    {
+        for (ch = startCh; ch < endCh; ch++)
+        {
+            check( fio_next_chunk(&fst, ch) );
 
-        fio_resetpos(&fst);
-        res=thd_ampl(&fst, 0); /* thd_ampl is used to calculate the noise modulation */
-		if (res)
-		{
-			return (1);
-		}
+            fio_resetpos(&fst);
+            res=thd_ampl(&fst, 0); /* thd_ampl is used to calculate the noise modulation */
+            if (res)
+            {
+                return (1);
+            }
+        }
     }
 
     fio_cleanup(&fst);
@@ -96,13 +108,17 @@ void print_usage( void )
     fprintf(stderr, "Noise Modulation Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: noise_mod [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: noise_mod [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multi-channel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf(stderr, "                    -c a for all channels\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
 }
@@ -37,10 +37,14 @@
 #include "getparam.h"
 #include "parse_args.h"
 #include "wavelib.h"
+#include "iir_design.h"
 /*#ifdef WIN32
 #include <windows.h>
 #endif*/
 #include "debug.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
 /*the max limit of unsigned long is ULONG_MAX. Its defined in limits.h*/
 /*the max limit of double is DBL_MAX. Its defined in float.h*/
 /*the min limit of double is DBL_MIN. Its defined in float.h*/
@@ -48,6 +52,19 @@ extern void print_usage( void );
 extern void DLB_PrintGetParamError (DLB_GETPARAM_RETVAL);
 
 #define MAXPATH 400
+
+/* True if "path" names a FIFO, which is read as a stream like stdin */
+static int is_fifo( const char *path )
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st;
+
+    return (stat(path, &st) == 0 && S_ISFIFO(st.st_mode));
+#else
+    path = path;
+    return (0);
+#endif
+}
 /*Defining the various error cases incase of wrong parameter parsing*/
 void DLB_PrintGetParamError (DLB_GETPARAM_RETVAL err)
 {
@@ -132,7 +149,7 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
     FILE *OptionalInputFilep;
     struct WaveFile wf;
     short numchans;
-    int numsamps;
+    __int64 numsamps;
     int samprate;
     short bitspersamp;
     int audio_type;
@@ -141,6 +158,9 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
     //double *dp = NULL;
     //unsigned long *ulp = NULL;
 
+    /* Everything not set below starts out zero / NULL */
+    memset(fst, 0, sizeof(*fst));
+
     /*-- default values for parameter flags --*/
     fst->top = 0;
     fst->bottom = 0;
@@ -150,6 +170,10 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
     fst->dataOutputFile[0] = '\0';
     fst->binary_out = 0;
     fst->noSilence = 0;
+    fst->readAhead = 0;
+    fst->cache = 0;
+    fst->threads = 1;
+    fst->dwellMap[0] = '\0';
     fst->nfft = 0;
     fst->navg = 0;
     fst->tool = tool;
@@ -574,6 +598,76 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
       }
     }
 
+    /* parsing for the -ra (read-ahead) switch */
+    error_code = dlb_getparam_bool(hGetParam, "ra", &b_is_switch_on);
+    if (error_code != DLB_GETPARAM_UNDEFINED_PARAM)
+    {
+      if (error_code == DLB_GETPARAM_OK)
+      {
+        if (b_is_switch_on == 1)
+        {
+          fst->readAhead = 1;
+        }
+      }
+      else
+      {
+    	  error("Read-ahead parameter not defined correctly. Correct use is -ra .\n");
+      }
+    }
+
+    /* parsing for the -cache switch */
+    error_code = dlb_getparam_bool(hGetParam, "cache", &b_is_switch_on);
+    if (error_code != DLB_GETPARAM_UNDEFINED_PARAM)
+    {
+      if (error_code == DLB_GETPARAM_OK)
+      {
+        if (b_is_switch_on == 1)
+        {
+          fst->cache = 1;
+        }
+      }
+      else
+      {
+    	  error("Cache parameter not defined correctly. Correct use is -cache .\n");
+      }
+    }
+
+    /* parsing for the -j switch */
+    error_code = dlb_getparam_double(hGetParam, "j", &gp_value, 1, 64);
+    if ((strcmp(tool, "thd_vs_freq") == 0) || (strcmp(tool, "freq_resp") == 0))
+    {
+      if (error_code != DLB_GETPARAM_UNDEFINED_PARAM)
+      {
+        if (error_code == DLB_GETPARAM_OK)
+        {
+          fst->threads = (int) gp_value;
+        }
+        else
+        {
+          error("Parameter -j defined incorrectly. Correct usage is -j <threads>, from 1 to 64\n");
+          return(1);
+        }
+      }
+    }
+
+    /* parsing for the -dwells switch */
+    error_code = dlb_getparam_maxlenstring(hGetParam, "dwells", &gp_string, MAX_STRING_LEN);
+    if ((strcmp(tool, "thd_vs_freq") == 0) || (strcmp(tool, "freq_resp") == 0))
+    {
+      if (error_code != DLB_GETPARAM_UNDEFINED_PARAM)
+      {
+        if (error_code == DLB_GETPARAM_OK)
+        {
+          strcpy(fst->dwellMap, gp_string);
+        }
+        else
+        {
+          error("Parameter -dwells defined incorrectly. Correct usage is -dwells <file>\n");
+          return(1);
+        }
+      }
+    }
+
     /* parsing for the -t switch */
     error_code = dlb_getparam_bool(hGetParam, "t", &b_is_switch_on);
     if (error_code != DLB_GETPARAM_UNDEFINED_PARAM)
@@ -633,25 +727,29 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
 #endif*/
     }
 
-    fp = fopen(filein, "r");
-
-    /*-- Checking if exists or if can be opened --*/
-    if (fp == NULL)
+    /* stdin ("-i -") and FIFOs are read as streams, don't open them twice */
+    if (strcmp(filein, "-") != 0 && !is_fifo(filein))
     {
-      error("Error: Couldn't open file: %s\n\n", filein);
-      //print_usage();
-      return (-6);
-    }
+      fp = fopen(filein, "r");
 
-    /*-- Checking if file size 0 or checking if file is empty --*/
-    fseek(fp, 0, SEEK_END);
-    if (ftell(fp) < 1)
-    {
-      error("Input file empty\n");
-      return (-7);
-    }
+      /*-- Checking if exists or if can be opened --*/
+      if (fp == NULL)
+      {
+        error("Error: Couldn't open file: %s\n\n", filein);
+        //print_usage();
+        return (-6);
+      }
 
-    fclose(fp);
+      /*-- Checking if file size 0 or checking if file is empty --*/
+      fseek(fp, 0, SEEK_END);
+      if (ftell(fp) < 1)
+      {
+        error("Input file empty\n");
+        return (-7);
+      }
+
+      fclose(fp);
+    }
 
 /*Now copy the name of the input file into the structure*/
     if(strcmp(tool, "res_envelope") == 0)
@@ -669,11 +767,12 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
       }
 
 #if 0
-        debug( "ch: %d samples: %d samprate: %d bits: %d\n",
-                numchans, numsamps, samprate, bitspersamp );
+        debug( "ch: %d samples: %lld samprate: %d bits: %d\n",
+                numchans, (long long) numsamps, samprate, bitspersamp );
 #endif
 
-      fst->header_size = ftell(wf.file);
+      fst->stream = (short) wf.stream;
+      fst->header_size = wf.stream ? 0 : ftell(wf.file);
 
       //close_wav( &wf );
 
@@ -683,7 +782,24 @@ int parse_args( char *tool, int argc, char *argv[], pfstruct fst )
         return (-9);
       }
 
-      if (!((strcmp(tool, "pwr_vs_time") == 0) || (strcmp(tool, "amp_vs_time") == 0) || (strcmp(tool, "mult_freq_resp") == 0)))
+      if ((strcmp(tool, "thd_vs_freq") == 0) || (strcmp(tool, "freq_resp") == 0))
+      {
+        if (samprate < 32000 || samprate > IIR_FS_MAX)
+        {
+          error("Invalid sampling Frequency (%ld)\nAllowed Sampling Frequencies: 32kHz to %dkHz\n", samprate, IIR_FS_MAX / 1000);
+          return (-10);
+        }
+      }
+      else if ((strcmp(tool, "dyn_range") == 0) || (strcmp(tool, "thd_vs_level") == 0) || (strcmp(tool, "noise_mod") == 0))
+      {
+        /* the weighting and 4kHz filters are designed for rates without tables */
+        if (samprate < IIR_FS_MIN || samprate > IIR_FS_MAX)
+        {
+          error("Invalid sampling Frequency (%ld)\nAllowed Sampling Frequencies: %dkHz to %dkHz\n", samprate, IIR_FS_MIN / 1000, IIR_FS_MAX / 1000);
+          return (-10);
+        }
+      }
+      else if (!((strcmp(tool, "pwr_vs_time") == 0) || (strcmp(tool, "amp_vs_time") == 0) || (strcmp(tool, "mult_freq_resp") == 0)))
       {
         if (!(samprate == 32000 || samprate == 44100 || samprate == 48000))
         {
@@ -0,0 +1,555 @@
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	pcm_convert.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
+;***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "pcm_convert.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCM_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCM_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#define PCM_SCALE (1.0 / 2147483648.0)  /* same as dividing by 0x80000000, exactly */
+
+/* Samples are assembled with shifts, so the scalar kernels don't depend on host byte order.
+ * Each puts the sample in the top bits of an int, which is then scaled by 2^-31.
+ */
+static int get_16( const unsigned char *p )
+{
+    return (int) (((unsigned int) p[0] << 16) | ((unsigned int) p[1] << 24));
+}
+
+static int get_24( const unsigned char *p )
+{
+    return (int) (((unsigned int) p[0] << 8) | ((unsigned int) p[1] << 16) | ((unsigned int) p[2] << 24));
+}
+
+static int get_32( const unsigned char *p )
+{
+    return (int) ((unsigned int) p[0] | ((unsigned int) p[1] << 8) | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24));
+}
+
+static float get_float( const unsigned char *p )
+{
+    unsigned int u = (unsigned int) get_32(p);
+    float f;
+
+    memcpy(&f, &u, sizeof(f));
+    return (f);
+}
+
+/*-- Scalar kernels --*/
+
+static void pcm16_scalar( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i;
+
+    for (i = 0; i < num; i++, src += stride)
+    {
+        dst[i] = (double) get_16(src) * PCM_SCALE;
+    }
+}
+
+static void pcm24_scalar( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i;
+
+    for (i = 0; i < num; i++, src += stride)
+    {
+        dst[i] = (double) get_24(src) * PCM_SCALE;
+    }
+}
+
+static void pcm32_scalar( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i;
+
+    for (i = 0; i < num; i++, src += stride)
+    {
+        dst[i] = (double) get_32(src) * PCM_SCALE;
+    }
+}
+
+static void float32_scalar( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i;
+
+    for (i = 0; i < num; i++, src += stride)
+    {
+        dst[i] = (double) get_float(src);
+    }
+}
+
+#ifdef PCM_SSE2
+
+/*-- SSE2 kernels: the conversion and scaling are done 4 samples at a time.  Contiguous
+ *   (mono) 16 bit data is loaded directly, otherwise samples are gathered with scalar loads.
+ --*/
+
+static void store_4( double *dst, __m128i v )
+{
+    const __m128d scale = _mm_set1_pd(PCM_SCALE);
+
+    _mm_storeu_pd(dst, _mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+    _mm_storeu_pd(dst + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0x0e)), scale));
+}
+
+static void pcm16_sse2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = 0;
+    __m128i v;
+
+    if (stride == 2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i + 8 <= num; i += 8, src += 16)
+        {
+            v = _mm_loadu_si128((const __m128i *) src);
+            store_4(dst + i, _mm_unpacklo_epi16(zero, v));
+            store_4(dst + i + 4, _mm_unpackhi_epi16(zero, v));
+        }
+    }
+    else
+    {
+        for (; i + 4 <= num; i += 4, src += 4 * stride)
+        {
+            v = _mm_set_epi32(get_16(src + 3 * stride), get_16(src + 2 * stride), get_16(src + stride), get_16(src));
+            store_4(dst + i, v);
+        }
+    }
+    pcm16_scalar(src, stride, dst + i, num - i);
+}
+
+static void pcm24_sse2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i;
+    __m128i v;
+
+    for (i = 0; i + 4 <= num; i += 4, src += 4 * stride)
+    {
+        v = _mm_set_epi32(get_24(src + 3 * stride), get_24(src + 2 * stride), get_24(src + stride), get_24(src));
+        store_4(dst + i, v);
+    }
+    pcm24_scalar(src, stride, dst + i, num - i);
+}
+
+static void pcm32_sse2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = 0;
+    __m128i v;
+
+    if (stride == 4)
+    {
+        for (; i + 4 <= num; i += 4, src += 16)
+        {
+            store_4(dst + i, _mm_loadu_si128((const __m128i *) src));
+        }
+    }
+    else
+    {
+        for (; i + 4 <= num; i += 4, src += 4 * stride)
+        {
+            v = _mm_set_epi32(get_32(src + 3 * stride), get_32(src + 2 * stride), get_32(src + stride), get_32(src));
+            store_4(dst + i, v);
+        }
+    }
+    pcm32_scalar(src, stride, dst + i, num - i);
+}
+
+static void float32_sse2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = 0;
+    __m128 v;
+
+    if (stride == 4)
+    {
+        for (; i + 4 <= num; i += 4, src += 16)
+        {
+            v = _mm_loadu_ps((const float *) src);
+            _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+            _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+    }
+    else
+    {
+        for (; i + 4 <= num; i += 4, src += 4 * stride)
+        {
+            v = _mm_set_ps(get_float(src + 3 * stride), get_float(src + 2 * stride), get_float(src + stride), get_float(src));
+            _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+            _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+    }
+    float32_scalar(src, stride, dst + i, num - i);
+}
+
+#endif /* PCM_SSE2 */
+
+#ifdef PCM_AVX2
+
+/*-- AVX2 kernels: 8 samples per step using hardware gathers, for any stride.  A gather
+ *   loads 4 bytes per sample, so 16 and 24 bit samples are shifted into the top of the
+ *   int afterwards.  Those 4 bytes stay inside the data as long as another sample
+ *   follows, hence the "i + 8 < num" bound for the narrow formats.
+ --*/
+
+__attribute__((target("avx2")))
+static __m256i avx2_offsets( unsigned long stride )
+{
+    int s = (int) stride;
+
+    return _mm256_set_epi32(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+}
+
+__attribute__((target("avx2")))
+static void avx2_store_8( double *dst, __m256i v )
+{
+    const __m256d scale = _mm256_set1_pd(PCM_SCALE);
+
+    _mm256_storeu_pd(dst, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), scale));
+    _mm256_storeu_pd(dst + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), scale));
+}
+
+__attribute__((target("avx2")))
+static long avx2_int( const unsigned char *src, unsigned long stride, double *dst, long num, int shift )
+{
+    const __m256i offsets = avx2_offsets(stride);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    long last = (shift != 0) ? num - 1 : num;
+    long i;
+    __m256i v;
+
+    for (i = 0; i + 8 <= last; i += 8, src += 8 * stride)
+    {
+        v = _mm256_i32gather_epi32((const int *) src, offsets, 1);
+        avx2_store_8(dst + i, _mm256_sll_epi32(v, count));
+    }
+    return (i);
+}
+
+__attribute__((target("avx2")))
+static void pcm16_avx2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = avx2_int(src, stride, dst, num, 16);
+
+    pcm16_scalar(src + i * stride, stride, dst + i, num - i);
+}
+
+__attribute__((target("avx2")))
+static void pcm24_avx2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = avx2_int(src, stride, dst, num, 8);
+
+    pcm24_scalar(src + i * stride, stride, dst + i, num - i);
+}
+
+__attribute__((target("avx2")))
+static void pcm32_avx2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    long i = avx2_int(src, stride, dst, num, 0);
+
+    pcm32_scalar(src + i * stride, stride, dst + i, num - i);
+}
+
+__attribute__((target("avx2")))
+static void float32_avx2( const unsigned char *src, unsigned long stride, double *dst, long num )
+{
+    const __m256i offsets = avx2_offsets(stride);
+    long i;
+    __m256 v;
+
+    for (i = 0; i + 8 <= num; i += 8, src += 8 * stride)
+    {
+        v = _mm256_i32gather_ps((const float *) src, offsets, 1);
+        _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        _mm256_storeu_pd(dst + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    float32_scalar(src, stride, dst + i, num - i);
+}
+
+static int have_avx2( void )
+{
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2"));
+}
+
+#endif /* PCM_AVX2 */
+
+pcm_convert_fn pcm_convert_select( int bytespersamp, int audio_type, short format_tag )
+{
+    /* index 0: scalar, 1: SSE2, 2: AVX2 */
+    pcm_convert_fn pcm16[3] = { pcm16_scalar, pcm16_scalar, pcm16_scalar };
+    pcm_convert_fn pcm24[3] = { pcm24_scalar, pcm24_scalar, pcm24_scalar };
+    pcm_convert_fn pcm32[3] = { pcm32_scalar, pcm32_scalar, pcm32_scalar };
+    pcm_convert_fn float32[3] = { float32_scalar, float32_scalar, float32_scalar };
+    int level = 0;
+
+#ifdef PCM_SSE2
+    pcm16[1] = pcm16_sse2;
+    pcm24[1] = pcm24_sse2;
+    pcm32[1] = pcm32_sse2;
+    float32[1] = float32_sse2;
+    level = 1;
+#endif
+#ifdef PCM_AVX2
+    pcm16[2] = pcm16_avx2;
+    pcm24[2] = pcm24_avx2;
+    pcm32[2] = pcm32_avx2;
+    float32[2] = float32_avx2;
+    if (have_avx2())
+    {
+        level = 2;
+    }
+#endif
+
+    switch (bytespersamp)
+    {
+        case 2:
+            return (pcm16[level]);
+
+        case 3:
+            return (pcm24[level]);
+
+        case 4:
+            if (audio_type == 1 || (audio_type == -2 && format_tag == 0))  /* PCM, plain or extensible */
+            {
+                return (pcm32[level]);
+            }
+            if (audio_type == 3 || (audio_type == -2 && format_tag == 1))  /* IEEE float, plain or extensible */
+            {
+                return (float32[level]);
+            }
+            return (NULL);
+
+        default:
+            return (NULL);
+    }
+}
+
+/*-- Level search: index of the first sample whose converted magnitude reaches "thres".
+ *   Integer samples are compared as the get_xx() ints against the threshold scaled by
+ *   2^31; both sides carry the same power of two, so this agrees exactly with comparing
+ *   the doubles the converters would produce.
+ --*/
+
+static long long int_threshold( double thres )
+{
+    double t = ceil(thres * 2147483648.0);
+
+    if (t <= 0.0)
+    {
+        return (0);
+    }
+    if (t > 2147483648.0)
+    {
+        return (2147483649LL);  /* above full scale: no sample reaches it */
+    }
+    return ((long long) t);
+}
+
+static long find16_scalar( const unsigned char *src, long num, double thres )
+{
+    long long t = int_threshold(thres);
+    long i;
+
+    for (i = 0; i < num; i++, src += 2)
+    {
+        if (llabs((long long) get_16(src)) >= t)
+        {
+            break;
+        }
+    }
+    return (i);
+}
+
+static long find24_scalar( const unsigned char *src, long num, double thres )
+{
+    long long t = int_threshold(thres);
+    long i;
+
+    for (i = 0; i < num; i++, src += 3)
+    {
+        if (llabs((long long) get_24(src)) >= t)
+        {
+            break;
+        }
+    }
+    return (i);
+}
+
+static long find32_scalar( const unsigned char *src, long num, double thres )
+{
+    long long t = int_threshold(thres);
+    long i;
+
+    for (i = 0; i < num; i++, src += 4)
+    {
+        if (llabs((long long) get_32(src)) >= t)
+        {
+            break;
+        }
+    }
+    return (i);
+}
+
+static long find_float_scalar( const unsigned char *src, long num, double thres )
+{
+    long i;
+
+    for (i = 0; i < num; i++, src += 4)
+    {
+        if (fabs((double) get_float(src)) >= thres)
+        {
+            break;
+        }
+    }
+    return (i);
+}
+
+#ifdef PCM_SSE2
+
+/* SSE2: 8 (16 bit) or 4 (32 bit, float) samples per compare.  |x| >= t is tested as
+ * x > t - 1 or x < 1 - t, which can't overflow for 1 <= t <= full scale.  Once a vector
+ * has a hit, the scalar kernel finds its exact position.
+ */
+static long find16_sse2( const unsigned char *src, long num, double thres )
+{
+    long long t = (int_threshold(thres) + 65535) >> 16;
+    __m128i hi, lo, v;
+    long i;
+
+    if (t == 0 || t > 32768)
+    {
+        return ((t == 0 || num == 0) ? 0 : num);
+    }
+    hi = _mm_set1_epi16((short) (t - 1));
+    lo = _mm_set1_epi16((short) (1 - t));
+    for (i = 0; i + 8 <= num; i += 8)
+    {
+        v = _mm_loadu_si128((const __m128i *) (src + 2 * i));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpgt_epi16(v, hi), _mm_cmplt_epi16(v, lo))) != 0)
+        {
+            break;
+        }
+    }
+    return (i + find16_scalar(src + 2 * i, num - i, thres));
+}
+
+static long find32_sse2( const unsigned char *src, long num, double thres )
+{
+    long long t = int_threshold(thres);
+    __m128i hi, lo, v;
+    long i;
+
+    if (t == 0 || t > 2147483648LL)
+    {
+        return ((t == 0 || num == 0) ? 0 : num);
+    }
+    hi = _mm_set1_epi32((int) (t - 1));
+    lo = _mm_set1_epi32((int) (1 - t));
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        v = _mm_loadu_si128((const __m128i *) (src + 4 * i));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpgt_epi32(v, hi), _mm_cmplt_epi32(v, lo))) != 0)
+        {
+            break;
+        }
+    }
+    return (i + find32_scalar(src + 4 * i, num - i, thres));
+}
+
+static long find_float_sse2( const unsigned char *src, long num, double thres )
+{
+    /* the smallest float >= thres, so the float compare agrees with the double one */
+    float tf = (float) thres;
+    __m128 mask, t, v;
+    long i;
+
+    if ((double) tf < thres)
+    {
+        tf = nextafterf(tf, HUGE_VALF);
+    }
+    mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    t = _mm_set1_ps(tf);
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        v = _mm_and_ps(_mm_loadu_ps((const float *) (src + 4 * i)), mask);
+        if (_mm_movemask_ps(_mm_cmpge_ps(v, t)) != 0)
+        {
+            break;
+        }
+    }
+    return (i + find_float_scalar(src + 4 * i, num - i, thres));
+}
+
+#endif /* PCM_SSE2 */
+
+pcm_find_fn pcm_find_select( int bytespersamp, int audio_type, short format_tag )
+{
+#ifdef PCM_SSE2
+    pcm_find_fn find16 = find16_sse2;
+    pcm_find_fn find32 = find32_sse2;
+    pcm_find_fn find_float = find_float_sse2;
+#else
+    pcm_find_fn find16 = find16_scalar;
+    pcm_find_fn find32 = find32_scalar;
+    pcm_find_fn find_float = find_float_scalar;
+#endif
+
+    switch (bytespersamp)
+    {
+        case 2:
+            return (find16);
+
+        case 3:
+            return (find24_scalar);
+
+        case 4:
+            if (audio_type == 1 || (audio_type == -2 && format_tag == 0))
+            {
+                return (find32);
+            }
+            if (audio_type == 3 || (audio_type == -2 && format_tag == 1))
+            {
+                return (find_float);
+            }
+            return (NULL);
+
+        default:
+            return (NULL);
+    }
+}
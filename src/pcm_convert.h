@@ -0,0 +1,56 @@
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	pcm_convert.h
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
+;***************************************************************************/
+
+#ifndef __PCM_CONVERT_H__
+#define __PCM_CONVERT_H__
+
+/* Converts "num" samples, "stride" bytes apart, from little endian WAV data to
+ * doubles, scaled so that full scale is 1.0.
+ */
+typedef void (*pcm_convert_fn)( const unsigned char *src, unsigned long stride, double *dst, long num );
+
+/* Picks the converter for a sample format once per file: 16 bit, packed 24 bit,
+ * 32 bit PCM or 32 bit float, using the widest SIMD kernel the CPU supports.
+ * audio_type/format_tag are as returned by read_wav_header().  Returns NULL for
+ * formats that can't be read.
+ */
+pcm_convert_fn pcm_convert_select( int bytespersamp, int audio_type, short format_tag );
+
+/* Returns the index of the first of "num" contiguous samples whose magnitude, once
+ * converted as above, is at least "thres", or "num" if none is.  Works on the raw
+ * samples, so nothing is converted to double on the way.
+ */
+typedef long (*pcm_find_fn)( const unsigned char *src, long num, double thres );
+
+/* Picks the level search for a sample format, as pcm_convert_select() does */
+pcm_find_fn pcm_find_select( int bytespersamp, int audio_type, short format_tag );
+
+#endif // __PCM_CONVERT_H__
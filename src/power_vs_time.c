@@ -33,31 +33,23 @@
 #include <stdlib.h>
 #include <math.h>
 #include <float.h> 
+#include <assert.h>
 #include "fio.h"
 #include "power_vs_time.h"
 #include "power.h"
 #include "sos_filter.h"
 #include "dr_filters.h"
+#include "iir_design.h"
 #include "debug.h"
 #include "Utilities.h"
 
 #define MIN_BLOCK_SIZE 1
 
-int power_vs_time( pfstruct pfs, int dnr )
+/* Block size from -blksz_s or -blksz_t (100 ms by default), 0 if it won't do */
+static unsigned long power_block_size( pfstruct pfs )
 {
-    /*Apply chosen block size or use default*/
-
     double block_size_time = 100.0;
     unsigned long block_size;   
-    unsigned long block = 0;
-
-    double time;
-    double *pd;
-    double rms_db;
-    double min_rms_db;
-
-    char format[] = "%3.6lf,\t%3.2lf\n";
-    
 
    /* Check if block size was set in samples ...*/
     if ( pfs->blksz_sSet == 1 )
@@ -79,7 +71,7 @@ int power_vs_time( pfstruct pfs, int dnr )
     if (block_size < MIN_BLOCK_SIZE)
     {
     error("Chosen block size too small (less than 1 sample)\n");
-    return(-1);
+    return(0);
     }
    
     /* Check if block size > MAX sensible value, value of DBL_MAX defined in float.h */
@@ -87,30 +79,82 @@ int power_vs_time( pfstruct pfs, int dnr )
     if (block_size > DBL_MAX)
     {
     error("Chosen block size is greater than maximum possible value.\n");
-    return(-1);
+    return(0);
     }
 
     /* Check if block size > total duration of the signal*/
     if ((long) block_size > pfs->size)
     {
     error("Chose block size is greater than total signal duration. Choose a value less than total signal duration.\n");
-    return(-1);
+    return(0);
     }
 
-    time = (double) block_size / (2.0 * pfs->fs);
+    return (block_size);
+}
 
+static double power_min_db( pfstruct pfs )
+{
     if (pfs->minPowerSet == 1)
     {
-    min_rms_db = pfs->minPower;
+    return (pfs->minPower);
     }
-    else
-    {
+
     /* Computing minimum representable dB level for the bit depth of the signal */
-    min_rms_db = 0.0 - floor(20*log10(pow(2, pfs->bitspersamp)));
+    return (0.0 - floor(20*log10(pow(2, pfs->bitspersamp))));
+}
+
+/* The dynamic range weighting filter for the sample rate: the tables where there are
+ * some, otherwise designed for the rate (NULL if it can't be) */
+static const SOS_FILTER *dr_filter( int fs )
+{
+    switch (fs) /* switch case for diff sample sizes */
+    {
+      case 32000:
+         return (&dr_32000);
+      case 44100:
+         return (&dr_44100);
+      case 48000:
+         return (&dr_48000);
+    } /*end of switch case*/
+
+    return (iir_design_dr(fs));
+}
+
+int power_vs_time( pfstruct pfs, int dnr )
+{
+    unsigned long block_size;   
+    unsigned long block = 0;
+
+    double time;
+    double *pd;
+    double rms_db;
+    double min_rms_db;
+    const SOS_FILTER *coef;
+    SOS_FILTER filter;
+    pSOS_FILTER pf = NULL;
+
+    char format[] = "%3.6lf,\t%3.2lf\n";
+    
+    block_size = power_block_size(pfs);
+    if (block_size == 0)
+    {
+    return(-1);
     }
+
+    time = (double) block_size / (2.0 * pfs->fs);
+
+    min_rms_db = power_min_db(pfs);
             
     block = 0;
-    init_dr_filters();
+    coef = dnr ? dr_filter(pfs->fs) : NULL;
+    if (coef != NULL)
+    {
+      if (init_sos_instance(&filter, coef) != 0)
+      {
+        return (-1);
+      }
+      pf = &filter;
+    }
 
     if (!pfs->noSilence)
     {
@@ -123,6 +167,10 @@ int power_vs_time( pfstruct pfs, int dnr )
     if (pd == NULL)
     {
     error("malloc failed in power_vs_time\n");
+    if (pf != NULL)
+    {
+      free_sos_filter(pf);
+    }
     return (-1);
     }
 
@@ -131,18 +179,10 @@ int power_vs_time( pfstruct pfs, int dnr )
       if (dnr)
       {
           rms_db = 0.0;
-          switch (pfs->fs) /* switch case for diff sample sizes */
+          if (pf != NULL)
           {
-            case 32000:
-               sos_filter_array(pfs->data, &dr_32000, pd, pfs->data_size);
-               break;
-            case 44100:
-               sos_filter_array(pfs->data, &dr_44100, pd, pfs->data_size);
-               break;
-            case 48000:
-               sos_filter_array(pfs->data, &dr_48000, pd, pfs->data_size);
-               break;
-          } /*end of switch case*/
+            sos_filter_array(pfs->data, pf, pd, pfs->data_size);
+          }
           rms_db = compute_power(pd, pfs->data_size);
       }
       else
@@ -184,7 +224,10 @@ int power_vs_time( pfstruct pfs, int dnr )
       time = time + ((double) block_size / pfs->fs);
     }
 
-    free_dr_filters();
+    if (pf != NULL)
+    {
+      free_sos_filter(pf);
+    }
     free(pd);
     if (block == 0)
     {
@@ -193,3 +236,137 @@ int power_vs_time( pfstruct pfs, int dnr )
     }
     return (0);
 }
+
+/* power_vs_time() for channels startCh to endCh - 1 of a file whose channels are all
+ * decoded (fio_planes_ready()), in one pass: each block of every channel is filtered in
+ * the same sos_filter_lanes() call.  The levels are kept and written out a data chunk
+ * per channel afterwards, the same as power_vs_time() gives channel by channel.
+ */
+int power_vs_time_channels( pfstruct pfs, int dnr, int startCh, int endCh )
+{
+    int nch = endCh - startCh;
+    unsigned long block_size;
+    unsigned long block = 0;
+    unsigned long nblocks;
+    unsigned long i;
+    int ch;
+    int res = 0;
+    __int64 pos;
+
+    double *times;
+    double *levels;
+    double *pd;
+    double **in;
+    double **out;
+    double rms_db;
+    double min_rms_db;
+    const SOS_FILTER *pf;
+    SOS_LANE_FILTER lanes;
+
+    char format[] = "%3.6lf,\t%3.2lf\n";
+
+    assert(pfs->planes != NULL);
+
+    check( fio_next_chunk(pfs, startCh) );
+    fio_resetpos(pfs);
+
+    block_size = power_block_size(pfs);
+    if (block_size == 0)
+    {
+    return(-1);
+    }
+
+    min_rms_db = power_min_db(pfs);
+    pf = dr_filter(pfs->fs);
+
+    nblocks = (unsigned long) (pfs->size / block_size) + 1;
+    times = (double *) calloc(nblocks, sizeof(double));
+    levels = (double *) calloc(nblocks * nch, sizeof(double));
+    pd = (double *) calloc(block_size * nch, sizeof(double));
+    in = (double **) calloc(2 * nch, sizeof(double *));
+    if (times == NULL || levels == NULL || pd == NULL || in == NULL || (dnr && pf != NULL && init_sos_lanes(&lanes, pf, nch) != 0))
+    {
+    error("malloc failed in power_vs_time_channels\n");
+    free(times);
+    free(levels);
+    free(pd);
+    free(in);
+    return (-1);
+    }
+    out = in + nch;
+
+    if (!pfs->noSilence)
+    {
+      strip_lead_silence(pfs);
+    }
+
+    times[0] = (double) block_size / (2.0 * pfs->fs);
+    fio_read(pfs, block_size);
+
+    while (pfs->data_size == (long) block_size)
+    {
+      /* pfs->data is the first channel's block, the others are at the same place */
+      pos = pfs->position - pfs->data_size;
+      for (ch = 0; ch < nch; ch++)
+      {
+          in[ch] = pfs->planes[startCh + ch] + pos;
+          out[ch] = pd + ch * block_size;
+      }
+
+      if (dnr && pf != NULL)
+      {
+          sos_filter_lanes(&lanes, in, out, block_size);
+      }
+
+      for (ch = 0; ch < nch; ch++)
+      {
+          if (dnr)
+          {
+            rms_db = compute_power(out[ch], block_size) - 5.629 + 3.01;
+          }
+          else
+          {
+            rms_db = compute_power(in[ch], block_size) + 3.01;
+          }
+
+          if (rms_db < min_rms_db)
+          {
+            rms_db = min_rms_db;
+          }
+          levels[ch * nblocks + block] = rms_db;
+      }
+
+      fio_read(pfs, block_size);
+      times[block + 1] = times[block] + ((double) block_size / pfs->fs);
+      block++;
+    }
+
+    /* Skip first data block in case of DNR */
+    for (ch = 0; ch < nch && res == 0; ch++)
+    {
+      if (ch > 0)
+      {
+        check( fio_next_chunk(pfs, startCh + ch) );
+      }
+      for (i = dnr ? 1 : 0; i < block; i++)
+      {
+        check( sdf_writer_add_data_double_double(pfs->sdf_out, times[i], levels[ch * nblocks + i], format) );
+      }
+      if (block == 0)
+      {
+        error("File too small\n");
+        res = -1;
+      }
+    }
+
+    if (dnr && pf != NULL)
+    {
+      free_sos_lanes(&lanes);
+    }
+    free(times);
+    free(levels);
+    free(pd);
+    free(in);
+
+    return (res);
+}
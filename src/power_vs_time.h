@@ -35,4 +35,8 @@
 
 int power_vs_time( pfstruct pfs, int dnr );
 
+/* power_vs_time() for channels startCh to endCh - 1 in one pass, each in its own data
+ * chunk; every channel must be decoded already (fio_planes_ready()) */
+int power_vs_time_channels( pfstruct pfs, int dnr, int startCh, int endCh );
+
 #endif //__POWER_VS_TIME_H__
@@ -44,10 +44,9 @@ extern void print_usage( void );
 
 char *chart = "title, Power vs. Time,\nxlabel, Time (s),\nylabel, Amplitude (dBFS)\n";
 
-fstruct fst;
-
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res;
     int startCh, endCh;
     int ch;
@@ -97,13 +96,17 @@ void print_usage( void )
     fprintf(stderr, "Power vs Time Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: pwr_vs_time [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: pwr_vs_time [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multichannel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf(stderr, "-c a                for all channels\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
     fprintf(stderr, "-blksz_t <time>,    set block size in ms (default=100ms equivalent)\n");
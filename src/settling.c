@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	settling.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	settling.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <stdio.h>
@@ -43,17 +43,29 @@
 
 #include "SATS_fft.h" 
 
-/* Note that the +1's below derives from the original MATLAB -> C conversion.
- * TODO: Determine whether the +1 is ever used, or just defensive.
- */
 #define NUMBLOCKS_MAX           ( 20 )
-#define FS_MAX                  ( 48000 )
-#define FFT_SIZE_MAX            ( 8192 )            /* FFT_SIZE_MAX = 2^(round(log2(FS_MAX) - 3)) */
-#define BLK_SIZE_MAX            ( 8192 + 1 )        /* BLK_SIZE_MAX = 2^(round(log2(FS_MAX) - 3)) + 1 */
-#define NEW_BLK_SIZE_MAX        ( 2048 + 1 )        /* NEW_BLK_SIZE_MAX = BLK_SIZE_MAX / 4 + 1 */
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TRACK_SPAN              ( 3 )               /* bins either side of the last FFT peak followed by the sliding DFT */
+#define TRACK_BINS              ( 2 * TRACK_SPAN + 1 )
+#define TRACK_MARGIN            ( 1.05 )            /* headroom on the Parseval bound for rounding in the sliding sums */
+
+/* Bins around the last FFT peak, slid along with the analysis window */
+typedef struct
+{
+    int first;                      /* first tracked bin, 0 when not tracking */
+    double re[TRACK_BINS];
+    double im[TRACK_BINS];
+} settling_track_t;
 
 static void settling_debug( char *fmt, ... );
+static int settling_block_size( unsigned long fs, int freq_settling );
+static void settling_track_seed( settling_track_t *track, const SATS_FFT_Complex *spec, int peak, int fftsize );
+static void settling_track_slide( settling_track_t *track, const double *diff, int n, int fftsize );
+static int settling_track_peak( const settling_track_t *track, const double *blk, int blksize );
 
 static void settling_debug( char *fmt, ... )
 {
@@ -71,6 +83,152 @@ static void settling_debug( char *fmt, ... )
     return;
 }
 
+/**
+ * @brief   Analysis block (and FFT) size for a sample rate
+ *
+ * @details The power of two nearest 1/8s for frequency settling, or 1/32s when only the
+ *          amplitude is checked, so the block length in time is the same at every rate.
+ *
+ * @param   fs              IN: sampling rate in Hz
+ * @param   freq_settling   IN: non-zero if frequency settling is performed
+ *
+ * @return  Block size in samples.
+ */
+static int settling_block_size( unsigned long fs, int freq_settling )
+{
+    return (int) pow(2, (round(log(fs) / log(2)) - (freq_settling ? 3 : 5)));
+}
+
+/**
+ * @brief   Start tracking the bins around an FFT peak
+ *
+ * @details Copies the TRACK_BINS bins centred on peak out of the spectrum.  Tracking is
+ *          switched off when the bins would reach DC or Nyquist.
+ *
+ * @param   track       OUT: tracker to seed
+ * @param   spec        IN: FFT of the current analysis window
+ * @param   peak        IN: index of the spectral peak
+ * @param   fftsize     IN: FFT size, equal to the analysis window length
+ */
+static void settling_track_seed( settling_track_t *track, const SATS_FFT_Complex *spec, int peak, int fftsize )
+{
+    int k;
+
+    track->first = 0;
+    if ((peak - TRACK_SPAN < 1) || (peak + TRACK_SPAN >= fftsize / 2))
+    {
+        return;
+    }
+
+    track->first = peak - TRACK_SPAN;
+    for (k = 0; k < TRACK_BINS; k++)
+    {
+        track->re[k] = SATS_FFT_REAL(spec[track->first + k]);
+        track->im[k] = SATS_FFT_IMAG(spec[track->first + k]);
+    }
+}
+
+/**
+ * @brief   Slide the tracked bins along by n samples
+ *
+ * @details With w = 2*pi*k/N and d[j] the new minus the departing samples, the next window
+ *          has X'(k) = exp(jwn) * (X(k) + sum(d[j] * exp(-jwj))).  The sum is taken with a
+ *          Goertzel filter over d, so each step costs n rather than N samples per bin.
+ *
+ * @param   track       IN/OUT: tracker to update
+ * @param   diff        IN: new samples minus the samples leaving the window, n long
+ * @param   n           IN: step size in samples
+ * @param   fftsize     IN: FFT size, equal to the analysis window length
+ */
+static void settling_track_slide( settling_track_t *track, const double *diff, int n, int fftsize )
+{
+    double coef[TRACK_BINS];
+    double s1[TRACK_BINS], s2[TRACK_BINS];
+    int i, k;
+
+    for (k = 0; k < TRACK_BINS; k++)
+    {
+        coef[k] = 2.0 * cos(2.0 * M_PI * (double) (track->first + k) / fftsize);
+        s1[k] = s2[k] = 0.0;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        const double x = diff[i];
+
+        for (k = 0; k < TRACK_BINS; k++)
+        {
+            const double s0 = x + coef[k] * s1[k] - s2[k];
+
+            s2[k] = s1[k];
+            s1[k] = s0;
+        }
+    }
+
+    for (k = 0; k < TRACK_BINS; k++)
+    {
+        /* exp(jwn) * exp(-jw(n-1)) * (s1 - exp(-jw) s2) == exp(jw) * (s1 - exp(-jw) s2) */
+        const int bin = track->first + k;
+        const double w = 2.0 * M_PI * (double) bin / fftsize;
+        const double p = 2.0 * M_PI * (double) (((long) bin * n) % fftsize) / fftsize;
+        const double yr = s1[k] * cos(w) - s2[k];
+        const double yi = s1[k] * sin(w);
+        const double xr = track->re[k] * cos(p) - track->im[k] * sin(p);
+        const double xi = track->im[k] * cos(p) + track->re[k] * sin(p);
+
+        track->re[k] = xr + yr;
+        track->im[k] = xi + yi;
+    }
+}
+
+/**
+ * @brief   Find the spectral peak from the tracked bins alone
+ *
+ * @details By Parseval, twice the power of any bin below Nyquist is at most N times the
+ *          window energy less DC and the other bins.  When the largest tracked bin beats
+ *          both that bound for the untracked bins and DC, it is the peak the full FFT scan
+ *          would find.
+ *
+ * @param   track       IN: tracker, slid onto the current window
+ * @param   blk         IN: current analysis window
+ * @param   blksize     IN: window length, equal to the FFT size
+ *
+ * @return  Returns the peak bin, or -1 if the tracked bins cannot prove it.
+ */
+static int settling_track_peak( const settling_track_t *track, const double *blk, int blksize )
+{
+    double energy = 0.0, dc = 0.0;
+    double tracked = 0.0, peak = 0.0, rest;
+    int index = -1;
+    int i, k;
+
+    for (i = 0; i < blksize; i++)
+    {
+        energy += blk[i] * blk[i];
+        dc += blk[i];
+    }
+
+    for (k = 0; k < TRACK_BINS; k++)
+    {
+        const double p = (track->re[k] * track->re[k]) + (track->im[k] * track->im[k]);
+
+        tracked += p;
+        if (peak < p)
+        {
+            peak = p;
+            index = track->first + k;
+        }
+    }
+
+    rest = ((blksize * energy) - (dc * dc) - (2.0 * tracked)) / 2.0;
+    if ((peak > (TRACK_MARGIN * rest)) && (peak > (TRACK_MARGIN * dc * dc)))
+    {
+        return index;
+    }
+
+    return -1;
+}
+
 /**
  * @brief   Perform amplitude and/or frequency settling
  *
@@ -98,6 +256,7 @@ static void settling_debug( char *fmt, ... )
  * @param   alpha           IN: alpha factor (time constant) for leaky integrator
  * @param   numblocks       IN: number of blocks to settle over (max 20)
  * @param   limit           IN: maximum length to search over (in samples)
+ * @param   ws              IN/OUT: scratch for the analysis blocks, see check_settling_workspace()
  * @param   settle_point    OUT: number of samples required for settling + 1
  *
  * @return  Returns 0 if settling is performed.  -1 otherwise.
@@ -113,6 +272,7 @@ int check_settling( check_settling_analysis_type analysis_type,
                     double alpha,
                     int numblocks,
                     int limit,
+                    workspace_t *ws,
                     int *settle_point)
 {
     int i = 0;
@@ -121,16 +281,18 @@ int check_settling( check_settling_analysis_type analysis_type,
     int total_blkcount = 0;         /* initial total block count */
     double curr_freq = 0;           /* current frequency */
     unsigned long fs = 0;           /* sampling rate */
-    unsigned long startpoint = 0;   /* initial starting point in samples to start testing for settling */
+    __int64 startpoint = 0;         /* initial starting point in samples to start testing for settling */
     int blklimit = 0;               /* block limit */
 
     /* variables for FFT */
     double fftsize;                 /* fft size */
     int blksize;                    /* block size */
     int stepsize;                   /* Step Size */
-    SATS_FFT_Complex blk_out[FFT_SIZE_MAX];     /* Complex output datatype from the FFT */
-    double blk[BLK_SIZE_MAX];                /* fft input Array */
-    double new_blk[NEW_BLK_SIZE_MAX];        /* fft input Array */
+    SATS_FFT_Complex *blk_out;      /* Complex output datatype from the FFT, fftsize / 2 + 1 */
+    double *blk;                    /* fft input Array, blksize + 1 */
+    double *new_blk;                /* fft input Array, stepsize + 1 */
+    double *old_blk;                /* samples leaving the window, stepsize + 1 */
+    settling_track_t track;         /* sliding DFT of the bins around the last FFT peak */
     //SATS_FFT_HANDLE fft_handle;      /* FFT handle for configuring the FFT. */
     SATS_FFT_Status fft_status = 0;        /* Status variable for all FFT function returns. */
 
@@ -169,14 +331,10 @@ int check_settling( check_settling_analysis_type analysis_type,
 
     /* Input argument checking */
     assert(numblocks <= NUMBLOCKS_MAX);
+    assert(ws != NULL);
     if (input_type == FSTRUCT)
     {
         assert(pfs != NULL);
-        assert(pfs->fs <= FS_MAX);
-    }
-    else
-    {
-        assert(raw_data_fs <= FS_MAX);
     }
 
     /* Set sampling rate and clamp limits */
@@ -184,7 +342,7 @@ int check_settling( check_settling_analysis_type analysis_type,
     {
         fs = pfs->fs;
         startpoint = pfs->data_position;
-        limit = imin(limit, (pfs->data_size - pfs->data_position));
+        limit = (int) imin64(limit, pfs->data_size - pfs->data_position);
     }
     else
     {
@@ -211,7 +369,7 @@ int check_settling( check_settling_analysis_type analysis_type,
         freq_sett_count = 0;
 
         /* Setting FFT variables */
-        fftsize = pow(2, (round(log(fs) / log(2)) - 3));
+        fftsize = settling_block_size(fs, 1);
         blksize = (int) fftsize;
         stepsize = (int) (blksize * .25);
     }
@@ -224,13 +382,25 @@ int check_settling( check_settling_analysis_type analysis_type,
 
         /* if only doing amplitude settling we can use a much smaller block size. */
         /* This provides much faster settling use nearest power of two to 31.25ms */
-        fftsize = pow(2, (round(log(fs) / log(2)) - 5));
+        fftsize = settling_block_size(fs, 0);
         blksize = (int) fftsize;
         stepsize = (int) (blksize * .25);
     }
 
     settling_debug("Block and step sizes: %d %d\n", blksize, stepsize);
 
+    /* Analysis blocks, see check_settling_workspace() */
+    blk_out = (SATS_FFT_Complex *) workspace_alloc(ws, ((int) fftsize / 2 + 1) * sizeof(SATS_FFT_Complex));
+    blk = (double *) workspace_alloc(ws, (blksize + 1) * sizeof(double));
+    new_blk = (double *) workspace_alloc(ws, (stepsize + 1) * sizeof(double));
+    old_blk = (double *) workspace_alloc(ws, (stepsize + 1) * sizeof(double));
+    if ((blk_out == NULL) || (blk == NULL) || (new_blk == NULL) || (old_blk == NULL))
+    {
+        *settle_point = 0;
+        error("Settling workspace too small\n");
+        return(-1);
+    }
+
     /* Checking if there is enough data to detect settling */
     if (limit < blksize)
     {
@@ -291,7 +461,7 @@ int check_settling( check_settling_analysis_type analysis_type,
     if (input_type == FSTRUCT)
     {
         /* Read data into array blk */
-        memcpy(blk, &pfs->data[pfs->data_position], (blksize - stepsize) * sizeof(double));
+        memcpy(blk, fio_window_get(pfs, pfs->data_position, blksize - stepsize), (blksize - stepsize) * sizeof(double));
         pfs->data_position += (blksize - stepsize);
     }
     else
@@ -303,6 +473,7 @@ int check_settling( check_settling_analysis_type analysis_type,
 
     /* Variable for counting number of iteration before AMP and FREQ Settling are successful */
     while_count = 0;
+    track.first = 0;
 
     /* This while is used to walk through the audio data and search for frequency and amplitude settlement blocks */
     /* Exit conditions are when frequency AND amp have settled */
@@ -314,7 +485,7 @@ int check_settling( check_settling_analysis_type analysis_type,
         if (input_type == FSTRUCT)
         {
             /* Getting new set of audio data of size=stepsize in samples, located at new_blk */
-            memcpy(new_blk, &pfs->data[pfs->data_position], stepsize * sizeof(double));
+            memcpy(new_blk, fio_window_get(pfs, pfs->data_position, stepsize), stepsize * sizeof(double));
             pfs->data_position += stepsize;
 
             /* Print analysis window for debug */
@@ -347,33 +518,55 @@ int check_settling( check_settling_analysis_type analysis_type,
         /* freq_settled variable will be set to 1 when frequency has settled */
         if (freq_settling_on == 1)
         {
+            index = -1;
 
-            /* Pad with zeros to fftsize */
-            for (i = 0; i < (fftsize - blksize); i++)
+            /* Once a tone is found, slide its bins along instead of taking a new FFT */
+            if (track.first > 0)
             {
-                blk[blksize + i] = 0.0;
+                for (i = 0; i < stepsize; i++)
+                {
+                    old_blk[i] = new_blk[i] - old_blk[i];
+                }
+
+                settling_track_slide(&track, old_blk, stepsize, blksize);
+                index = settling_track_peak(&track, blk, blksize);
             }
 
-            /* Executing forward FFT for audio data in blk array */
-            fft_status = SATS_FFT_ComputeForward2(blk, blk_out, (int)fftsize);
+            if (index < 0)
+            {
+                /* Pad with zeros to fftsize */
+                for (i = 0; i < (fftsize - blksize); i++)
+                {
+                    blk[blksize + i] = 0.0;
+                }
 
-            max_fft_value = 0.0;
-            index = 0;
+                /* Executing forward FFT for audio data in blk array */
+                fft_status = SATS_FFT_ComputeForward2(blk, blk_out, (int)fftsize);
 
-            /* Looking for the max absolute value and index */
-            for (i = 0; i < (fftsize / 2); i++)
-            {
-                /* Coping all the real values to fft_data array */
-                re = SATS_FFT_REAL(blk_out[i]);
-                img = SATS_FFT_IMAG(blk_out[i]);
+                max_fft_value = 0.0;
+                index = 0;
 
-                new_fft_value = sqrt(((re * re) + (img * img)));
+                /* Looking for the max absolute value and index */
+                for (i = 0; i < (fftsize / 2); i++)
+                {
+                    /* Coping all the real values to fft_data array */
+                    re = SATS_FFT_REAL(blk_out[i]);
+                    img = SATS_FFT_IMAG(blk_out[i]);
+
+                    new_fft_value = sqrt(((re * re) + (img * img)));
+
+                    /* Checking for Max value and corresponding index */
+                    if ((double) max_fft_value < (double) new_fft_value)
+                    {
+                        max_fft_value = (double) new_fft_value;
+                        index = i;
+                    }
+                }
 
-                /* Checking for Max value and corresponding index */
-                if ((double) max_fft_value < (double) new_fft_value)
+                /* The sliding DFT needs an unpadded window */
+                if ((int) fftsize == blksize)
                 {
-                    max_fft_value = (double) new_fft_value;
-                    index = i;
+                    settling_track_seed(&track, blk_out, index, blksize);
                 }
             }
 
@@ -485,6 +678,12 @@ int check_settling( check_settling_analysis_type analysis_type,
 
         } /* end of amplitude settling */
 
+        /* keep the departing samples for the next slide of the tracked bins */
+        if (track.first > 0)
+        {
+            memcpy(old_blk, blk, stepsize * sizeof(double));
+        }
+
         /* stripping of oldest data ready for next time */
         memmove(blk, &blk[stepsize], (blksize - stepsize) * sizeof(double));
 
@@ -539,3 +738,24 @@ int check_settling( check_settling_analysis_type analysis_type,
 	fft_status = fft_status;
     return(0);
 }
+
+/**
+ * @brief   Workspace needed by check_settling()
+ *
+ * @details Sized for frequency settling, which uses the larger blocks.  The +1's derive
+ *          from the original MATLAB -> C conversion.
+ *
+ * @param   fs      IN: sampling rate in Hz of the input to be checked
+ *
+ * @return  Returns the number of bytes check_settling() takes from its workspace.
+ */
+size_t check_settling_workspace( unsigned long fs )
+{
+    const int blksize = settling_block_size(fs, 1);
+    const int stepsize = blksize / 4;
+
+    return WORKSPACE_SIZE((blksize / 2 + 1) * sizeof(SATS_FFT_Complex))
+         + WORKSPACE_SIZE((blksize + 1) * sizeof(double))
+         + WORKSPACE_SIZE((stepsize + 1) * sizeof(double))
+         + WORKSPACE_SIZE((stepsize + 1) * sizeof(double));
+}
@@ -33,6 +33,7 @@
 #define __SETTLING_H__
 
 #include "fio.h"
+#include "Utilities.h"
 
 /* Input types */
 typedef enum
@@ -63,7 +64,9 @@ int check_settling( check_settling_analysis_type analysis_type,
                     double alpha,
                     int numblocks,
                     int limit,
+                    workspace_t *ws,
                     int *settle_point);
+size_t check_settling_workspace( unsigned long fs );
 
 #endif /*__SETTLING_H__*/
 
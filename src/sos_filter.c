@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "sos_filter.h"
@@ -67,6 +68,18 @@ int init_sos_filter( pSOS_FILTER pf )
     return (0); // OK
 }
 
+/* Make "pf" an instance of the cascade "coef": it shares coef's coefficients, which
+ * neither of them may change, and gets a cleared delay line of its own, freed with
+ * free_sos_filter() */
+int init_sos_instance( pSOS_FILTER pf, const SOS_FILTER *coef )
+{
+    *pf = *coef;
+    pf->z1 = NULL;
+    pf->z2 = NULL;
+
+    return (init_sos_filter(pf));
+}
+
 void reset_sos_filter( pSOS_FILTER pf )
 {
     int i;
@@ -141,18 +154,461 @@ double sos_filter( double x, pSOS_FILTER pf )
     return (x);
 }
 
-void sos_filter_array( double *in, pSOS_FILTER pfilt, double *out, unsigned long l )
+/* Block processing.  sos_filter_array() sorts the sections once per call into biquads,
+ * each with the gain section in front of it (if any) as a multiplier, and runs the
+ * biquads over the block SOS_GROUP at a time: one pass per group, with the group's
+ * coefficients and delays in local variables, so that the biquads of a group overlap
+ * in the pipeline.  A gain section not followed by a biquad gets a pass of its own.
+ * Per sample the arithmetic is that of sos_filter(), in the same order (a missing gain
+ * is a multiplication by 1.0, which is exact), so the output is identical; only the
+ * calls, asserts and bl[] tests per sample are gone.
+ */
+#define SOS_GROUP   ( 4 )
+
+typedef struct
+{
+    double g;                   /* gain section in front of the biquad, 1.0 if none */
+    const double *b;
+    const double *a;
+    int sec;                    /* index of the biquad's section, for z1/z2 */
+} sos_stage_t;
+
+/* Run "n" stages (a constant once inlined) over the block */
+static inline void sos_stages( const sos_stage_t *st, int n, pSOS_FILTER pf, const double *in, double *out, unsigned long l )
 {
+    double g[SOS_GROUP], b0[SOS_GROUP], b1[SOS_GROUP], b2[SOS_GROUP], a1[SOS_GROUP], a2[SOS_GROUP];
+    double z1[SOS_GROUP], z2[SOS_GROUP];
+    double x, d;
     unsigned long i;
+    int k;
+
+    for (k = 0; k < n; k++)
+    {
+        g[k] = st[k].g;
+        b0[k] = st[k].b[0];
+        b1[k] = st[k].b[1];
+        b2[k] = st[k].b[2];
+        a1[k] = st[k].a[1];
+        a2[k] = st[k].a[2];
+        z1[k] = pf->z1[st[k].sec];
+        z2[k] = pf->z2[st[k].sec];
+    }
 
     for (i = 0; i < l; i++)
     {
-        *out = sos_filter(*in++, pfilt);
+        x = in[i];
+        for (k = 0; k < n; k++)
+        {
+            /* as sos_filter() and biquad() */
+            x = x * g[k];
+            d = x - (z1[k] * a1[k]) - (z2[k] * a2[k]);
+            x = d * b0[k];
+            x = x + (z1[k] * b1[k]) + (z2[k] * b2[k]);
+            z2[k] = z1[k];
+            z1[k] = d;
+        }
+        out[i] = x;
+    }
+
+    for (k = 0; k < n; k++)
+    {
+        pf->z1[st[k].sec] = z1[k];
+        pf->z2[st[k].sec] = z2[k];
+    }
+}
+
+static void sos_group( const sos_stage_t *st, int n, pSOS_FILTER pf, const double *in, double *out, unsigned long l )
+{
+    switch (n)
+    {
+        case 4:
+            sos_stages(st, 4, pf, in, out, l);
+            break;
+        case 3:
+            sos_stages(st, 3, pf, in, out, l);
+            break;
+        case 2:
+            sos_stages(st, 2, pf, in, out, l);
+            break;
+        default:
+            sos_stages(st, 1, pf, in, out, l);
+            break;
+    }
+}
+
+static void sos_gain( double g, const double *in, double *out, unsigned long l )
+{
+    unsigned long i;
+
+    for (i = 0; i < l; i++)
+    {
+        out[i] = in[i] * g;
+    }
+}
+
+/* Filter "l" samples; "in" and "out" may be the same array */
+void sos_filter_array( double *in, pSOS_FILTER pfilt, double *out, unsigned long l )
+{
+    sos_stage_t st[SOS_GROUP];
+    const double *src = in;
+    int nst = 0;
+    int have_gain = 0;
+    double gain = 1.0;
+    int i;
+
+    assert(pfilt->z1 != NULL);
+    assert(pfilt->z2 != NULL);
+
+    for (i = 0; i < pfilt->nsec; i++)
+    {
+        if (pfilt->bl[i] == 1)
+        {
+            if (have_gain)
+            {
+                /* two gains in a row, the first is applied on its own */
+                if (nst > 0)
+                {
+                    sos_group(st, nst, pfilt, src, out, l);
+                    src = out;
+                    nst = 0;
+                }
+                sos_gain(gain, src, out, l);
+                src = out;
+            }
+            gain = pfilt->b[i][0];
+            have_gain = 1;
+        }
+        else if (pfilt->bl[i] == 3)
+        {
+            st[nst].g = have_gain ? gain : 1.0;
+            st[nst].b = pfilt->b[i];
+            st[nst].a = pfilt->a[i];
+            st[nst].sec = i;
+            have_gain = 0;
+            if (++nst == SOS_GROUP)
+            {
+                sos_group(st, nst, pfilt, src, out, l);
+                src = out;
+                nst = 0;
+            }
+        }
+    }
+    if (nst > 0)
+    {
+        sos_group(st, nst, pfilt, src, out, l);
+        src = out;
+    }
+    if (have_gain)
+    {
+        sos_gain(gain, src, out, l);
+        src = out;
+    }
+    if (src != out)
+    {
+        /* no sections */
+        memmove(out, in, l * sizeof(double));
+    }
+
 #ifdef DEBUG
-        debugSample( *out );
+    {
+        unsigned long j;
+
+        for (j = 0; j < l; j++)
+        {
+            debugSample( out[j] );
+        }
+    }
+#endif
+}
+
+/* Multichannel filtering.  sos_filter_lanes() runs the cascade over up to SOS_LANES
+ * channels at once, one channel per vector lane: SOS_LANE_BLOCK samples of every
+ * channel are gathered into a frame-interleaved buffer, the stages are applied across
+ * the lanes of each frame, and the result is scattered back.  The stages are grouped as
+ * in sos_filter_array() and each lane does the same arithmetic in the same order, so
+ * every channel comes out identical to filtering it on its own.  As for the FFT, the
+ * kernel is built per instruction set with FMA contraction off, and the widest one the
+ * CPU supports is picked in init_sos_lanes().
+ */
+#define SOS_LANE_BLOCK  ( 256 )
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOS_LANES_DISPATCH 1
 #endif
-        out++;
+
+#if defined(__GNUC__)
+#define SOS_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define SOS_INLINE static __forceinline
+#else
+#define SOS_INLINE static inline
+#endif
+
+/* Run "n" stages (a constant once inlined) over "l" frames */
+SOS_INLINE void sos_lane_stages( const sos_stage_t *st, int n, double *pz1, double *pz2, double (*buf)[SOS_LANES], unsigned long l )
+{
+    double g[SOS_GROUP], b0[SOS_GROUP], b1[SOS_GROUP], b2[SOS_GROUP], a1[SOS_GROUP], a2[SOS_GROUP];
+    double z1[SOS_GROUP][SOS_LANES], z2[SOS_GROUP][SOS_LANES];
+    double x[SOS_LANES];
+    double d;
+    unsigned long i;
+    int k, c;
+
+    for (k = 0; k < n; k++)
+    {
+        g[k] = st[k].g;
+        b0[k] = st[k].b[0];
+        b1[k] = st[k].b[1];
+        b2[k] = st[k].b[2];
+        a1[k] = st[k].a[1];
+        a2[k] = st[k].a[2];
+        for (c = 0; c < SOS_LANES; c++)
+        {
+            z1[k][c] = pz1[st[k].sec * SOS_LANES + c];
+            z2[k][c] = pz2[st[k].sec * SOS_LANES + c];
+        }
+    }
+
+    for (i = 0; i < l; i++)
+    {
+        for (c = 0; c < SOS_LANES; c++)
+        {
+            x[c] = buf[i][c];
+        }
+        for (k = 0; k < n; k++)
+        {
+            for (c = 0; c < SOS_LANES; c++)
+            {
+                /* as sos_stages() */
+                x[c] = x[c] * g[k];
+                d = x[c] - (z1[k][c] * a1[k]) - (z2[k][c] * a2[k]);
+                x[c] = d * b0[k];
+                x[c] = x[c] + (z1[k][c] * b1[k]) + (z2[k][c] * b2[k]);
+                z2[k][c] = z1[k][c];
+                z1[k][c] = d;
+            }
+        }
+        for (c = 0; c < SOS_LANES; c++)
+        {
+            buf[i][c] = x[c];
+        }
     }
+
+    for (k = 0; k < n; k++)
+    {
+        for (c = 0; c < SOS_LANES; c++)
+        {
+            pz1[st[k].sec * SOS_LANES + c] = z1[k][c];
+            pz2[st[k].sec * SOS_LANES + c] = z2[k][c];
+        }
+    }
+}
+
+SOS_INLINE void sos_lane_group( const sos_stage_t *st, int n, double *z1, double *z2, double (*buf)[SOS_LANES], unsigned long l )
+{
+    switch (n)
+    {
+        case 4:
+            sos_lane_stages(st, 4, z1, z2, buf, l);
+            break;
+        case 3:
+            sos_lane_stages(st, 3, z1, z2, buf, l);
+            break;
+        case 2:
+            sos_lane_stages(st, 2, z1, z2, buf, l);
+            break;
+        default:
+            sos_lane_stages(st, 1, z1, z2, buf, l);
+            break;
+    }
+}
+
+SOS_INLINE void sos_lane_gain( double g, double (*buf)[SOS_LANES], unsigned long l )
+{
+    unsigned long i;
+    int c;
+
+    for (i = 0; i < l; i++)
+    {
+        for (c = 0; c < SOS_LANES; c++)
+        {
+            buf[i][c] = buf[i][c] * g;
+        }
+    }
+}
+
+/* The whole cascade over one buffer of frames, in the order of sos_filter_array() */
+SOS_INLINE void sos_lanes_body( const SOS_FILTER *pf, double *z1, double *z2, double (*buf)[SOS_LANES], unsigned long l )
+{
+    sos_stage_t st[SOS_GROUP];
+    int nst = 0;
+    int have_gain = 0;
+    double gain = 1.0;
+    int i;
+
+    for (i = 0; i < pf->nsec; i++)
+    {
+        if (pf->bl[i] == 1)
+        {
+            if (have_gain)
+            {
+                if (nst > 0)
+                {
+                    sos_lane_group(st, nst, z1, z2, buf, l);
+                    nst = 0;
+                }
+                sos_lane_gain(gain, buf, l);
+            }
+            gain = pf->b[i][0];
+            have_gain = 1;
+        }
+        else if (pf->bl[i] == 3)
+        {
+            st[nst].g = have_gain ? gain : 1.0;
+            st[nst].b = pf->b[i];
+            st[nst].a = pf->a[i];
+            st[nst].sec = i;
+            have_gain = 0;
+            if (++nst == SOS_GROUP)
+            {
+                sos_lane_group(st, nst, z1, z2, buf, l);
+                nst = 0;
+            }
+        }
+    }
+    if (nst > 0)
+    {
+        sos_lane_group(st, nst, z1, z2, buf, l);
+    }
+    if (have_gain)
+    {
+        sos_lane_gain(gain, buf, l);
+    }
+}
+
+static void sos_lanes_block_c( const SOS_FILTER *pf, double *z1, double *z2, double (*buf)[SOS_LANES], unsigned long l )
+{
+    sos_lanes_body(pf, z1, z2, buf, l);
+}
+
+#ifdef SOS_LANES_DISPATCH
+#define SOS_LANES_VARIANT(isa, features)                                                            \
+static __attribute__((target(features), optimize("fp-contract=off")))                              \
+void sos_lanes_block_##isa( const SOS_FILTER *pf, double *z1, double *z2, double (*buf)[SOS_LANES], unsigned long l ) \
+{                                                                                                   \
+    sos_lanes_body(pf, z1, z2, buf, l);                                                             \
+}
+
+SOS_LANES_VARIANT(avx512, "avx512f,prefer-vector-width=512")
+SOS_LANES_VARIANT(avx2, "avx2")
+SOS_LANES_VARIANT(sse2, "sse2")
+#endif
+
+int init_sos_lanes( pSOS_LANE_FILTER pl, const SOS_FILTER *pf, int nch )
+{
+    size_t n = (size_t) ((nch + SOS_LANES - 1) / SOS_LANES) * pf->nsec * SOS_LANES;
+
+    pl->pf = pf;
+    pl->nch = nch;
+    pl->z1 = (double *) calloc(n, sizeof(double));
+    pl->z2 = (double *) calloc(n, sizeof(double));
+    if (pl->z1 == NULL || pl->z2 == NULL)
+    {
+        free(pl->z1);
+        free(pl->z2);
+        pl->z1 = NULL;
+        pl->z2 = NULL;
+        error("init_sos_lanes: couldn't malloc delays\n");
+        return (-1);
+    }
+
+    /* Pick the widest kernel this CPU can run */
+    pl->block = sos_lanes_block_c;
+#ifdef SOS_LANES_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        pl->block = sos_lanes_block_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        pl->block = sos_lanes_block_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        pl->block = sos_lanes_block_sse2;
+    }
+#endif
+
+    return (0);
+}
+
+/* Filter "l" samples of each of the pl->nch channels; in[c] and out[c] may be the same */
+void sos_filter_lanes( pSOS_LANE_FILTER pl, double *const in[], double *const out[], unsigned long l )
+{
+    double buf[SOS_LANE_BLOCK][SOS_LANES];
+    unsigned long pos, n, i;
+    int ch, c, lanes;
+    double *z1, *z2;
+
+    assert(pl->z1 != NULL);
+    assert(pl->z2 != NULL);
+
+    for (ch = 0; ch < pl->nch; ch += SOS_LANES)
+    {
+        lanes = (pl->nch - ch < SOS_LANES) ? pl->nch - ch : SOS_LANES;
+        z1 = pl->z1 + (size_t) (ch / SOS_LANES) * pl->pf->nsec * SOS_LANES;
+        z2 = pl->z2 + (size_t) (ch / SOS_LANES) * pl->pf->nsec * SOS_LANES;
+
+        for (pos = 0; pos < l; pos += n)
+        {
+            n = (l - pos < SOS_LANE_BLOCK) ? l - pos : SOS_LANE_BLOCK;
+
+            for (i = 0; i < n; i++)
+            {
+                for (c = 0; c < lanes; c++)
+                {
+                    buf[i][c] = in[ch + c][pos + i];
+                }
+                for (; c < SOS_LANES; c++)
+                {
+                    buf[i][c] = 0.0;
+                }
+            }
+
+            pl->block(pl->pf, z1, z2, buf, n);
+
+            for (i = 0; i < n; i++)
+            {
+                for (c = 0; c < lanes; c++)
+                {
+                    out[ch + c][pos + i] = buf[i][c];
+                }
+            }
+        }
+    }
+
+#ifdef DEBUG
+    {
+        unsigned long j;
+
+        for (ch = 0; ch < pl->nch; ch++)
+        {
+            for (j = 0; j < l; j++)
+            {
+                debugSample( out[ch][j] );
+            }
+        }
+    }
+#endif
+}
+
+void free_sos_lanes( pSOS_LANE_FILTER pl )
+{
+    free(pl->z1);
+    free(pl->z2);
+    pl->z1 = NULL;
+    pl->z2 = NULL;
 }
 
 void write_coef( pSOS_FILTER pf, double a0, double a1, double a2, double b0, double b1, double b2 )
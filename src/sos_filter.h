@@ -32,6 +32,9 @@
 #ifndef __SOS_FILTER_H__
 #define __SOS_FILTER_H__
 
+/* A cascade: its coefficients and a delay line.  The coefficient tables (dr_filters.c,
+ * ta_filters.c, iir_design.c) are shared, read-only, and have no delay line; every user
+ * runs its own instance of one (init_sos_instance()) */
 typedef struct sos_filter
 {
 	int nsec;
@@ -46,9 +49,27 @@ typedef struct sos_filter
 } SOS_FILTER, *pSOS_FILTER;
 
 extern int init_sos_filter( pSOS_FILTER pf );
+int init_sos_instance( pSOS_FILTER pf, const SOS_FILTER *coef );
 void reset_sos_filter( pSOS_FILTER pf );
 void sos_filter_array( double *in, pSOS_FILTER pfilt, double *out, unsigned long l );
 void write_coef( pSOS_FILTER pf , double a0, double a1, double a2, double b0, double b1, double b2 );
 int free_sos_filter( pSOS_FILTER pf );
 
+/* One cascade run over several channels at once, a channel per vector lane */
+#define SOS_LANES   ( 8 )
+
+typedef struct sos_lanes
+{
+	const SOS_FILTER *pf;       /* coefficients, the same for every channel */
+	int nch;
+
+	double *z1;                 /* delays per group of SOS_LANES channels: [group][nsec][SOS_LANES] */
+	double *z2;
+	void (*block)( const SOS_FILTER *pf, double *z1, double *z2, double (*buf)[SOS_LANES], unsigned long l );
+} SOS_LANE_FILTER, *pSOS_LANE_FILTER;
+
+int init_sos_lanes( pSOS_LANE_FILTER pl, const SOS_FILTER *pf, int nch );
+void sos_filter_lanes( pSOS_LANE_FILTER pl, double *const in[], double *const out[], unsigned long l );
+void free_sos_lanes( pSOS_LANE_FILTER pl );
+
 #endif /* __SOS_FILTER_H__ */
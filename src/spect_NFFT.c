@@ -143,10 +143,11 @@ int fft_avg_NFFT( pfstruct pfs, double *po, int *data_sz )
 	long block_size = 0;    // one second, 1 Hz resolution
 	long block_count = 0;
 	long total_block = 0;
-	SATS_FFT_Complex *fft_out;
+	SATS_FFT_Complex *fft_out, *pb;
 	SATS_FFT_HANDLE fft_handle;
 	SATS_FFT_Status fft_status;
 	int i;
+	int b, nbatch, queued;     /* frames per FFT batch, frames waiting in pd */
 	double mag = 0.0;
 	double *pi, *pw, *pd, *pfft;
 	double wf;
@@ -154,7 +155,7 @@ int fft_avg_NFFT( pfstruct pfs, double *po, int *data_sz )
 	int fft_output_size = 0;
 	double min_rms_db;
 	long overlaping_samples = 0;
-	long start_pos = 0;
+	__int64 start_pos = 0;
 
 	if (pfs->minPowerSet == 1)
 	{
@@ -231,19 +232,23 @@ int fft_avg_NFFT( pfstruct pfs, double *po, int *data_sz )
 	/*-- Computing window compensation --*/
 	wf = compute_window_comp( pw, block_size );
 
+	/*-- spectrum_NFFT averages overlapping frames, which can be transformed in batches;
+	     spectrogram and mel_scale reposition the file after every frame --*/
+	nbatch = (strcmp(pfs->tool,"spectrum_NFFT") == 0) ? SATS_FFT_BatchSize( block_size ) : 1;
+
 	/*-- storage buffer for windowed samples --*/
-	pd = (double *)SATS_FFT_malloc( block_size * sizeof( double ), BUFFER_ALLIGN );
+	pd = (double *)SATS_FFT_malloc( nbatch * block_size * sizeof( double ), BUFFER_ALLIGN );
 	if ( pd == NULL ) exit( -24 );
 
 	/*-- zeroing out windowed samples buffer --*/
-	for (i=0;i<(int)block_size;i++) pd[i]=0.0;
+	for (i=0;i<(int)(nbatch * block_size);i++) pd[i]=0.0;
 
 	/*-- storage buffer for fft output data --*/
-	fft_out = SATS_FFT_malloc ( sizeof ( SATS_FFT_Complex ) * fft_output_size, BUFFER_ALLIGN );
+	fft_out = SATS_FFT_malloc ( sizeof ( SATS_FFT_Complex ) * fft_output_size * nbatch, BUFFER_ALLIGN );
 	if ( fft_out == NULL ) exit( -25 );
 
 	/*-- zeroing out output data buffer --*/
-	for (i=0;i<fft_output_size;i++)
+	for (i=0;i<fft_output_size*nbatch;i++)
 	{
 		SATS_FFT_REAL(fft_out[i])=0.0;
 		SATS_FFT_IMAG(fft_out[i])=0.0;
@@ -275,49 +280,64 @@ int fft_avg_NFFT( pfstruct pfs, double *po, int *data_sz )
 
 	/*-- initializing block counter --*/
 	block_count = 0;
+	queued = 0;
 
 	//while( pfs->data_size == block_size / 2 )
 	while( (pfs->data_size == (block_size / 2) ) &&  ((long)block_count < total_block ) )
 	{
-		/*-- windowing input samples --*/
-		window_array( pi, pw, pd, block_size );
-
-		/*-- executing the fft on the windowed input samples --*/
-		fft_status = SATS_FFT_ComputeForward( fft_handle, pd, fft_out);
+		/*-- windowing input samples into the next free slot of the batch --*/
+		window_array( pi, pw, &pd[queued * block_size], block_size );
+		queued++;
+		block_count++;
 
-		if (strcmp(pfs->tool,"mel_scale") == 0)
+		if (strcmp(pfs->tool,"spectrum_NFFT") == 0)
 		{
-			for ( i = 0; i < fft_output_size; i++ )
-			{
-				re = SATS_FFT_REAL(fft_out[i]);
-				im = SATS_FFT_IMAG(fft_out[i]);
-				mag = ( re * re ) + ( im * im );    // calculate power
-				mag = mag * 2.0;                    // compensate for one sided fft
-				mag = mag / ( wf );
-				//if (mag > 1.0 )
-				//pfft[i] = 1.0;
-				//else if (mag < -1.0)
-				//pfft[i] = -1.0;
-				//else
-				pfft[i] = mag ;
-			}
-			mel_init(fft_output_size, N_MEL_BANDS);
-			mel_spec(po, pfft);
+			fio_read( pfs, block_size / 2 );
 		}
-		else
+
+		/*-- executing the fft on the queued windows once the batch is full or no more blocks follow --*/
+		if ( (queued == nbatch) || (pfs->data_size != block_size / 2) || ((long)block_count >= total_block) )
 		{
-			for ( i = 0; i < fft_output_size; i++ )
+			fft_status = SATS_FFT_ComputeForwardBatch( fft_handle, pd, block_size, fft_out, fft_output_size, queued );
+
+			for ( b = 0; b < queued; b++ )
 			{
-				re = SATS_FFT_REAL(fft_out[i]);
-				im = SATS_FFT_IMAG(fft_out[i]);
-				mag = ( re * re ) + ( im * im );    // calculate power
-				mag = mag * 2.0;                    // compensate for one sided fft
-				mag = mag / ( pfs->fs * wf * block_size );    //    window compensation
-				po[i] = po[i] + mag;
+				pb = &fft_out[b * fft_output_size];
+
+				if (strcmp(pfs->tool,"mel_scale") == 0)
+				{
+					for ( i = 0; i < fft_output_size; i++ )
+					{
+						re = SATS_FFT_REAL(pb[i]);
+						im = SATS_FFT_IMAG(pb[i]);
+						mag = ( re * re ) + ( im * im );    // calculate power
+						mag = mag * 2.0;                    // compensate for one sided fft
+						mag = mag / ( wf );
+						//if (mag > 1.0 )
+						//pfft[i] = 1.0;
+						//else if (mag < -1.0)
+						//pfft[i] = -1.0;
+						//else
+						pfft[i] = mag ;
+					}
+					mel_init(fft_output_size, N_MEL_BANDS);
+					mel_spec(po, pfft);
+				}
+				else
+				{
+					for ( i = 0; i < fft_output_size; i++ )
+					{
+						re = SATS_FFT_REAL(pb[i]);
+						im = SATS_FFT_IMAG(pb[i]);
+						mag = ( re * re ) + ( im * im );    // calculate power
+						mag = mag * 2.0;                    // compensate for one sided fft
+						mag = mag / ( pfs->fs * wf * block_size );    //    window compensation
+						po[i] = po[i] + mag;
+					}
+				}
 			}
+			queued = 0;
 		}
-
-		block_count++;
 		/*Decide the next position to begin file reading only to be done for spectrogram tool.*/
 		if ((strcmp(pfs->tool, "spectrogram") == 0)||( strcmp(pfs->tool, "mel_scale") == 0) )
 		{
@@ -329,7 +349,6 @@ int fft_avg_NFFT( pfstruct pfs, double *po, int *data_sz )
 
 		if (strcmp(pfs->tool,"spectrum_NFFT") == 0)
 		{
-			fio_read( pfs, block_size / 2 );
 			/*-- checking if we ran out of input sampls --*/
 			if ( pfs->data_size != block_size / 2 )
 				break;
@@ -44,10 +44,9 @@
 extern void print_usage( void );
 
 char *chart = "title, Spectrum Average,\nxlabel, Frequency (Hz),\nylabel, Amplitude (dBFS),\nxlog,\n";
-fstruct fst; 
-
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res; /*variable to store temporary value while argument parsing*/
     int startCh, endCh; 
     int ch; /*intermediate channel number*/
@@ -112,13 +111,17 @@ void print_usage( void )
     fprintf(stderr, "Spectrum Average Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: spectrum_avg [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: spectrum_avg [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multi-channel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf(stderr, "                    -c a for all channels\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
     fprintf(stderr, "-powermin <lim>,    select dB level to which very low power values will be clipped\n");
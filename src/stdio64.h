@@ -50,9 +50,13 @@ __int64 _ftelli64(FILE *);
 #define fseeko _fseeki64
 #define ftello _ftelli64
 typedef __int64 off_t;
+#elif defined(__MINGW32__)
+#define fseeko fseeko64
+#define ftello ftello64
 #else
-#define fseeko fseek
-#define ftello ftell
+/* POSIX fseeko()/ftello() take an off_t, 64 bits wide on 32-bit builds given
+   -D_FILE_OFFSET_BITS=64 (it must be set before any system header, so the
+   x86 makefiles pass it) */
 #endif
 
 #endif /* __STDIO64_H__ */
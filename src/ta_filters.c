@@ -38,7 +38,7 @@
 #include "lp_coef.h"
 
 //	notch filter for 4kHz for 32kHz sample rate
-SOS_FILTER no_4k_32000 =
+const SOS_FILTER no_4k_32000 =
 	{
 	NO_4K_32000_NSEC,
 	no_4k_32000_bl,
@@ -50,7 +50,7 @@ SOS_FILTER no_4k_32000 =
 	};
 
 // bandpass filter for 32kHz sample rate
-SOS_FILTER bp_4k_32000 =
+const SOS_FILTER bp_4k_32000 =
 	{
 	BP_4K_32000_NSEC,
 	bp_4k_32000_bl,
@@ -62,7 +62,7 @@ SOS_FILTER bp_4k_32000 =
 	};
 
 //	notch filter for 4kHz for 44.1kHz sample rate
-SOS_FILTER no_4k_44100 =
+const SOS_FILTER no_4k_44100 =
 	{
 	NO_4K_44100_NSEC,
 	no_4k_44100_bl,
@@ -74,7 +74,7 @@ SOS_FILTER no_4k_44100 =
 	};
 
 // bandpass filter for 44.1kHz sample rate
-SOS_FILTER bp_4k_44100 =
+const SOS_FILTER bp_4k_44100 =
 	{
 	BP_4K_44100_NSEC,
 	bp_4k_44100_bl,
@@ -86,7 +86,7 @@ SOS_FILTER bp_4k_44100 =
 	};
 
 //	notch filter for 4kHz, then lowpass for 44.1kHz sample rate
-SOS_FILTER no_4k_lp_44100 =
+const SOS_FILTER no_4k_lp_44100 =
 	{
 	NO_4K_LP_44100_NSEC,
 	no_4k_lp_44100_bl,
@@ -98,7 +98,7 @@ SOS_FILTER no_4k_lp_44100 =
 	};
 
 // bandpass filter, then lowpass for 44.1kHz sample rate
-SOS_FILTER bp_4k_lp_44100 =
+const SOS_FILTER bp_4k_lp_44100 =
 	{
 	BP_4K_LP_44100_NSEC,
 	bp_4k_lp_44100_bl,
@@ -110,7 +110,7 @@ SOS_FILTER bp_4k_lp_44100 =
 	};
 
 //	notch filter for 4kHz
-SOS_FILTER no_4k_48000 =
+const SOS_FILTER no_4k_48000 =
 	{
 	NO_4K_48000_NSEC,
 	no_4k_48000_bl,
@@ -122,7 +122,7 @@ SOS_FILTER no_4k_48000 =
 	};
 
 // bandpass filter for 4kHz
-SOS_FILTER bp_4k_48000 =
+const SOS_FILTER bp_4k_48000 =
 	{
 	BP_4K_48000_NSEC,
 	bp_4k_48000_bl,
@@ -134,7 +134,7 @@ SOS_FILTER bp_4k_48000 =
 	};
 
 //	notch filter for 4kHz, then low pass
-SOS_FILTER no_4k_lp_48000 =
+const SOS_FILTER no_4k_lp_48000 =
 	{
 	NO_4K_LP_48000_NSEC,
 	no_4k_lp_48000_bl,
@@ -146,7 +146,7 @@ SOS_FILTER no_4k_lp_48000 =
 	};
 
 // bandpass filter for 4kHz, then low pass
-SOS_FILTER bp_4k_lp_48000 =
+const SOS_FILTER bp_4k_lp_48000 =
 	{
 	BP_4K_LP_48000_NSEC,
 	bp_4k_lp_48000_bl,
@@ -157,59 +157,3 @@ SOS_FILTER bp_4k_lp_48000 =
 	z2
 	};
 
-
-void init_ta_filters( void )
-{
-    if (init_sos_filter(&no_4k_32000))
-        exit(-10);
-    if (init_sos_filter(&bp_4k_32000))
-        exit(-10);
-
-    if (init_sos_filter(&no_4k_44100))
-        exit(-10);
-    if (init_sos_filter(&bp_4k_44100))
-        exit(-10);
-
-    if (init_sos_filter(&no_4k_lp_44100))
-        exit(-10);
-    if (init_sos_filter(&bp_4k_lp_44100))
-        exit(-10);
-
-    if (init_sos_filter(&no_4k_48000))
-        exit(-10);
-    if (init_sos_filter(&bp_4k_48000))
-        exit(-10);
-
-    if (init_sos_filter(&no_4k_lp_48000))
-        exit(-10);
-    if (init_sos_filter(&bp_4k_lp_48000))
-        exit(-10);
-}
-
-void free_ta_filters( void )
-{
-    if (free_sos_filter(&no_4k_32000))
-        exit(-10);
-    if (free_sos_filter(&bp_4k_32000))
-        exit(-10);
-
-    if (free_sos_filter(&no_4k_44100))
-        exit(-10);
-    if (free_sos_filter(&bp_4k_44100))
-        exit(-10);
-
-    if (free_sos_filter(&no_4k_lp_44100))
-        exit(-10);
-    if (free_sos_filter(&bp_4k_lp_44100))
-        exit(-10);
-
-    if (free_sos_filter(&no_4k_48000))
-        exit(-10);
-    if (free_sos_filter(&bp_4k_48000))
-        exit(-10);
-
-    if (free_sos_filter(&no_4k_lp_48000))
-        exit(-10);
-    if (free_sos_filter(&bp_4k_lp_48000))
-        exit(-10);
-}
@@ -33,22 +33,20 @@
 #define __DR_FILTERS_H__
 #include "sos_filter.h"
 
-extern SOS_FILTER no_4k_32000;
-extern SOS_FILTER bp_4k_32000;
+extern const SOS_FILTER no_4k_32000;
+extern const SOS_FILTER bp_4k_32000;
 
-extern SOS_FILTER no_4k_44100;
-extern SOS_FILTER bp_4k_44100;
+extern const SOS_FILTER no_4k_44100;
+extern const SOS_FILTER bp_4k_44100;
 
-extern SOS_FILTER no_4k_lp_44100;
-extern SOS_FILTER bp_4k_lp_44100;
+extern const SOS_FILTER no_4k_lp_44100;
+extern const SOS_FILTER bp_4k_lp_44100;
 
-extern SOS_FILTER no_4k_48000;
-extern SOS_FILTER bp_4k_48000;
+extern const SOS_FILTER no_4k_48000;
+extern const SOS_FILTER bp_4k_48000;
 
-extern SOS_FILTER no_4k_lp_48000;
-extern SOS_FILTER bp_4k_lp_48000;
+extern const SOS_FILTER no_4k_lp_48000;
+extern const SOS_FILTER bp_4k_lp_48000;
 
-void init_ta_filters( void );
-void free_ta_filters( void );
 
 #endif // __DR_FILTERS_H__
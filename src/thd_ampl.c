@@ -32,11 +32,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <assert.h>
 #include "fio.h"
 #include "thd_ampl.h"
 #include "power.h"
 #include "sos_filter.h"
 #include "ta_filters.h"
+#include "iir_design.h"
 #include "debug.h"
 #include "Utilities.h"
 
@@ -56,6 +58,23 @@ static int compare_rev( const void *p1, const void *p2 )
     return (0);
 }
 
+/* The 4 kHz notch (stop) or bandpass filter for the sample rate: the tables where there
+ * are some, otherwise designed for the rate (NULL if it can't be) */
+static const SOS_FILTER *ta_filter( int fs, int stop )
+{
+    switch (fs)
+    {
+        case 32000:
+            return (stop ? &no_4k_32000 : &bp_4k_32000);
+        case 44100:
+            return (stop ? &no_4k_lp_44100 : &bp_4k_lp_44100);
+        case 48000:
+            return (stop ? &no_4k_lp_48000 : &bp_4k_lp_48000);
+    }
+
+    return (iir_design_ta(fs, stop));
+}
+
 int thd_ampl( pfstruct pfs, int stop ) /*stop is 1 for stopband (THD) and 0 for passband (noise_mod)*/
 {
     unsigned long block_size = (long) ((double) pfs->fs * 0.05);
@@ -66,8 +85,19 @@ int thd_ampl( pfstruct pfs, int stop ) /*stop is 1 for stopband (THD) and 0 for
     pDUPLE pdum, pdu;
     int i, outsize;
     char *format = "%3.2lf,\t%3.2lf\n";
+    const SOS_FILTER *coef;
+    SOS_FILTER filter;
+    pSOS_FILTER pf = NULL;
 
-    init_ta_filters();
+    coef = ta_filter(pfs->fs, stop);
+    if (coef != NULL)
+    {
+        if (init_sos_instance(&filter, coef) != 0)
+        {
+            return (-1);
+        }
+        pf = &filter;
+    }
 
     strip_lead_silence(pfs);
 
@@ -87,26 +117,9 @@ int thd_ampl( pfstruct pfs, int stop ) /*stop is 1 for stopband (THD) and 0 for
         if (unfilt_db != -999.0)
             unfilt_db = unfilt_db + 3.01;
         //	filter
-        switch (pfs->fs)
+        if (pf != NULL)
         {
-            case 32000:
-                if (stop)
-                    sos_filter_array(pfs->data, &no_4k_32000, pd, pfs->data_size);
-                else
-                    sos_filter_array(pfs->data, &bp_4k_32000, pd, pfs->data_size);
-                break;
-            case 44100:
-                if (stop)
-                    sos_filter_array(pfs->data, &no_4k_lp_44100, pd, pfs->data_size);
-                else
-                    sos_filter_array(pfs->data, &bp_4k_lp_44100, pd, pfs->data_size);
-                break;
-            case 48000:
-                if (stop)
-                    sos_filter_array(pfs->data, &no_4k_lp_48000, pd, pfs->data_size);
-                else
-                    sos_filter_array(pfs->data, &bp_4k_lp_48000, pd, pfs->data_size);
-                break;
+            sos_filter_array(pfs->data, pf, pd, pfs->data_size);
         }
         filt_db = compute_power(pd, pfs->data_size);
         if (filt_db != -999.0)
@@ -137,7 +150,10 @@ int thd_ampl( pfstruct pfs, int stop ) /*stop is 1 for stopband (THD) and 0 for
         check( sdf_writer_add_data_float_float(pfs->sdf_out, (float) pdum[i].x, (float) pdum[i].y, format) );
     }
 
-    free_ta_filters();
+    if (pf != NULL)
+    {
+        free_sos_filter(pf);
+    }
     free(pdum);
     free(pd);
 
@@ -149,3 +165,132 @@ int thd_ampl( pfstruct pfs, int stop ) /*stop is 1 for stopband (THD) and 0 for
 
     return (0);
 }
+
+/* thd_ampl() for channels startCh to endCh - 1 of a file whose channels are all decoded
+ * (fio_planes_ready()), in one pass: each block of every channel is filtered in the
+ * same sos_filter_lanes() call.  The readings are sorted and written out a data chunk
+ * per channel afterwards, the same as thd_ampl() gives channel by channel.
+ */
+int thd_ampl_channels( pfstruct pfs, int stop, int startCh, int endCh )
+{
+    int nch = endCh - startCh;
+    unsigned long block_size = (long) ((double) pfs->fs * 0.05);
+    unsigned long block = 0;
+    double *pd;
+    double **in;
+    double **out;
+    double unfilt_db;
+    double filt_db;
+    pDUPLE pdum;
+    pDUPLE *pdu;
+    int i, ch, outsize, res = 0;
+    long nres = (long) ((pfs->size / pfs->fs) + 2);
+    __int64 pos;
+    char *format = "%3.2lf,\t%3.2lf\n";
+    const SOS_FILTER *pf;
+    SOS_LANE_FILTER lanes;
+
+    assert(pfs->planes != NULL);
+
+    check( fio_next_chunk(pfs, startCh) );
+    fio_resetpos(pfs);
+
+    pf = ta_filter(pfs->fs, stop);
+
+    //	buffers for samples, results and the channel pointers
+    pd = (double *) calloc((size_t) pfs->fs * nch, sizeof(double));
+    pdum = (pDUPLE) calloc(nres * nch, sizeof(DUPLE));
+    in = (double **) calloc(2 * nch, sizeof(double *));
+    pdu = (pDUPLE *) calloc(nch, sizeof(pDUPLE));
+    if (pd == NULL || pdum == NULL || in == NULL || pdu == NULL || (pf != NULL && init_sos_lanes(&lanes, pf, nch) != 0))
+    {
+        error("malloc failed in thd_ampl_channels\n");
+        free(pd);
+        free(pdum);
+        free(in);
+        free(pdu);
+        return (-1);
+    }
+    out = in + nch;
+    for (ch = 0; ch < nch; ch++)
+    {
+        pdu[ch] = pdum + ch * nres;
+    }
+
+    strip_lead_silence(pfs);
+
+    fio_read(pfs, block_size);
+
+    while (pfs->data_size == (long) block_size)
+    {
+        /* pfs->data is the first channel's block, the others are at the same place */
+        pos = pfs->position - pfs->data_size;
+        for (ch = 0; ch < nch; ch++)
+        {
+            in[ch] = pfs->planes[startCh + ch] + pos;
+            out[ch] = pd + ch * pfs->fs;
+        }
+
+        if (pf != NULL)
+        {
+            sos_filter_lanes(&lanes, in, out, block_size);
+        }
+
+        for (ch = 0; ch < nch; ch++)
+        {
+            //	level of the tone, then what the filter leaves
+            unfilt_db = compute_power(in[ch], block_size);
+            if (unfilt_db != -999.0)
+                unfilt_db = unfilt_db + 3.01;
+            filt_db = compute_power(out[ch], block_size);
+            if (filt_db != -999.0)
+                filt_db = filt_db + 3.01;
+            if (block != 0 && unfilt_db > -300.0 && filt_db > -300.0)
+            {
+                pdu[ch]->x = unfilt_db;
+                pdu[ch]->y = filt_db;
+                pdu[ch]++;
+            }
+        }
+        if (block == 0)
+        {
+            block_size = pfs->fs;
+        }
+
+        fio_read(pfs, block_size);
+        block++;
+    }
+
+    for (ch = 0; ch < nch && res == 0; ch++)
+    {
+        if (ch > 0)
+        {
+            check( fio_next_chunk(pfs, startCh + ch) );
+        }
+
+        outsize = (int) (pdu[ch] - (pdum + ch * nres));
+        qsort(pdum + ch * nres, outsize, sizeof(DUPLE), compare_rev); // descending sort, because of compare_rev
+
+        for (i = 0; i < outsize; i++)
+        {
+            check( sdf_writer_add_data_float_float(pfs->sdf_out, (float) pdum[ch * nres + i].x, (float) pdum[ch * nres + i].y, format) );
+        }
+
+        if (block == 0)
+        {
+            error("File too small\n");
+            res = -1;
+        }
+    }
+
+    if (pf != NULL)
+    {
+        free_sos_lanes(&lanes);
+    }
+    free(pd);
+    free(pdum);
+    free(in);
+    free(pdu);
+
+    return (res);
+}
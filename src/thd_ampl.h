@@ -40,4 +40,8 @@ typedef struct
 
 int thd_ampl( pfstruct pfs, int stop );/*stop is 1 for stopband (THD) and 0 for passband (noise_mod)*/
 
+/* thd_ampl() for channels startCh to endCh - 1 in one pass, each in its own data chunk;
+ * every channel must be decoded already (fio_planes_ready()) */
+int thd_ampl_channels( pfstruct pfs, int stop, int startCh, int endCh );
+
 #endif //__THD_AMPL_H__
@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	thd_freq.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	thd_freq.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <stdio.h>
@@ -34,6 +34,7 @@
 #include <math.h>
 #include <limits.h>
 #include <stdarg.h>
+#include <string.h>
 #include <assert.h>
 #include "fio.h"
 #include "thd_freq.h"
@@ -42,6 +43,7 @@
 #include "power.h"
 #include "sos_filter.h"
 #include "dr_filters.h"
+#include "iir_design.h"
 #include "debug.h"
 #include "Utilities.h"
 #include "settling.h"
@@ -50,8 +52,22 @@
 #define MAX_REAL	+HUGE_VAL
 #define PI			3.141592653589793
 
+#if defined(__unix__) || defined(__APPLE__)
+#define THD_FREQ_THREADS 1
+#include <pthread.h>
+#endif
+#define THD_FREQ_THREADS_MAX    64      /* most worker threads thd_freq() starts (-j) */
+
 static void thdfreq_debug( char *fmt, ... );
 static void thdfilt_debug( char *fmt, ... );
+static const SOS_FILTER *thd_lp_filter( double fs );
+static int thd_filter_state( pSOS_FILTER pf, const SOS_FILTER *coef, workspace_t *ws );
+static int thd_freq_dwell( pfstruct pfs, double points[DWELLS_MAX][THDFREQ_POINTS], int nrows, workspace_t *ws, int *settle_point, double block_end, double new_block_start, double c_freq );
+static int thd_freq_measure( thd_freq_mode mode, double *data, int data_len, double c_freq, double fs, workspace_t *ws, double *reading_db );
+static void thd_freq_result( double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows, double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows,
+                             double c_freq, int success, double reading_db, double min_rms_db );
+static int thd_freq_parallel( pfstruct pfs, thd_freq_mode mode, double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows,
+                              double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows, double min_rms_db, fchange_map_t *map, workspace_t *ws );
 
 static void thdfreq_debug( char *fmt, ... )
 {
@@ -102,6 +118,12 @@ static void thdfilt_debug( char *fmt, ... )
  *          Results are returned via arrays.  Pointers to the results and "bad dwells"
  *          arrays are passed in.
  *
+ *          The scratch memory of the dwell search and measurements comes from one
+ *          workspace, created here and reused for every dwell of the channel.
+ *
+ *          With -dwells, the dwells of an earlier run on the same input are taken from
+ *          the dwell map file instead of searched for, or saved there, see fchange_map_load().
+ *
  * @param   pfs                 IN: Pointer to file structure
  * @param   mode                IN: Selects either THD Vs Freq, or Freq Resp tool
  * @param   points              OUT: Pointer to results array
@@ -118,19 +140,14 @@ int thd_freq( pfstruct pfs, thd_freq_mode mode, double points[DWELLS_MAX][THDFRE
     double new_block_start = 0.0;       /* Dwell start */
     double c_freq = 0.0;                /* Reference frequency */
     double reading_db = 0.0;            /* Reading in dB */
-    double pred_freq = 0.0;             /* Predicted frequency */
     int data_len = 0;                   /* Length of audio chunk being processed */
     int success = 0;                    /* Flag for find a center frequency in dwell */
-    double lower_limit = 0.0;           /* Threshold Lower Limit for difference between predicted and actual center frequency */
-    double upper_limit = 0.0;           /* Threshold Upper Limit for difference between predicted and actual center frequency */
-    double min_size = 0.0;
     double min_rms_db = 0.0;
+    workspace_t ws = { NULL, NULL, 0, 0 };  /* scratch for the dwell search and measurements */
+    fchange_map_t map;                  /* dwells saved by an earlier run, see -dwells */
 
     thdfreq_debug("START----\n");
 
-    /* Initalizing filter coefficients */
-    init_dr_filters();
-
     /* Stripping lead silence of input .wav file.  strip_lead_silence() will only
      * leave pfs->position set to the index following the end of the silence.
      */
@@ -153,110 +170,518 @@ int thd_freq( pfstruct pfs, thd_freq_mode mode, double points[DWELLS_MAX][THDFRE
      /*Computing minimum representable dB level for the bit depth of the signal*/
       min_rms_db = 0.0 - floor(20*log10(pow(2, pfs->bitspersamp)));
     }
-    /* fio_read() copies audio data from the file into memory pointed to by
-     * pfs->data.  Audio is copied from pfs->position (i.e. following silence)
-     * through to the end of the file.  From here on, pfs->data_position is used
+    /* The audio from pfs->position (i.e. following silence) through to the end of
+     * the file is accessed through a window, see fio_window_open(), which keeps only
+     * the dwells being worked on in memory.  From here on, pfs->data_position is used
      * to index into the "current position" of the audio.  pfs->position is not
      * used from here on.
      */
-    fio_read(pfs, pfs->size - pfs->position);
+    fio_window_open(pfs);
 
-    /* Set the minimum size (half a second) */
-    min_size = pfs->fs * .5;
+    /* With -dwells, the dwells may be known already, in which case there is no search */
+    fchange_map_load(pfs, &map);
 
-    /* Finding all the dwells by searching for change in frequencies */
-    find_next_fchange(pfs, &settle_point, &block_end, &new_block_start, &c_freq);
+    /* Size the workspace for the search; it grows only for a dwell longer than any before */
+    check( workspace_reserve(&ws, find_next_fchange_workspace(pfs->fs)) );
+
+    /* With -j, the dwells are measured by a pool of threads instead */
+    if (pfs->threads > 1 && thd_freq_parallel(pfs, mode, points, nrows, bad_dwells, bad_dwells_nrows, min_rms_db, &map, &ws) == 0)
+    {
+        c_freq = 0.0;
+    }
+    else
+    {
+        /* Finding all the dwells by searching for change in frequencies */
+        fchange_map_next(pfs, &map, &ws, &settle_point, &block_end, &new_block_start, &c_freq);
+        workspace_reset(&ws);
+    }
 
     while (c_freq > 0)
     {
-        /* After two valid points are gathered then can start using existing points for predicting the next center frequency */
+        data_len = thd_freq_dwell(pfs, points, *nrows, &ws, &settle_point, block_end, new_block_start, c_freq);
+        if (data_len > 0)
+        {
+            success = thd_freq_measure(mode, (double *) fio_window_get(pfs, settle_point, data_len), data_len, c_freq, pfs->fs, &ws, &reading_db);
+            thd_freq_result(points, nrows, bad_dwells, bad_dwells_nrows, c_freq, success, reading_db, min_rms_db);
+        }
+
+        /* Advance data_position for the next block; the audio before it is done with */
+        pfs->data_position = (__int64) new_block_start;
+        fio_window_release(pfs, pfs->data_position);
+
+        /* Finds next frequency change */
+        fchange_map_next(pfs, &map, &ws, &settle_point, &block_end, &new_block_start, &c_freq);
+        workspace_reset(&ws);
+
+    } /* End of while loop */
+
+    /* prints out all elements in point array ( these elements are the content of a .res file ) */
+    write_to_file(points, nrows, pfs);
+
+    fchange_map_save(pfs, &map);
+    fchange_map_free(&map);
+    fio_window_close(pfs);
+    workspace_free(&ws);
+
+    thdfreq_debug("END----\n");
+    return(0);
+}
 
-        if (*nrows > 2)
+/**
+ * @brief   Decide what to measure of a dwell found by find_next_fchange()
+ *
+ * @details After two valid points are gathered, a dwell whose frequency isn't near
+ *          the one predicted from them (see pchip_interp()) is rejected.  A dwell that
+ *          is rejected, or too short, isn't measured.
+ *
+ * @param   pfs                 IN: Pointer to file structure
+ * @param   points              IN: Results so far
+ * @param   nrows               IN: Length of results array
+ * @param   ws                  IN/OUT: Scratch for the prediction
+ * @param   settle_point        IN/OUT: Settling point of the dwell, moved to its end if rejected
+ * @param   block_end           IN: Dwell end
+ * @param   new_block_start     IN: Start of the next dwell
+ * @param   c_freq              IN: Frequency of the dwell
+ *
+ * @return  Returns the number of samples to measure from settle_point, 0 if none.
+ */
+static int thd_freq_dwell( pfstruct pfs, double points[DWELLS_MAX][THDFREQ_POINTS], int nrows, workspace_t *ws, int *settle_point, double block_end, double new_block_start, double c_freq )
+{
+    double pred_freq = 0.0;             /* Predicted frequency */
+    double lower_limit = 0.0;           /* Threshold Lower Limit for difference between predicted and actual center frequency */
+    double upper_limit = 0.0;           /* Threshold Upper Limit for difference between predicted and actual center frequency */
+    double min_size = pfs->fs * .5;     /* the minimum size (half a second) */
+
+    /* After two valid points are gathered then can start using existing points for predicting the next center frequency */
+    if (nrows > 2)
+    {
+        /* Piecewise Hermite Interpolation function that will predict the next fundamental frequency */
+        check( workspace_reserve(ws, pchip_interp_workspace(nrows)) );
+        pred_freq = pchip_interp(points, nrows, nrows, ws);
+        workspace_reset(ws);
+
+        /* Setting the lower and upper limits so they can be used to gauge the validity of the next center frequency */
+        if (pred_freq > points[nrows][0])
+        {
+            lower_limit = max_d(pred_freq * 0.9, points[nrows - 1][0]);
+            upper_limit = min_d(pred_freq * 1.1, 20000);
+        }
+        else
         {
-            /* Piecewise Hermite Interpolation function that will predict the next fundamental frequency */
-            pred_freq = pchip_interp(points, *nrows, *nrows);
+            lower_limit = max_d(pred_freq * 0.9, 20);
+            upper_limit = min_d(pred_freq * 1.1, points[nrows - 1][0]);
+        }
+        thdfreq_debug("Next predicted frequency:\t %.0fHz \t (%.0f - %.0fHz)\n", pred_freq, lower_limit, upper_limit);
 
-            /* Setting the lower and upper limits so they can be used to gauge the validity of the next center frequency */
-            if (pred_freq > points[*nrows][0])
-            {
-                lower_limit = max_d(pred_freq * 0.9, points[*nrows - 1][0]);
-                upper_limit = min_d(pred_freq * 1.1, 20000);
-            }
-            else
-            {
-                lower_limit = max_d(pred_freq * 0.9, 20);
-                upper_limit = min_d(pred_freq * 1.1, points[*nrows - 1][0]);
-            }
-            thdfreq_debug("Next predicted frequency:\t %.0fHz \t (%.0f - %.0fHz)\n", pred_freq, lower_limit, upper_limit);
+        /* Actual Center Frequency is not within limits */
+        if ((c_freq < lower_limit) || (c_freq > upper_limit))
+        {
+            *settle_point = (int) block_end;
+            thdfreq_debug("Rejected Frequency %.0fHz\n", c_freq);
+        }
+    }
 
-            /* Actual Center Frequency is not within limits */
-            if ((c_freq < lower_limit) || (c_freq > upper_limit))
-            {
-                settle_point = (int) block_end;
-                thdfreq_debug("Rejected Frequency %.0fHz\n", c_freq);
-            }
+    thdfreq_debug("...Settling point:      %.2fs   [%d]\n", ((double) *settle_point)/((double) pfs->fs) , *settle_point);
+    thdfreq_debug("...End of block:        %.2fs   [%d]\n", ((double) block_end)/((double) pfs->fs) , (int) block_end);
+    thdfreq_debug("...Start of next block: %.2fs   [%d]\n", ((double) new_block_start)/((double) pfs->fs) , (int) new_block_start);
+    thdfreq_debug("...Next frequency:      %.0fHz\n", c_freq);
+
+    /* Checks to see if there is next dwell has enough data */
+    if (( block_end - ( (int) *settle_point )) < ( (int) min_size ))
+    {
+        thdfreq_debug("Out of data!!!\n");
+        return (0);
+    }
+
+    /* Determine the length of the audio chunk to process */
+    return (((int) block_end) - *settle_point);
+}
+
+/**
+ * @brief   Measure a dwell, with thd_filt() or freq_resp() depending on the mode
+ *
+ * @param   mode                IN: Selects either THD Vs Freq, or Freq Resp tool
+ * @param   data                IN: Audio of the dwell, from its settling point
+ * @param   data_len            IN: Length of audio data
+ * @param   c_freq              IN: Frequency of the dwell
+ * @param   fs                  IN: Sampling rate in Hz
+ * @param   ws                  IN/OUT: Scratch for the measurement
+ * @param   reading_db          OUT: Pointer to measured value in dB
+ *
+ * @return  Returns 0 if successful.  -1 otherwise.
+ */
+static int thd_freq_measure( thd_freq_mode mode, double *data, int data_len, double c_freq, double fs, workspace_t *ws, double *reading_db )
+{
+    int success;
+
+    /* Checks weather if we are doing thd_vs_freq or freq_resp test */
+    if (mode == THD_VS_FREQ)
+    {
+        check( workspace_reserve(ws, thd_filt_workspace(data_len, fs)) );
+        success = thd_filt(data, data_len, c_freq, fs, ws, reading_db);
+        workspace_reset(ws);
+        thdfreq_debug("thd_filt() returned %d\n\n", success);
+    }
+    else
+    {
+        success = freq_resp(data, data_len, reading_db);
+        thdfreq_debug("freq_resp() returned %d\n\n", success);
+    }
+    return (success);
+}
+
+/* Found a valid center frequency and now is adding to points array else adds result to invalid array (bad_dwells) */
+static void thd_freq_result( double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows, double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows,
+                             double c_freq, int success, double reading_db, double min_rms_db )
+{
+    if (success == 0)
+    {
+        if (reading_db < min_rms_db)
+        {
+            reading_db = min_rms_db;
+        }
+        add_points(points, nrows, c_freq, reading_db);
+    }
+    else
+    {
+        add_bad_dwells(bad_dwells, bad_dwells_nrows, c_freq);
+    }
+}
+
+#ifdef THD_FREQ_THREADS
+/* Parallel dwell measurement (-j): find_next_fchange() and thd_freq_dwell() stay on the
+ * calling thread, in order, and hand each dwell to be measured, with a copy of its audio,
+ * to a pool of worker threads, each with its own workspace.  Whether a dwell is measured
+ * at all depends on which of the dwells before it measured successfully, so every
+ * measurement is taken to succeed until its result is in: the dwell goes into the points
+ * array straight away and the result is filled in as the dwells are committed, in order.
+ * A measurement that failed has the dwells after it decided again, on the calling thread,
+ * reusing the measurements that still apply; which is why the window is only released up
+ * to the oldest dwell not committed yet.  The results are the same as without -j.
+ */
+enum { DWELL_QUEUED, DWELL_BUSY, DWELL_DONE };
+
+typedef struct
+{
+    int found_settle_point;     /* as find_next_fchange() returned it */
+    double block_end;
+    double new_block_start;
+    double c_freq;
+    int settle_point;           /* as thd_freq_dwell() left it */
+    int data_len;               /* samples measured from settle_point, 0 if not measured */
+    int row;                    /* row of the points array it went into, if measured */
+    double *data;               /* copy of the samples measured */
+    int state;                  /* DWELL_xxx */
+    int success;                /* thd_freq_measure() result */
+    double reading_db;
+} thd_dwell_t;
+
+typedef struct
+{
+    pthread_t thread[THD_FREQ_THREADS_MAX];
+    int nthreads;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* a dwell was added or measured, or quit was set */
+    int quit;
+
+    pfstruct pfs;
+    thd_freq_mode mode;
+    double (*points)[THDFREQ_POINTS];
+    int *nrows;
+    double *bad_dwells;
+    int *bad_dwells_nrows;
+    double min_rms_db;
+
+    thd_dwell_t *dwell;         /* ring of ndwell */
+    int ndwell;
+    long head;                  /* oldest dwell not committed */
+    long next;                  /* next dwell a worker looks at */
+    long tail;                  /* where the next dwell found goes */
+} thd_pool_t;
+
+static
+void *thd_pool_worker( void *arg )
+{
+    thd_pool_t *pool = (thd_pool_t *) arg;
+    workspace_t ws = { NULL, NULL, 0, 0 };
+    thd_dwell_t *d;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (pool->next < pool->tail && pool->dwell[pool->next % pool->ndwell].state != DWELL_QUEUED)
+        {
+            pool->next++;
         }
+        if (pool->next < pool->tail)
+        {
+            d = &pool->dwell[pool->next % pool->ndwell];
+            d->state = DWELL_BUSY;
+            pool->next++;
+            pthread_mutex_unlock(&pool->lock);
 
-        thdfreq_debug("...Settling point:      %.2fs   [%d]\n", ((double) settle_point)/((double) pfs->fs) , settle_point);
-        thdfreq_debug("...End of block:        %.2fs   [%d]\n", ((double) block_end)/((double) pfs->fs) , (int) block_end);
-        thdfreq_debug("...Start of next block: %.2fs   [%d]\n", ((double) new_block_start)/((double) pfs->fs) , (int) new_block_start);
-        thdfreq_debug("...Next frequency:      %.0fHz\n", c_freq);
+            d->success = thd_freq_measure(pool->mode, d->data, d->data_len, d->c_freq, pool->pfs->fs, &ws, &d->reading_db);
 
-        /* Checks to see if there is next dwell has enough data if not then reset file position */
-        if (( block_end - ( (int) settle_point )) < ( (int) min_size ))
+            pthread_mutex_lock(&pool->lock);
+            d->state = DWELL_DONE;
+            pthread_cond_broadcast(&pool->cond);
+        }
+        else if (pool->quit)
         {
-            thdfreq_debug("Out of data!!!\n");
+            break;
         }
         else
         {
-            /* Determine the length of the audio chunk to process */
-            data_len = ((int) block_end) - settle_point;
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    workspace_free(&ws);
+    return (NULL);
+}
+
+/* Take the next dwell found by find_next_fchange() */
+static
+void thd_pool_add( thd_pool_t *pool, workspace_t *ws, int settle_point, double block_end, double new_block_start, double c_freq )
+{
+    thd_dwell_t *d = &pool->dwell[pool->tail % pool->ndwell];
+
+    d->found_settle_point = settle_point;
+    d->block_end = block_end;
+    d->new_block_start = new_block_start;
+    d->c_freq = c_freq;
+    d->settle_point = settle_point;
+    d->data_len = thd_freq_dwell(pool->pfs, pool->points, *pool->nrows, ws, &d->settle_point, block_end, new_block_start, c_freq);
+    d->row = *pool->nrows;
+    d->state = DWELL_DONE;
+
+    if (d->data_len > 0)
+    {
+        if ((d->data = (double *) malloc(d->data_len * sizeof(double))) == NULL)
+        {
+            error("Out of memory for %d samples\n", d->data_len);
+            exit(1);
+        }
+        memcpy(d->data, fio_window_get(pool->pfs, d->settle_point, d->data_len), d->data_len * sizeof(double));
+
+        /* taken to succeed, the reading is filled in by thd_pool_commit() */
+        add_points(pool->points, pool->nrows, c_freq, 0.0);
+        d->state = DWELL_QUEUED;
+    }
 
-            /* Checks weather if we are doing thd_vs_freq or freq_resp test */
-            if (mode == THD_VS_FREQ)
+    pthread_mutex_lock(&pool->lock);
+    pool->tail++;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* The measurement of the dwell at the head failed, and the dwells after it were decided
+ * assuming it wouldn't: wait for their measurements and go through them again in order,
+ * as thd_freq() does without threads.  Commits every dwell.
+ */
+static
+void thd_pool_redo( thd_pool_t *pool, workspace_t *ws )
+{
+    thd_dwell_t *d = &pool->dwell[pool->head % pool->ndwell];
+    thd_dwell_t *e;
+    pfstruct pfs = pool->pfs;
+    int settle_point;
+    int data_len;
+    int success;
+    double reading_db;
+    long i;
+    int row;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = pool->head; i < pool->tail; i++)
+    {
+        while (pool->dwell[i % pool->ndwell].state != DWELL_DONE)
+        {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    /* Back to the points as they were before it; the callers clear the array */
+    for (row = d->row; row < *pool->nrows; row++)
+    {
+        pool->points[row][0] = 0.0;
+        pool->points[row][1] = 0.0;
+    }
+    *pool->nrows = d->row;
+    add_bad_dwells(pool->bad_dwells, pool->bad_dwells_nrows, d->c_freq);
+    free(d->data);
+    d->data = NULL;
+
+    for (i = pool->head + 1; i < pool->tail; i++)
+    {
+        e = &pool->dwell[i % pool->ndwell];
+        settle_point = e->found_settle_point;
+        data_len = thd_freq_dwell(pfs, pool->points, *pool->nrows, ws, &settle_point, e->block_end, e->new_block_start, e->c_freq);
+        if (data_len > 0)
+        {
+            if (settle_point == e->settle_point && data_len == e->data_len)
             {
-                success = thd_filt(&pfs->data[settle_point], data_len, c_freq, pfs->fs, &reading_db);
-                thdfreq_debug("thd_filt() returned %d\n\n", success);
+                success = e->success;
+                reading_db = e->reading_db;
             }
             else
             {
-                success = freq_resp(&pfs->data[settle_point], data_len, &reading_db);
-                thdfreq_debug("freq_resp() returned %d\n\n", success);
+                success = thd_freq_measure(pool->mode, (double *) fio_window_get(pfs, settle_point, data_len), data_len, e->c_freq, pfs->fs, ws, &reading_db);
             }
+            thd_freq_result(pool->points, pool->nrows, pool->bad_dwells, pool->bad_dwells_nrows, e->c_freq, success, reading_db, pool->min_rms_db);
+        }
+        free(e->data);
+        e->data = NULL;
+    }
+    pool->head = pool->tail;
+}
 
-            /* Found a valid center frequency and now is adding to points array else adds result to invalid array (bad_dwells) */
-            if (success == 0)
-            {
-                if (reading_db < min_rms_db)
-                 {
-                	reading_db = min_rms_db;
-                 }
-                add_points(points, nrows, c_freq, reading_db);
-            }
-            else
+/* Commit the dwells up to "until", waiting for their measurements, and any measured
+ * already after that */
+static
+void thd_pool_commit( thd_pool_t *pool, workspace_t *ws, long until )
+{
+    thd_dwell_t *d;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->head < pool->tail)
+    {
+        d = &pool->dwell[pool->head % pool->ndwell];
+        if (d->state != DWELL_DONE)
+        {
+            if (pool->head >= until)
             {
-                add_bad_dwells(bad_dwells, bad_dwells_nrows, c_freq);
+                break;
             }
-
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            continue;
         }
+        if (d->data_len > 0 && d->success != 0)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            thd_pool_redo(pool, ws);
+            return;
+        }
+        if (d->data_len > 0)
+        {
+            pool->points[d->row][1] = (d->reading_db < pool->min_rms_db) ? pool->min_rms_db : d->reading_db;
+            free(d->data);
+            d->data = NULL;
+        }
+        pool->head++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief   Find and measure the dwells as thd_freq() does, measuring them in parallel
+ *
+ * @details Uses pfs->threads worker threads, see above.
+ *
+ * @return  Returns 0 if successful.  -1, before anything is done, if the threads could
+ *          not be started, in which case thd_freq() carries on without them.
+ */
+static int thd_freq_parallel( pfstruct pfs, thd_freq_mode mode, double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows,
+                              double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows, double min_rms_db, fchange_map_t *map, workspace_t *ws )
+{
+    thd_pool_t pool;
+    int settle_point = 0;
+    double block_end = 0.0;
+    double new_block_start = 0.0;
+    double c_freq = 0.0;
+    double keep;
+    int i;
 
-        /* Advance data_position for the next block */
-        pfs->data_position = (int) new_block_start;
+    memset(&pool, 0, sizeof(pool));
+    pool.pfs = pfs;
+    pool.mode = mode;
+    pool.points = points;
+    pool.nrows = nrows;
+    pool.bad_dwells = bad_dwells;
+    pool.bad_dwells_nrows = bad_dwells_nrows;
+    pool.min_rms_db = min_rms_db;
+
+    /* a few dwells per thread in hand, so none of them waits for the search */
+    pool.ndwell = 4 * imin(pfs->threads, THD_FREQ_THREADS_MAX);
+    if ((pool.dwell = (thd_dwell_t *) calloc(pool.ndwell, sizeof(thd_dwell_t))) == NULL)
+    {
+        return (-1);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+    for (i = 0; i < imin(pfs->threads, THD_FREQ_THREADS_MAX); i++)
+    {
+        if (pthread_create(&pool.thread[i], NULL, thd_pool_worker, &pool) != 0)
+        {
+            break;
+        }
+        pool.nthreads++;
+    }
 
-        /* Finds next frequency change */
-        find_next_fchange(pfs, &settle_point, &block_end, &new_block_start, &c_freq);
+    if (pool.nthreads > 0)
+    {
+        fchange_map_next(pfs, map, ws, &settle_point, &block_end, &new_block_start, &c_freq);
+        workspace_reset(ws);
 
-    } /* End of while loop */
+        while (c_freq > 0)
+        {
+            if (pool.tail - pool.head == pool.ndwell)
+            {
+                thd_pool_commit(&pool, ws, pool.head + 1);
+            }
+            thd_pool_add(&pool, ws, settle_point, block_end, new_block_start, c_freq);
+            thd_pool_commit(&pool, ws, pool.head);
+
+            /* Advance data_position for the next block; the audio of the dwells not
+             * committed yet is kept, in case they have to be redone */
+            pfs->data_position = (__int64) new_block_start;
+            keep = new_block_start;
+            if (pool.head < pool.tail)
+            {
+                keep = min_d(keep, pool.dwell[pool.head % pool.ndwell].found_settle_point);
+            }
+            fio_window_release(pfs, (__int64) keep);
 
-    /* prints out all elements in point array ( these elements are the content of a .res file ) */
-    write_to_file(points, nrows, pfs);
+            /* Finds next frequency change */
+            fchange_map_next(pfs, map, ws, &settle_point, &block_end, &new_block_start, &c_freq);
+            workspace_reset(ws);
+        }
+        thd_pool_commit(&pool, ws, pool.tail);
+    }
 
-    /* Free the dynamic range filters */
-    free_dr_filters();
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+    for (i = 0; i < pool.nthreads; i++)
+    {
+        pthread_join(pool.thread[i], NULL);
+    }
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.dwell);
 
-    thdfreq_debug("END----\n");
-    return(0);
+    return ((pool.nthreads > 0) ? 0 : -1);
 }
+#else
+static int thd_freq_parallel( pfstruct pfs, thd_freq_mode mode, double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows,
+                              double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows, double min_rms_db, fchange_map_t *map, workspace_t *ws )
+{
+    /* no threads here, thd_freq() measures the dwells itself */
+    pfs = pfs;
+    mode = mode;
+    points = points;
+    nrows = nrows;
+    bad_dwells = bad_dwells;
+    bad_dwells_nrows = bad_dwells_nrows;
+    min_rms_db = min_rms_db;
+    map = map;
+    ws = ws;
+    return (-1);
+}
+#endif
 
 /**
  * @brief   Calculate the "frequency response" on a segment of audio
@@ -310,11 +735,12 @@ int freq_resp( double *data, int len_data, double *reading_db )
  * @param   len_data            IN: Length of audio data
  * @param   c_freq              IN: Center frequency of tone during segment (notched out)
  * @param   fs                  IN: Sampling rate in Hz
+ * @param   ws                  IN/OUT: Scratch for the filter outputs, see thd_filt_workspace()
  * @param   reading_db          OUT: Pointer to measured power in dB
 
  * @return  Returns 0 if successful.  -1 otherwise.
  */
-int thd_filt( double *data, int len_data, double c_freq, double fs, double *reading_db )
+int thd_filt( double *data, int len_data, double c_freq, double fs, workspace_t *ws, double *reading_db )
 {
     double *y = NULL;
     double *res_filt = NULL;
@@ -327,6 +753,11 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
     double total_sum;
     int i;
     double rms;
+    SOS_FILTER notch;                   /* this call's own instance of on_fly_notch */
+    double notch_b[1][3];
+    double notch_a[1][3];
+    SOS_FILTER lp;                      /* and of the low-pass, sharing its coefficients */
+    const SOS_FILTER *lp_filter;
 
     /* Debug printing */
     thdfilt_debug("Entering thd_filt()\n");
@@ -345,34 +776,49 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
 
     bw = min_d(0.125, bw);
 
-    /* Allocate temporary buffers */
-    if ((y = (double *) calloc((len_data), sizeof(double))) == NULL)
+    /* bw is a fraction of Nyquist, as tuned for 48kHz and below.  Above 48kHz keep the
+     * notch as wide in Hz as it is at 48kHz, or it reaches into the 2nd harmonic */
+    if (fs > 48000.0)
+    {
+        bw = bw * 48000.0 / fs;
+    }
+
+    /* Temporary buffers */
+    if ((y = (double *) workspace_alloc(ws, len_data * sizeof(double))) == NULL)
     {
         error("malloc failed\n");
         return(-1);
     }
 
-    if ((res_filt = (double *) calloc((len_data), sizeof(double))) == NULL)
+    if ((res_filt = (double *) workspace_alloc(ws, len_data * sizeof(double))) == NULL)
     {
-        free(y);
         error("malloc failed\n");
         return(-1);
     }
 
-    reset_sos_filter(&on_fly_notch);
+    /* The filters are instances local to this call, with their delay lines in the
+     * workspace, so concurrent calls (see thd_freq_parallel()) don't share any state */
+    assert(on_fly_notch.nsec == 1);
+    if (thd_filter_state(&notch, &on_fly_notch, ws) != 0)
+    {
+        error("malloc failed\n");
+        return(-1);
+    }
+    notch.b = notch_b;                  /* the coefficients are worked out per call */
+    notch.a = notch_a;
 
-    notch2ndOrder((c_freq / (fs / 2)), bw);
+    notch2ndOrder(&notch, (c_freq / (fs / 2)), bw);
 
 #if 0
-    thdfilt_debug("on_fly_notch_b[0][0] :  %.16f\n", (double) (on_fly_notch.b[0][0]));
-    thdfilt_debug("on_fly_notch_b[0][1] :  %.16f\n", (double) (on_fly_notch.b[0][1]));
-    thdfilt_debug("on_fly_notch_b[0][2] :  %.16f\n", (double) (on_fly_notch.b[0][2]));
-    thdfilt_debug("on_fly_notch_a[0][0] :  %.16f\n", (double) (on_fly_notch.a[0][0]));
-    thdfilt_debug("on_fly_notch_a[0][1] :  %.16f\n", (double) (on_fly_notch.a[0][1]));
-    thdfilt_debug("on_fly_notch_a[0][2] :  %.16f\n", (double) (on_fly_notch.a[0][2]));
+    thdfilt_debug("on_fly_notch_b[0][0] :  %.16f\n", (double) (notch.b[0][0]));
+    thdfilt_debug("on_fly_notch_b[0][1] :  %.16f\n", (double) (notch.b[0][1]));
+    thdfilt_debug("on_fly_notch_b[0][2] :  %.16f\n", (double) (notch.b[0][2]));
+    thdfilt_debug("on_fly_notch_a[0][0] :  %.16f\n", (double) (notch.a[0][0]));
+    thdfilt_debug("on_fly_notch_a[0][1] :  %.16f\n", (double) (notch.a[0][1]));
+    thdfilt_debug("on_fly_notch_a[0][2] :  %.16f\n", (double) (notch.a[0][2]));
 #endif
 
-    sos_filter_array(data, &on_fly_notch, y, len_data);
+    sos_filter_array(data, &notch, y, len_data);
 
 #if 0
     thdfilt_debug("-----------AFTER NOTCH FILTER----------------\n");
@@ -383,19 +829,15 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
     thdfilt_debug("-----------AFTER NOTCH FILTER----------------\n");
 #endif
 
-    if (fs > 42000)
+    lp_filter = thd_lp_filter(fs);
+    if (lp_filter != NULL)
     {
-
-        if ((int) fs == 44100)
-        {
-            reset_sos_filter(&dr_lp_44100);
-            sos_filter_array(y, &dr_lp_44100, res_filt, len_data);
-        }
-        else
+        if (thd_filter_state(&lp, lp_filter, ws) != 0)
         {
-            reset_sos_filter(&dr_lp_48000);
-            sos_filter_array(y, &dr_lp_48000, res_filt, len_data);
+            error("malloc failed\n");
+            return(-1);
         }
+        sos_filter_array(y, &lp, res_filt, len_data);
     }
     else
     {
@@ -416,10 +858,8 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
     }
 #endif
 
-    if (check_settling(AMP_GRADIENT, RAW, NULL, res_filt, len_data, (int) fs, c_freq, thres_db, alpha, numblocks, len_data, &filt_settle_point ) != 0)
+    if (check_settling(AMP_GRADIENT, RAW, NULL, res_filt, len_data, (int) fs, c_freq, thres_db, alpha, numblocks, len_data, ws, &filt_settle_point ) != 0)
     {
-        free(y);
-        free(res_filt);
         debug("check_settling failed\n");
         return(-1);
     }
@@ -430,8 +870,6 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
     {
         *reading_db = -999;
         debug("check_settling returned a settling_point of 0\n");
-        free(y);
-        free(res_filt);
         return(-1);
     }
 
@@ -452,12 +890,78 @@ int thd_filt( double *data, int len_data, double c_freq, double fs, double *read
         *reading_db = (20 * log10f((float)rms) + 3.01);
     }
 
-    free(res_filt);
-    free(y);
-
     return(0);
 }
 
+/**
+ * @brief   Workspace needed by thd_filt()
+ *
+ * @param   len_data            IN: Length of audio data
+ * @param   fs                  IN: Sampling frequency in Hz
+ *
+ * @return  Returns the number of bytes thd_filt() takes from its workspace, including
+ *          those of the check_settling() call it makes.
+ */
+size_t thd_filt_workspace( int len_data, double fs )
+{
+    const SOS_FILTER *lp_filter = thd_lp_filter(fs);
+    size_t size = 2 * WORKSPACE_SIZE(len_data * sizeof(double)) + check_settling_workspace((unsigned long) fs);
+
+    size += 2 * WORKSPACE_SIZE(on_fly_notch.nsec * sizeof(double));
+    if (lp_filter != NULL)
+    {
+        size += 2 * WORKSPACE_SIZE(lp_filter->nsec * sizeof(double));
+    }
+    return size;
+}
+
+/**
+ * @brief   Make an instance of a filter, with its own cleared delay line
+ *
+ * @param   pf                  OUT: Instance, sharing the coefficients of coef
+ * @param   coef                IN: Filter whose coefficients are used
+ * @param   ws                  IN/OUT: Workspace the delay line is taken from
+ *
+ * @return  Returns 0 if successful.  -1 otherwise.
+ */
+static int thd_filter_state( pSOS_FILTER pf, const SOS_FILTER *coef, workspace_t *ws )
+{
+    *pf = *coef;
+    pf->z1 = (double *) workspace_calloc(ws, pf->nsec, sizeof(double));
+    pf->z2 = (double *) workspace_calloc(ws, pf->nsec, sizeof(double));
+
+    return (pf->z1 != NULL && pf->z2 != NULL) ? 0 : -1;
+}
+
+/**
+ * @brief   20kHz low-pass applied after the notch in thd_filt()
+ *
+ * @param   fs                  IN: Sampling frequency in Hz
+ *
+ * @return  Returns the filter for fs (designed at rates without a table), or NULL where
+ *          Nyquist is below its stopband and none is needed.
+ */
+static const SOS_FILTER *thd_lp_filter( double fs )
+{
+    switch ((int) fs)
+    {
+        case 44100:
+            return &dr_lp_44100;
+        case 48000:
+            return &dr_lp_48000;
+        case 88200:
+            return &dr_lp_88200;
+        case 96000:
+            return &dr_lp_96000;
+        case 176400:
+            return &dr_lp_176400;
+        case 192000:
+            return &dr_lp_192000;
+        default:
+            return iir_design_lp((int) fs);
+    }
+}
+
 double pwr_mean( double *blk, int blk_size )
 {
     double mean = 0.0;
@@ -576,7 +1080,7 @@ int add_bad_dwells( double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows, double
     return (0);
 }
 
-int notch2ndOrder( double Wo, double BW )
+int notch2ndOrder( pSOS_FILTER pf, double Wo, double BW )
 {
     double Gb = 0.707945784;
     double beta, gain;
@@ -586,12 +1090,12 @@ int notch2ndOrder( double Wo, double BW )
     beta = (sqrt(1 - pow(Gb, 2)) / Gb) * tan((BW / 2));
     gain = 1 / (1 + beta);
 
-    write_coef(&on_fly_notch, 1, (-2 * gain * cos(Wo)), ((2 * gain) - 1), gain, (-2 * gain * cos(Wo)), gain);
+    write_coef(pf, 1, (-2 * gain * cos(Wo)), ((2 * gain) - 1), gain, (-2 * gain * cos(Wo)), gain);
 
     return (0);
 }
 
-double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
+double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u, workspace_t *ws )
 {
 
     int i;
@@ -637,7 +1141,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
     length_y++;
     u++;
 
-    if ((x = (int *) calloc((length_x), sizeof(int))) == NULL)
+    if ((x = (int *) workspace_calloc(ws, (length_x), sizeof(int))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -650,7 +1154,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     n = length_x - 1;
 
-    if ((h = (double *) calloc((length_x - 1), sizeof(double))) == NULL)
+    if ((h = (double *) workspace_calloc(ws, (length_x - 1), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -661,7 +1165,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
         h[i] = (double) (x[i + 1] - x[i]);
     }
 
-    if ((del = (double *) calloc((length_y), sizeof(double))) == NULL)
+    if ((del = (double *) workspace_calloc(ws, (length_y), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -674,7 +1178,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
         del[i] = (double) (y[i + 1][0] - y[i][0]);
     }
 
-    if ((slopes = (double *) calloc((length_y), sizeof(double))) == NULL)
+    if ((slopes = (double *) workspace_calloc(ws, (length_y), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -719,7 +1223,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     numel_x = length_x - 1;
 
-    if ((dzzdx = (double *) calloc((numel_x - 1), sizeof(double))) == NULL)
+    if ((dzzdx = (double *) workspace_calloc(ws, (numel_x - 1), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -730,7 +1234,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
         dzzdx[i] = (del[i] - slopes[i]) / h[i];
     }
 
-    if ((dzdxdx = (double *) calloc((numel_x - 1), sizeof(double))) == NULL)
+    if ((dzdxdx = (double *) workspace_calloc(ws, (numel_x - 1), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -743,7 +1247,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     dnm1 = numel_x - 1;
 
-    if ((reshape_1 = (double *) calloc((numel_x - 1), sizeof(double))) == NULL)
+    if ((reshape_1 = (double *) workspace_calloc(ws, (numel_x - 1), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -754,7 +1258,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
         reshape_1[i] = (dzdxdx[i] - dzzdx[i]) / h[i];
     }
 
-    if ((reshape_2 = (double *) calloc((numel_x - 1), sizeof(double))) == NULL)
+    if ((reshape_2 = (double *) workspace_calloc(ws, (numel_x - 1), sizeof(double))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -775,7 +1279,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     k = (int) ((dlk / dl) + (100 * eps));
 
-    if ((coefs = (double **) calloc(dl, sizeof(double *))) == NULL)
+    if ((coefs = (double **) workspace_calloc(ws, dl, sizeof(double *))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -783,7 +1287,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     for (i = 0; i < dl; i++)
     {
-        if ((coefs[i] = (double *) calloc(k, sizeof(double))) == NULL)
+        if ((coefs[i] = (double *) workspace_calloc(ws, k, sizeof(double))) == NULL)
         {
             error("couldn't malloc, exiting\n");
             exit(-1);
@@ -800,7 +1304,7 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
 
     //ixexist = 0;
 
-    if ((sort = (int *) calloc((length_x - 1), sizeof(int))) == NULL)
+    if ((sort = (int *) workspace_calloc(ws, (length_x - 1), sizeof(int))) == NULL)
     {
         error("couldn't malloc, exiting\n");
         exit(-1);
@@ -842,22 +1346,23 @@ double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u )
         v = xs * v + coefs[index - 1][i];
     }
 
-    free(sort);
-
-    for (i = 0; i < dl; i++)
-    {
-        free(coefs[i]);
-    }
+    return (v);
+}
 
-    free(coefs);
-    free(reshape_2);
-    free(reshape_1);
-    free(dzdxdx);
-    free(dzzdx);
-    free(slopes);
-    free(del);
-    free(x);
-    free(h);
+/**
+ * @brief   Workspace needed by pchip_interp()
+ *
+ * @param   length_y            IN: Number of points
+ *
+ * @return  Returns the number of bytes pchip_interp() takes from its workspace.
+ */
+size_t pchip_interp_workspace( int length_y )
+{
+    size_t n = (size_t) length_y + 1;       /* pchip_interp() counts one more, as MATLAB does */
 
-    return (v);
+    return 2 * WORKSPACE_SIZE(n * sizeof(int))                 /* x, sort */
+         + 3 * WORKSPACE_SIZE(n * sizeof(double))              /* h, del, slopes */
+         + 4 * WORKSPACE_SIZE(n * sizeof(double))              /* dzzdx, dzdxdx, reshape_1, reshape_2 */
+         + WORKSPACE_SIZE(n * sizeof(double *))                /* coefs */
+         + n * WORKSPACE_SIZE(4 * sizeof(double));             /* a cubic per piece */
 }
@@ -35,6 +35,8 @@
 #define DWELLS_MAX      (5000)
 #define THDFREQ_POINTS  (2)
 #include "fio.h"
+#include "Utilities.h"
+#include "sos_filter.h"
 /*enum to define modes of the function*/
 typedef enum
 {
@@ -51,8 +53,10 @@ int add_points( double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows, double c_
 void write_to_file( double points[DWELLS_MAX][THDFREQ_POINTS], int *nrows, pfstruct pfs );
 int add_bad_dwells( double bad_dwells[DWELLS_MAX], int *bad_dwells_nrows, double c_freq );/*adding the bad dwells*/
 int freq_resp( double *data, int len_data, double *reading_db ); /*function for frequency response*/
-int thd_filt( double *data, int len_data, double c_freq, double fs, double *reading_db );/*filter for the THD tool*/
-int notch2ndOrder( double Wo, double BW ); /*2nd order notch filter*/
-double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u );/*Hermit interpolation*/
+int thd_filt( double *data, int len_data, double c_freq, double fs, workspace_t *ws, double *reading_db );/*filter for the THD tool*/
+size_t thd_filt_workspace( int len_data, double fs );
+int notch2ndOrder( pSOS_FILTER pf, double Wo, double BW ); /*2nd order notch filter, into pf*/
+double pchip_interp( double y[DWELLS_MAX][THDFREQ_POINTS], int length_y, int u, workspace_t *ws );/*Hermit interpolation*/
+size_t pchip_interp_workspace( int length_y );
 
 #endif /* __THD_FREQ_H__ */
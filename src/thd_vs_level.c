@@ -44,10 +44,9 @@ extern void print_usage( void );
 
 char *chart = "title, THD+N vs. Level,\nxlabel, Level (dBFS),\nylabel, THD+N (dB),\nxreverse,\n";
 
-fstruct fst;
-
 int main( int argc, char *argv[] )
 {
+    fstruct fst;
     int res;
     int startCh, endCh;
     int ch;
@@ -73,18 +72,30 @@ int main( int argc, char *argv[] )
     debugInit();
     fio_init(&fst, "thd_vs_level", "Amplitude", "THD+N", NULL);
 
-    for (ch = startCh; ch < endCh; ch++)
+    /* With every channel decoded up front, the channels are filtered side by side */
+    if (endCh - startCh > 1 && fio_planes_ready(&fst))
+    {
+        res = thd_ampl_channels(&fst, 1, startCh, endCh);
+        if (res)
+        {
+            return (1);
+        }
+    }
+    else
     {
-        check( fio_next_chunk(&fst, ch) );
+        for (ch = startCh; ch < endCh; ch++)
+        {
+            check( fio_next_chunk(&fst, ch) );
 
-        fio_resetpos(&fst);
+            fio_resetpos(&fst);
 
-        /* call the calculating function */
-        res=thd_ampl(&fst, 1); 
-		if (res)
-		{
-			return (1);
-		}
+            /* call the calculating function */
+            res=thd_ampl(&fst, 1); 
+            if (res)
+            {
+                return (1);
+            }
+        }
     }
 
     fio_cleanup(&fst);
@@ -98,13 +109,17 @@ void print_usage( void )
     fprintf(stderr, "THD+N vs Level Tool\n");
     fprintf(stderr, "%s\n", COPYRIGHT_STRING);
     fprintf(stderr, "%s\n", VERSION_STRING);
-    fprintf(stderr, "Usage: thd_vs_level [OPTION]... -i WAVEFILE\n\n");
+    fprintf(stderr, "Usage: thd_vs_level [OPTION]... -i WAVEFILE\n");
+    fprintf(stderr, "Use -i - to read the WAV file from standard input (or give a named pipe)\n\n");
     fprintf(stderr, "-c <chan>,          selects channel in multichannel file\n");
     fprintf(stderr, "                    0 = first channel\n");
     fprintf(stderr, "                    -c a for all channels\n");
     fprintf(stderr, "-s,                 turn off stripping lead silence\n" );
 	fprintf(stderr, "-thr_db <thr>,      select the power threshold for silence stripping in db\n");
 	fprintf(stderr, "-thr_s <thr>,       select the sample threshold for silence stripping in bit\n");
+    fprintf(stderr, "-ra,                read ahead: decode the next block in a background thread\n");
+    fprintf(stderr, "-cache,             keep the decoded samples in WAVEFILE.satscache and reuse\n");
+    fprintf(stderr, "                    them in later runs on the same, unchanged file\n");
     fprintf(stderr, "-t,                 send text output to standard output (default)\n");
     fprintf(stderr, "-to <name>,         create a text file\n");
 }
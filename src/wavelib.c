@@ -1,32 +1,32 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	wavelib.c
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	wavelib.c
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 #include <stdlib.h>
@@ -36,33 +36,41 @@
 #include "wavelib.h"
 #include "debug.h"
 #include "stdio64.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 //#ifdef WAV_SUPPORT
 //enum endianess endian_type = LITTLE;//DONT_KNOW;
 /* GUIDs */
 #define KSDATAFORMAT_SUBTYPE_PCM   "\x01\x00\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71"
 #define KSDATAFORMAT_SUBTYPE_FLOAT "\x03\x00\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71"
-extern void find_endianess( void );
-
-void find_endianess( void )
+/* Sony Wave64: chunks are named by GUIDs; those for FOURCC chunks ("fmt ", "data", ...)
+   share the tail of the "wave" GUID */
+static const unsigned char W64_GUID_RIFF[16] = { 'r','i','f','f', 0x2E,0x91,0xCF,0x11,0xA5,0xD6,0x28,0xDB,0x04,0xC1,0x00,0x00 };
+static const unsigned char W64_GUID_WAVE[16] = { 'w','a','v','e', 0xF3,0xAC,0xD3,0x11,0x8C,0xD1,0x00,0xC0,0x4F,0x8E,0xDB,0x8A };
+enum WaveLayout { WAV_RIFF, WAV_RF64, WAV_W64 };
+/* Byte order of this machine, worked out on each call so there is no shared state */
+enum endianess find_endianess( void )
 {
 	unsigned int l = 0x01;
 	unsigned char *ucp = (unsigned char *)&l;
 
 	if ( *ucp == 0x01 )
 		{
-		endian_type = LITTLE;
 //		info("LITTLE: (%ld)\n", l );
+		return( LITTLE );
 		}
 	else if ( *(ucp+3) == 0x01 )
 		{
-		endian_type = BIG;
 //		info("BIG: (%ld)\n", l );
+		return( BIG );
 		}
 	else
 		{
 		error("Can't determine endian_type (%d)\n", l );
-		endian_type = CANT_TELL;
+		return( CANT_TELL );
 		}
 }
 
@@ -72,12 +80,8 @@ int convert_int32( int il )
 	unsigned char *icp;
 	unsigned char *ocp;
 
-	switch ( endian_type )
+	switch ( find_endianess() )
 		{
-		case DONT_KNOW:
-			find_endianess();
-			return( convert_int32( il ) );
-			break;
 		case LITTLE:
 			return( il );
 			break;
@@ -90,6 +94,7 @@ int convert_int32( int il )
 			*ocp++ = *(icp + 0 );
 			return( ol );
 			break;
+		case DONT_KNOW:
 		case CANT_TELL:
 		default:
 			return( 0 ); // that ought to break things
@@ -102,12 +107,8 @@ short convert_int16( short is )
 	short os;
 	unsigned char *icp = (unsigned char *)&is;
 	unsigned char *ocp = (unsigned char *)&os;
-	switch ( endian_type )
+	switch ( find_endianess() )
 		{
-		case DONT_KNOW:
-			find_endianess();
-			return( convert_int16( is ) );
-			break;
 		case LITTLE:
 			return( is );
 			break;
@@ -118,6 +119,7 @@ short convert_int16( short is )
 			*ocp++ = *(icp + 0 );
 			return( os );
 			break;
+		case DONT_KNOW:
 		case CANT_TELL:
 		default:
 			return( 0 ); // that ought to break things
@@ -125,11 +127,65 @@ short convert_int16( short is )
 		}
 }
 
+/* Skip "n" bytes of "f", reading and discarding them if it can't seek (e.g. stdin) */
+static int wav_skip( FILE *f, __int64 n )
+{
+	unsigned char buf[4096];
+	size_t m;
+
+	if (ftello(f) >= 0 && fseeko(f, n, SEEK_CUR) == 0)
+		return 0;
+
+	while (n > 0)
+	{
+		m = (n < (__int64) sizeof(buf)) ? (size_t) n : sizeof(buf);
+		if (fread(buf, 1, m, f) != m)
+			return -1;
+		n -= m;
+	}
+	return 0;
+}
+
+/* Copy the rest of the stream "wav->file" to a temporary file and read on from that,
+   for a stream whose header doesn't say how long it is.  Returns the bytes copied,
+   or -1 on error.  The temporary file goes away when it is closed. */
+static __int64 wav_spool( struct WaveFile *wav )
+{
+	unsigned char buf[65536];
+	__int64 total = 0;
+	size_t m;
+	FILE *tmp;
+
+	if ((tmp = tmpfile()) == NULL)
+		return -1;
+
+	while ((m = fread(buf, 1, sizeof(buf), wav->file)) > 0)
+	{
+		if (fwrite(buf, 1, m, tmp) != m)
+		{
+			fclose(tmp);
+			return -1;
+		}
+		total += m;
+	}
+	if (ferror(wav->file) || fflush(tmp) != 0 || fseeko(tmp, 0, SEEK_SET) != 0)
+	{
+		fclose(tmp);
+		return -1;
+	}
+
+	if (wav->file != stdin)
+		fclose(wav->file);
+	wav->file = tmp;
+	wav->stream = 0;
+	return total;
+}
+
 int read_wav_header(
 		struct WaveFile *wav, 
 		char	*file , 
 		short	*numchans, 
-		int	    *numsamps, 
+		__int64 *numsamps, 
 		int	    *samprate, 
 		short	*bitspersamp, 
 		short	*wavx,
@@ -142,6 +198,8 @@ int read_wav_header(
 	char chunk_id[4];
 	char form_type[4];
 	char subchunk_id[4];
+	unsigned char guid[16];
+	enum WaveLayout layout;
 	short audio_format = 0, num_channels = 0;
 	int sample_rate = 0, avg_byte_rate;
 	short block_align = 0, bits_per_sample = 0, bytes_per_sample;
@@ -155,16 +213,16 @@ int read_wav_header(
 	short got_data_chunk = 0;
 	short got_fmt_chunk = 0;
 	unsigned int chunk_size;
-	unsigned int subchunk_size;
-	unsigned int data_subchunk_size = 0;
+	unsigned int size32;
+	__int64 riff_size;
+	__int64 ds64_data_size = -1;
+	__int64 subchunk_size;
+	__int64 data_subchunk_size = 0;
+	__int64 pad;
     short fmt_type = 1; /* this is for finding the wave format i.e pcm or IEEE*/
     unsigned int  guidLen  = 16;
 
-#ifdef ANSI_FIO
-	unsigned int data_chunk_start = 0;
-#else
 	__int64 data_chunk_start = 0;
-#endif /* ANSI_FIO */
 	BWF_STRUCT bwf_info;
 
 	assert(wav && numchans && numsamps && samprate && bitspersamp);
@@ -173,34 +231,95 @@ int read_wav_header(
 
 	/* Don't do this since already opened in exec */
 	if (file != NULL)
-		if ((wav->file = fopen(file,"rb")) == NULL) 
+	{
+		if (strcmp(file, "-") == 0)
+		{
+			wav->file = stdin;
+#ifdef _WIN32
+			_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		}
+		else if ((wav->file = fopen(file,"rb")) == NULL) 
 			return FILE_READ_ERR;
+	}
+
+	/* stdin, pipes and FIFOs can't seek: the header is parsed up to the data chunk only */
+	wav->stream = (ftello(wav->file) < 0);
 
 /*	Read chunk header */
 
 	if (fread(chunk_id, 1, 4, wav->file) != 4) return(FILE_READ_ERR);
-	if (strncmp("RIFF", chunk_id, 4)) return(FORMAT_ERR);
+	if (strncmp("RIFF", chunk_id, 4) == 0) layout = WAV_RIFF;
+	else if (strncmp("RF64", chunk_id, 4) == 0 || strncmp("BW64", chunk_id, 4) == 0) layout = WAV_RF64;
+	else if (strncmp("riff", chunk_id, 4) == 0) layout = WAV_W64;
+	else return(FORMAT_ERR);
 
-	if (fread(&chunk_size, 4, 1, wav->file) != 1) return(FILE_READ_ERR);
+	if (layout == WAV_W64)
+	{
+		/* Rest of the riff GUID, 64-bit size of the whole file, wave GUID */
+		if (fread(guid, 1, 12, wav->file) != 12) return(FILE_READ_ERR);
+		if (memcmp(guid, W64_GUID_RIFF + 4, 12)) return(FORMAT_ERR);
+		if (fread(&riff_size, 8, 1, wav->file) != 1) return(FILE_READ_ERR);
+		if (fread(guid, 1, 16, wav->file) != 16) return(FILE_READ_ERR);
+		if (memcmp(guid, W64_GUID_WAVE, 16)) return(FORMAT_ERR);
+	}
+	else
+	{
+		/* RF64 puts 0xFFFFFFFF here and the real size in the ds64 chunk */
+		if (fread(&chunk_size, 4, 1, wav->file) != 1) return(FILE_READ_ERR);
+		riff_size = chunk_size;
 
-	if (fread(form_type, 1, 4, wav->file) != 4) return(FILE_READ_ERR);
-	if (strncmp("WAVE", form_type, 4)) return(FORMAT_ERR);
+		if (fread(form_type, 1, 4, wav->file) != 4) return(FILE_READ_ERR);
+		if (strncmp("WAVE", form_type, 4)) return(FORMAT_ERR);
+	}
 
 	/* Read or skip various subchunks */
 	done = 0;
 	while (!done)
 	{
 		/* Read next subchunk type and size, go until end of file */
-		bytes_read = (int) fread(subchunk_id,  1,  4, wav->file);
-
-		if (bytes_read < 4)
+		if (layout == WAV_W64)
 		{
-			//end_of_file = 1;
-			break;
+			bytes_read = (int) fread(guid, 1, 16, wav->file);
+
+			if (bytes_read < 16)
+			{
+				break;
+			}
+
+			/* Sizes include the 24 byte chunk header; chunks are 8 byte aligned */
+			if (fread(&subchunk_size, 8, 1, wav->file) != 1) return(FILE_READ_ERR);
+			if (subchunk_size < 24) return(FORMAT_ERR);
+			subchunk_size -= 24;
+			pad = (8 - subchunk_size % 8) % 8;
+
+			if (memcmp(guid + 4, W64_GUID_WAVE + 4, 12) == 0)
+				memcpy(subchunk_id, guid, 4);
+			else
+				memcpy(subchunk_id, "    ", 4);   /* not a FOURCC chunk: skip it */
 		}
+		else
+		{
+			bytes_read = (int) fread(subchunk_id,  1,  4, wav->file);
+
+			if (bytes_read < 4)
+			{
+				//end_of_file = 1;
+				break;
+			}
 
-		/* Read subchunk size */
-		if (fread(&subchunk_size, 1, 4, wav->file) != 4) return(FILE_READ_ERR);
+			/* Read subchunk size */
+			if (fread(&size32, 1, 4, wav->file) != 4) return(FILE_READ_ERR);
+			subchunk_size = size32;
+
+			/* An RF64 data chunk's real size is in the ds64 chunk */
+			if (layout == WAV_RF64 && size32 == 0xFFFFFFFF && ds64_data_size >= 0 &&
+			    strncmp("data", subchunk_id, 4) == 0)
+			{
+				subchunk_size = ds64_data_size;
+			}
+			pad = subchunk_size % 2;
+		}
 
 		/* Format subchunk */
 		if (strncmp("fmt ", subchunk_id, 4) == 0)
@@ -246,60 +365,85 @@ int read_wav_header(
 
 				if (subchunk_size > 40)
 				{
-					if (fseek(wav->file, subchunk_size - 40, SEEK_CUR)) return(FILE_READ_ERR);
+					if (wav_skip(wav->file, subchunk_size - 40)) return(FILE_READ_ERR);
 				}
 			}
 			else
 			{	/* Consume any remaining bytes */
 				if (subchunk_size > 16)
 				{
-					if (fseek(wav->file, subchunk_size - 16, SEEK_CUR)) return(FILE_READ_ERR);
+					if (wav_skip(wav->file, subchunk_size - 16)) return(FILE_READ_ERR);
 				}
 			}
 
 			/* If odd subchunk size eat pad byte */
-			if (subchunk_size % 2) if (fseek(wav->file, 1, SEEK_CUR) != 0) return(FILE_READ_ERR);
+			if (pad) if (wav_skip(wav->file, pad) != 0) return(FILE_READ_ERR);
 
 			/* Set flag since this is a required chunk */
 			got_fmt_chunk = 1;
 		}
+		/* RF64/BW64 64-bit sizes: RIFF size, data size, sample count, table */
+		else if (layout == WAV_RF64 && strncmp("ds64", subchunk_id, 4) == 0)
+		{
+			if (subchunk_size < 24) return(FORMAT_ERR);
+			if (fread(&riff_size, 8, 1, wav->file) != 1) return(FILE_READ_ERR);
+			if (fread(&ds64_data_size, 8, 1, wav->file) != 1) return(FILE_READ_ERR);
+			if (wav_skip(wav->file, subchunk_size - 16 + pad)) return(FILE_READ_ERR);
+		}
 		/* Data subchunk - mark it, save size, and skip over it for now */
 		else if (strncmp("data", subchunk_id, 4) == 0)
 		{
-			if (chunk_size < (subchunk_size + 36)) return(FORMAT_ERR);
+			/* A program writing WAV to a pipe can't know the length yet and leaves the
+			   sizes 0 or 0xFFFFFFFF: the data is then the rest of the input.  A stream is
+			   read to its end into a temporary file, which then stands in for it. */
+			if (layout != WAV_W64 && (subchunk_size == 0 || subchunk_size == 0xFFFFFFFF) &&
+			    (wav->stream || riff_size == 0 || riff_size == 0xFFFFFFFF))
+			{
+				if (wav->stream)
+				{
+					if ((subchunk_size = wav_spool(wav)) < 0) return(FILE_READ_ERR);
+					wav->bytesleft = subchunk_size;
+					got_data_chunk = 1;
+					data_subchunk_size = subchunk_size;
+					break;
+				}
+				if ((data_chunk_start = ftello(wav->file)) < 0) return(FILE_READ_ERR);
+				if (fseeko(wav->file, 0, SEEK_END)) return(FILE_READ_ERR);
+				subchunk_size = ftello(wav->file) - data_chunk_start;
+				if (fseeko(wav->file, data_chunk_start, SEEK_SET)) return(FILE_READ_ERR);
+				pad = 0;
+			}
+			/* The data has to fit in the file: 36 bytes for the minimal RIFF header, 104 for Wave64 */
+			else if (riff_size < (subchunk_size + ((layout == WAV_W64) ? 104 : 36))) return(FORMAT_ERR);
 
 			/* Keep bytes left for return to caller */
-#ifndef ANSI_FIO
-			//assert(subchunk_size <= (unsigned long)(-1));  %This is always true ??
-			wav->bytesleft = (unsigned long)subchunk_size;
-#else
 			wav->bytesleft = subchunk_size;
-#endif /* ANSI_FIO */
+
+			/* A stream can't skip the samples and come back: stop at the data */
+			if (wav->stream)
+			{
+				got_data_chunk = 1;
+				data_subchunk_size = subchunk_size;
+				break;
+			}
 
 			/* Mark this position in file to return to it later */
 #ifdef ANSI_FIO
 			data_chunk_start = ftell(wav->file);
 #else
-			/* We need enough resolution to handle 4GB files, however ftell only 
-			   supports 2GB files, as it returns a signed long.  Instead use the
-			   64bit version, check the range, and cast back down to a 32bit ulong */
+			/* We need enough resolution for files over 2GB (and RF64/Wave64 ones
+			   over 4GB), however ftell returns a signed long.  Use the 64bit version */
 			data_chunk_start = ftello(wav->file);
-			assert((unsigned long)data_chunk_start <= (unsigned long)(-1));
 #endif
 
-			/* Skip over this chunk in case there are more chunks that follow it */
+			/* Skip over this chunk in case there are more chunks that follow it,
+			   eating the pad byte (or Wave64 alignment) too */
 #ifdef ANSI_FIO
-			if (fseek(wav->file, subchunk_size, SEEK_CUR)) return(FILE_READ_ERR);
+			if (fseek(wav->file, (long)(subchunk_size + pad), SEEK_CUR)) return(FILE_READ_ERR);
 #else
-			/* Again, we need enough resolution to handle 4GB files, however fseek only 
-			   supports 2GB files, as it takes a signed long.  Instead use the
-			   64bit version */
-			if (fseeko(wav->file, (__int64)subchunk_size, SEEK_CUR)) return(FILE_READ_ERR);
+			if (fseeko(wav->file, subchunk_size + pad, SEEK_CUR)) return(FILE_READ_ERR);
 #endif /* ANSI_FIO */
 
-			/* If odd subchunk size eat pad byte */
-			if (subchunk_size % 2) if (fseek(wav->file, 1, SEEK_CUR) != 0) return(FILE_READ_ERR);
-
 			/* Set flag since this is a required chunk */
 			got_data_chunk = 1;
 			data_subchunk_size = subchunk_size;
@@ -307,8 +451,9 @@ int read_wav_header(
 		/* Broacast subchunk */
 		else if (strncmp("bext", subchunk_id, 4) == 0)
 		{
-			/* Parse broadcast wave file subchunk */
-			parse_bwf_subchunk(wav->file, subchunk_size, &bwf_info);
+			/* Parse broadcast wave file subchunk (it eats the RIFF pad byte itself) */
+			parse_bwf_subchunk(wav->file, (unsigned int) subchunk_size, &bwf_info);
+			if (pad > subchunk_size % 2) if (wav_skip(wav->file, pad - subchunk_size % 2)) return(FILE_READ_ERR);
 		    
             /* allow the user to pass null pointers if they don't care about these values */
             if (timeref_hi)
@@ -323,14 +468,7 @@ int read_wav_header(
 		/* Skip unsupported subchunk including fact, cue, plst, list, labl, ltxt, note, smpl, inst */
 		else
 		{
-#ifdef ANSI_FIO
-			if (fseek(wav->file, subchunk_size, SEEK_CUR)) return(FILE_READ_ERR);
-#else
-			/* We need enough resolution to handle 4GB files, however fseek only 
-			   supports 2GB files, as it takes a signed long.  Instead use the
-			   64bit version */
-			if (fseeko(wav->file, (__int64)subchunk_size, SEEK_CUR)) return(FILE_READ_ERR);
-#endif /* ANSI_FIO */
+			if (wav_skip(wav->file, subchunk_size + ((layout == WAV_W64) ? pad : 0))) return(FILE_READ_ERR);
 		}
 	}
 
@@ -338,20 +476,23 @@ int read_wav_header(
 	if (got_fmt_chunk == 0) return (FORMAT_ERR);
 	if (got_data_chunk == 0) return (NO_DATA_ERR);
 
-	/* Set file pointer back to start of data chunk */
+	/* Set file pointer back to start of data chunk (a stream is already there) */
+	if (!wav->stream)
+	{
 #ifdef ANSI_FIO
-	if (fseek(wav->file, data_chunk_start, SEEK_SET)) return(FILE_READ_ERR);
+		if (fseek(wav->file, (long)data_chunk_start, SEEK_SET)) return(FILE_READ_ERR);
 #else
-	/* We need enough resolution to handle 4GB files, however fseek only 
-	   supports 2GB files, as it takes a signed long.  Instead use the
-	   64bit version */
-	if (fseeko(wav->file, (__int64)data_chunk_start, SEEK_SET)) return(FILE_READ_ERR);
+		/* We need enough resolution to handle 4GB files, however fseek only 
+		   supports 2GB files, as it takes a signed long.  Instead use the
+		   64bit version */
+		if (fseeko(wav->file, data_chunk_start, SEEK_SET)) return(FILE_READ_ERR);
 #endif /* ANSI_FIO */
+	}
 
 /*	Set up return values */
 
 	*numchans = num_channels;
-	*numsamps = (long)(data_subchunk_size / (unsigned long)block_align);
+	*numsamps = data_subchunk_size / block_align;
 	*samprate = sample_rate;
 	*bitspersamp = bits_per_sample;
 	if (wavx) *wavx = is_wavx;
@@ -533,13 +674,13 @@ long read_wav_chunk(struct WaveFile *wav, void *buf, unsigned long size)
 
 	assert(wav && buf);
 
-	if (wav->bytesleft > size)
+	if (wav->bytesleft > (__int64) size)
 	{
 		readbytes = size;
 	}
 	else
 	{
-		readbytes = wav->bytesleft;
+		readbytes = (unsigned long) wav->bytesleft;
 	}
 
 	if (fread(buf, 1, (size_t)readbytes, wav->file) != (size_t)readbytes)
@@ -551,7 +692,7 @@ long read_wav_chunk(struct WaveFile *wav, void *buf, unsigned long size)
 	return readbytes;
 }
 
-unsigned long read_wav_bytesleft(struct WaveFile *wav)
+__int64 read_wav_bytesleft(struct WaveFile *wav)
 {
 	assert(wav);
 	return wav->bytesleft;
@@ -604,11 +745,11 @@ int parse_bwf_subchunk(FILE *p_file, unsigned int subchunk_size, BWF_STRUCT *p_b
     }else{
         if (fread(p_bwf->coding_history, 1, 256, p_file) != bytes_remain) return(FILE_READ_ERR);
         bytes_remain -= 256;
-        if (fseek(p_file, bytes_remain, SEEK_CUR) != 0) return(FILE_READ_ERR);
+        if (wav_skip(p_file, bytes_remain) != 0) return(FILE_READ_ERR);
     }
 
 	/* If odd subchunk size eat pad byte */
-	if (subchunk_size % 2) if (fseek(p_file, 1, SEEK_CUR) != 0) return(FILE_READ_ERR);
+	if (subchunk_size % 2) if (wav_skip(p_file, 1) != 0) return(FILE_READ_ERR);
 
 	return (err);
 }
@@ -1,44 +1,44 @@
-/************************************************************************************************************
-* Copyright (c) 2018, Dolby Laboratories Inc.
-* All rights reserved.
-
-* Redistribution and use in source and binary forms, with or without modification, are permitted
-* provided that the following conditions are met:
-
-* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
-*    and the following disclaimer.
-* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
-*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
-* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
-*    promote products derived from this software without specific prior written permission.
-
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
-* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
-* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
-* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
-* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
-* OF THE POSSIBILITY OF SUCH DAMAGE.
-************************************************************************************************************/
-
-/****************************************************************************
-;	File:	wavelib.h
-;
-;	History:
-;		13/06/18		Created		Author: Dolby		Version: 1.0
+/************************************************************************************************************
+* Copyright (c) 2018, Dolby Laboratories Inc.
+* All rights reserved.
+
+* Redistribution and use in source and binary forms, with or without modification, are permitted
+* provided that the following conditions are met:
+
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions
+*    and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+*    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or
+*    promote products derived from this software without specific prior written permission.
+
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************/
+
+/****************************************************************************
+;	File:	wavelib.h
+;
+;	History:
+;		13/06/18		Created		Author: Dolby		Version: 1.0
 ;***************************************************************************/
 
 /****************************************************************************
 ;   Summary of WaveLib functions:
 ;   -----------
-;   int read_wav_header(struct WaveFile *wav, char *file, short *numchans, long *numsamps, long *samprate, short *bitspersamp, short *wavx);
+;   int read_wav_header(struct WaveFile *wav, char *file, short *numchans, __int64 *numsamps, long *samprate, short *bitspersamp, short *wavx);
 ;   int write_wav_header(struct WaveFile *wav, char *file, short numchans, long numsamps, long samprate, short bitspersamp);
 ;   int write_wavx_header(struct WaveFile *wav, char *file, short numchans, long numsamps, long samprate, short bitspersamp);
 ;   -----------
 ;   void read_wav_init(struct WaveFile *wav, unsigned long initial_size);
 ;   long read_wav_chunk(struct WaveFile *wav, void *buf, unsigned long size);
-;   unsigned long read_wav_bytesleft(struct WaveFile *wav);
+;   __int64 read_wav_bytesleft(struct WaveFile *wav);
 ;   int parse_bwf_subchunk(FILE *p_file, unsigned long subchunk_size, BWF_STRUCT *p_bwf);
 ;   -----------
 ;   long write_wav_chunk(struct WaveFile *wav, void *buf, unsigned long size);
@@ -54,6 +54,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "typedef.h"
 
 /****************************************************************************
 *
@@ -72,11 +73,13 @@ enum WaveLibErrors { NO_ERR, FILE_READ_ERR, FORMAT_ERR, FILE_WRITE_ERR, NO_DATA_
 *
 *   file      - file handle to this wave file
 *   bytesleft - the number of bytes left (for reading)
+*   stream    - nonzero if the file can't seek (stdin, pipe or FIFO)
 ****************************************************************************/
 struct WaveFile
 {
 	FILE *file;
-	unsigned long bytesleft;
+	__int64 bytesleft;
+	int stream;
 };
 
 /****************************************************************************
@@ -110,8 +113,14 @@ typedef struct
 *	read_wav_header
 *
 *	Reads a WAVEFORMATEX or WAVEFORMATEXTENSIBLE compatible wave file header
-*   and sets up the WaveFile structure by opening the wave file.  Callers
+*   and sets up the WaveFile structure by opening the wave file.  RF64/BW64
+*   (64-bit sizes in a "ds64" chunk) and Sony Wave64 files are read too.  Callers
 *   must manually close the file or call close_wav() to free the file handle.
+*   A file name of "-" reads from stdin.  On a stream that can't seek, chunks
+*   are skipped by reading and parsing stops at the data chunk.
+*   Sizes of 0 or 0xFFFFFFFF, as written by programs that don't know the length
+*   yet, mean the data runs to the end of the input; a stream is then read to its
+*   end into a temporary file first, and wav->file is that file.
 *      wav         - [i/o] structure to be passed to other wavelib routines
 *      file        - [in]  file name to read from 
 *      numchans    - [out] number of channels
@@ -130,7 +139,7 @@ int read_wav_header(
 		struct WaveFile *wav, 
 		char	*file, 
 		short	*numchans, 
-		int	    *numsamps, 
+		__int64 *numsamps, 
 		int	    *samprate, 
 		short	*bitspersamp, 
 		short	*wavx,
@@ -211,7 +220,7 @@ long read_wav_chunk(struct WaveFile *wav, void *buf, unsigned long size);
 *	Return value:
 *      the number of bytes remaining to be read from the file
 ****************************************************************************/
-unsigned long read_wav_bytesleft(struct WaveFile *wav);
+__int64 read_wav_bytesleft(struct WaveFile *wav);
 
 /****************************************************************************
 *
@@ -247,7 +256,7 @@ void close_wav(struct WaveFile *wav);
 int parse_bwf_subchunk(FILE *p_file, unsigned int subchunk_size, BWF_STRUCT *p_bwf);
 
 enum endianess { DONT_KNOW, LITTLE, BIG, CANT_TELL };
-extern enum endianess endian_type;
+extern enum endianess find_endianess( void );
 extern int convert_int32( int il );
 extern short convert_int16( short is );
 